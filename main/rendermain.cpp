@@ -0,0 +1,149 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2020-06-12
+ * Description : command line tool rendering photo layouts without user interface.
+ *
+ * Copyright (C) 2009-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+// Qt Includes
+
+#include <QString>
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QCommandLineOption>
+#include <QFileInfo>
+#include <QDebug>
+
+// digiKam includes
+
+#include <metaengine.h>
+
+// Local includes
+
+#include "plebatchrenderer.h"
+
+using namespace PhotoLayoutsEditor;
+using namespace Digikam;
+
+int main(int argc, char* argv[])
+{
+    // No display is needed, offscreen platform is used unless another one is requested
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    // Graphics scene and its items require QApplication even without any window
+    QApplication app(argc, argv);
+    app.setApplicationName(QLatin1String("photolayoutseditor-render"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QObject::tr("Renders photo layouts to PNG, JPEG or PDF files"));
+    parser.addVersionOption();
+    parser.addHelpOption();
+
+    QCommandLineOption manifestOption(QStringList() << QLatin1String("m") << QLatin1String("manifest"),
+                                      QObject::tr("JSON manifest with documents to render"), QLatin1String("file"));
+    QCommandLineOption outputOption(QStringList() << QLatin1String("o") << QLatin1String("output"),
+                                    QObject::tr("Output file, format is given by its suffix"), QLatin1String("file"));
+    QCommandLineOption dpiOption(QStringList() << QLatin1String("d") << QLatin1String("dpi"),
+                                 QObject::tr("Output resolution, resolution of the layout by default"), QLatin1String("dpi"));
+    QCommandLineOption jobsOption(QStringList() << QLatin1String("j") << QLatin1String("jobs"),
+                                  QObject::tr("Number of documents written at the same time"), QLatin1String("count"));
+    QCommandLineOption profileOption(QStringList() << QLatin1String("p") << QLatin1String("profile"),
+                                     QObject::tr("ICC profile of the output images, sRGB by default"), QLatin1String("file"));
+    QCommandLineOption intentOption(QLatin1String("intent"),
+                                    QObject::tr("Rendering intent: perceptual, relative, saturation or absolute"), QLatin1String("intent"));
+    parser.addOption(manifestOption);
+    parser.addOption(outputOption);
+    parser.addOption(dpiOption);
+    parser.addOption(jobsOption);
+    parser.addOption(profileOption);
+    parser.addOption(intentOption);
+    parser.addPositionalArgument(QLatin1String("template"), QObject::tr("Layout or template file to render"), QLatin1String("[template]"));
+    parser.addPositionalArgument(QLatin1String("images"), QObject::tr("Photos filling empty photo items of the layout"), QLatin1String("[images...]"));
+    parser.process(app);
+
+    MetaEngine::initializeExiv2();
+    PLEBatchRenderer::registerStandardPlugins();
+
+    PLEBatchRenderer renderer;
+
+    if (parser.isSet(dpiOption))
+        renderer.setDefaultDpi(parser.value(dpiOption).toDouble());
+
+    if (parser.isSet(jobsOption))
+        renderer.setMaxJobs(parser.value(jobsOption).toInt());
+
+    bool valid = true;
+
+    if (parser.isSet(profileOption))
+    {
+        const QStringList intents   = QStringList() << QLatin1String("perceptual") << QLatin1String("relative")
+                                                    << QLatin1String("saturation") << QLatin1String("absolute");
+        const int intent            = intents.indexOf(parser.value(intentOption).toLower());
+        const PLEIccProfile profile = PLEIccProfile::fromFile(parser.value(profileOption));
+
+        if (profile.isNull())
+        {
+            qCritical() << "Can't use color profile" << parser.value(profileOption) << ":" << profile.errorString();
+            valid = false;
+        }
+        else
+        {
+            renderer.setColorProfile(profile, PLEColorTransform::RenderingIntent(qMax(0, intent)));
+        }
+    }
+
+    if (parser.isSet(manifestOption))
+        valid = renderer.loadManifest(parser.value(manifestOption));
+
+    const QStringList args = parser.positionalArguments();
+
+    if (!args.isEmpty())
+    {
+        if (!parser.isSet(outputOption))
+        {
+            qCritical() << "Output file of" << args.first() << "isn't set";
+            valid = false;
+        }
+        else
+        {
+            PLEBatchRenderer::Document document;
+            document.templateFile = QFileInfo(args.first()).absoluteFilePath();
+            document.output       = QFileInfo(parser.value(outputOption)).absoluteFilePath();
+
+            foreach (const QString& image, args.mid(1))
+                document.images << QFileInfo(image).absoluteFilePath();
+
+            renderer.addDocument(document);
+        }
+    }
+    else if (!parser.isSet(manifestOption))
+    {
+        parser.showHelp(1);
+    }
+
+    const bool result = valid && renderer.run();
+
+    foreach (const QString& error, renderer.errors())
+        qCritical() << error;
+
+    MetaEngine::cleanupExiv2();
+
+    return (result ? 0 : 1);
+}
@@ -127,6 +127,7 @@ void BordersGroup::refresh()
     QRectF updateRect = graphicsItem()->boundingRect();
 
     this->calculateShape();
+    graphicsItem()->invalidateGeometry();
     updateRect        = updateRect.united(graphicsItem()->boundingRect());
 
     if (graphicsItem()->scene())
@@ -62,6 +62,8 @@ public:
 
 } // namespace PhotoLayoutsEditor
 
-Q_DECLARE_INTERFACE(PhotoLayoutsEditor::AbstractPhotoEffectFactory,"pl.coder89.ple.AbstractPhotoEffectFactory/1.0")
+// Version of the interface id is changed whenever AbstractPhotoEffectInterface ABI changes,
+// plugins built against other version are rejected by QPluginLoader
+Q_DECLARE_INTERFACE(PhotoLayoutsEditor::AbstractPhotoEffectFactory,"pl.coder89.ple.AbstractPhotoEffectFactory/2.0")
 
 #endif // ABSTRACT_PHOTO_EFFECT_FACTORY_H
@@ -23,3 +23,61 @@
  * ============================================================ */
 
 #include "abstractphotoeffectinterface.h"
+
+// Qt includes
+
+#include <QtConcurrent>
+
+namespace PhotoLayoutsEditor
+{
+
+QImage AbstractPhotoEffectInterface::processTiled(const QImage& image, qreal scale) const
+{
+    // Tiles grow with the halo, so pixels read around each tile stay a small part of its work
+    const int halo      = qMax(0, haloSize(scale));
+    const int tileSize  = qMax(256, 4 * halo);
+    const QImage source = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    QImage result(source.size(), QImage::Format_ARGB32_Premultiplied);
+
+    // Source view is only read
+    const PhotoEffectImageView src(const_cast<uchar*>(source.constBits()),
+                                   source.width(), source.height(), source.bytesPerLine());
+    const PhotoEffectImageView dst(result);
+    const int opacity  = strength();
+
+    QList<QRect> tiles;
+
+    for (int y = 0 ; y < src.height() ; y += tileSize)
+    {
+        for (int x = 0 ; x < src.width() ; x += tileSize)
+            tiles.append(QRect(x, y, tileSize, tileSize) & src.rect());
+    }
+
+    QtConcurrent::blockingMap(tiles, [=](const QRect& tile)
+        {
+            PhotoEffectImageView target = dst;
+            process(src, target, tile, scale);
+
+            if (opacity >= 100)
+                return;
+
+            for (int y = tile.top() ; y <= tile.bottom() ; ++y)
+            {
+                const QRgb* const in = src.scanLine(y);
+                QRgb* const out      = target.scanLine(y);
+
+                for (int x = tile.left() ; x <= tile.right() ; ++x)
+                {
+                    out[x] = qRgba((qRed(out[x])   * opacity + qRed(in[x])   * (100 - opacity) + 50) / 100,
+                                   (qGreen(out[x]) * opacity + qGreen(in[x]) * (100 - opacity) + 50) / 100,
+                                   (qBlue(out[x])  * opacity + qBlue(in[x])  * (100 - opacity) + 50) / 100,
+                                   (qAlpha(out[x]) * opacity + qAlpha(in[x]) * (100 - opacity) + 50) / 100);
+                }
+            }
+        }
+    );
+
+    return result;
+}
+
+} // namespace PhotoLayoutsEditor
@@ -36,6 +36,10 @@
 #include <QMetaProperty>
 #include <QDebug>
 
+// Local includes
+
+#include "photoeffectimageview.h"
+
 #define STRENGTH_PROPERTY QLatin1String("Strength")
 
 namespace PhotoLayoutsEditor
@@ -43,6 +47,7 @@ namespace PhotoLayoutsEditor
 
 class PhotoEffectsGroup;
 class AbstractPhotoEffectFactory;
+class ColorLookupTable;
 
 class AbstractPhotoEffectInterface : public QObject
 {
@@ -50,6 +55,15 @@ class AbstractPhotoEffectInterface : public QObject
 
 public:
 
+    /// Describes how the effect can be scheduled by the effects pipeline
+    enum ProcessingFlag
+    {
+        NoProcessingFlags      = 0x0,
+        PointOperation         = 0x1,  ///< Maps each color independently, implements mapColor()
+        NeighbourhoodOperation = 0x2,  ///< Reads up to haloSize() pixels around processed pixel
+        TiledProcessing        = 0x4   ///< Implements process()
+    };
+
     explicit AbstractPhotoEffectInterface(AbstractPhotoEffectFactory* factory, QObject* parent = nullptr)
       : QObject(parent),
         m_factory(factory),
@@ -79,6 +93,63 @@ public:
         return image;
     }
 
+    /** Applies effect to the image rendered with \a scale pixels per scene unit.
+     * Effects with spatial parameters (like blur radius) reimplement it to keep
+     * the result independent of the rendering resolution.
+     * Effects implementing process() are run tile by tile by default.
+     */
+    virtual QImage applyScaled(const QImage& image, qreal scale) const
+    {
+        if (processingFlags() & TiledProcessing)
+            return processTiled(image, scale);
+
+        return apply(image);
+    }
+
+    /// Returns combination of \enum ProcessingFlag values
+    virtual int processingFlags() const
+    {
+        return NoProcessingFlags;
+    }
+
+    /** Returns true if the effect maps each color independently of its neighbours.
+     * Chains of such effects are compiled into a single color lookup table.
+     */
+    bool isPointOperation() const
+    {
+        return (processingFlags() & PointOperation);
+    }
+
+    /// Returns number of pixels around a tile which process() reads for given rendering scale
+    virtual int haloSize(qreal /*scale*/) const
+    {
+        return 0;
+    }
+
+    /** Processes \a tile of \a source into the same area of \a destination without allocations.
+     * Both views cover the whole image, \a source may be read up to haloSize() pixels outside of the tile.
+     * Called concurrently for disjoint tiles, strength is applied by the caller.
+     * Used only if processingFlags() contains TiledProcessing.
+     */
+    virtual void process(const PhotoEffectImageView& /*source*/, PhotoEffectImageView& /*destination*/,
+                         const QRect& /*tile*/, qreal /*scale*/) const
+    {
+    }
+
+    /// Maps single color, used for point operations only (strength is applied by the caller)
+    virtual QRgb mapColor(QRgb color) const
+    {
+        return color;
+    }
+
+    /** Returns lookup table the effect is defined by, if any.
+     * Such effect used alone is applied from its own table instead of being resampled.
+     */
+    virtual const ColorLookupTable* lookupTable() const
+    {
+        return nullptr;
+    }
+
     virtual QString name()     const = 0;
     virtual QString toString() const = 0;
     virtual operator QString() const = 0;
@@ -189,6 +260,9 @@ protected:
         Q_EMIT changed();
     }
 
+    /// Runs process() over tiles of the image in parallel and blends the result according to the strength
+    QImage processTiled(const QImage& image, qreal scale) const;
+
     friend class AbstractPhotoEffectFactory;
 };
 
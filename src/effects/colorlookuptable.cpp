@@ -0,0 +1,383 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "colorlookuptable.h"
+
+// Qt includes
+
+#include <QFile>
+#include <QTextStream>
+#include <QtConcurrent>
+#include <QDebug>
+
+// Local includes
+
+#include "abstractphotoeffectinterface.h"
+
+namespace PhotoLayoutsEditor
+{
+
+ColorLookupTable::ColorLookupTable()
+    : m_size(0),
+      m_3d(true)
+{
+    for (int c = 0 ; c < 3 ; ++c)
+    {
+        m_domain_min[c] = 0.0F;
+        m_domain_max[c] = 1.0F;
+    }
+}
+
+ColorLookupTable ColorLookupTable::fromEffects(const QList<AbstractPhotoEffectInterface*>& effects, int size)
+{
+    ColorLookupTable result;
+
+    if (size < 2)
+        return result;
+
+    result.m_size = size;
+    result.m_table.resize(3 * size * size * size);
+    float* entry  = result.m_table.data();
+
+    for (int b = 0 ; b < size ; ++b)
+    {
+        for (int g = 0 ; g < size ; ++g)
+        {
+            for (int r = 0 ; r < size ; ++r, entry += 3)
+            {
+                QRgb color = qRgb(qRound(r * 255.0 / (size - 1)),
+                                  qRound(g * 255.0 / (size - 1)),
+                                  qRound(b * 255.0 / (size - 1)));
+
+                foreach (AbstractPhotoEffectInterface* const effect, effects)
+                {
+                    if (!effect)
+                        continue;
+
+                    // Strength blends effect result with its input like AbstractPhotoEffectInterface::apply() does
+                    const QRgb mapped = effect->mapColor(color);
+                    const int s       = effect->strength();
+                    color             = qRgb((qRed(mapped)   * s + qRed(color)   * (100 - s) + 50) / 100,
+                                             (qGreen(mapped) * s + qGreen(color) * (100 - s) + 50) / 100,
+                                             (qBlue(mapped)  * s + qBlue(color)  * (100 - s) + 50) / 100);
+                }
+
+                entry[0] = qRed(color)   / 255.0F;
+                entry[1] = qGreen(color) / 255.0F;
+                entry[2] = qBlue(color)  / 255.0F;
+            }
+        }
+    }
+
+    return result;
+}
+
+ColorLookupTable ColorLookupTable::fromCubeFile(const QString& path)
+{
+    ColorLookupTable result;
+    QFile file(path);
+
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        qDebug() << "Can't open LUT file" << path;
+        return result;
+    }
+
+    QTextStream stream(&file);
+    QVector<float> table;
+    int lutSize = 0;
+    bool lut3D  = true;
+
+    while (!stream.atEnd())
+    {
+        QString line = stream.readLine().simplified();
+
+        if (line.isEmpty() || line.startsWith(QLatin1Char('#')))
+            continue;
+
+        QStringList tokens = line.split(QLatin1Char(' '));
+
+        if (tokens.first().at(0).isLetter())
+        {
+            const QString keyword = tokens.first();
+
+            if      (keyword == QLatin1String("LUT_3D_SIZE") && tokens.count() == 2)
+            {
+                lutSize = tokens.at(1).toInt();
+                lut3D   = true;
+            }
+            else if (keyword == QLatin1String("LUT_1D_SIZE") && tokens.count() == 2)
+            {
+                lutSize = tokens.at(1).toInt();
+                lut3D   = false;
+            }
+            else if (keyword == QLatin1String("DOMAIN_MIN") && tokens.count() == 4)
+            {
+                for (int c = 0 ; c < 3 ; ++c)
+                    result.m_domain_min[c] = tokens.at(c + 1).toFloat();
+            }
+            else if (keyword == QLatin1String("DOMAIN_MAX") && tokens.count() == 4)
+            {
+                for (int c = 0 ; c < 3 ; ++c)
+                    result.m_domain_max[c] = tokens.at(c + 1).toFloat();
+            }
+
+            // TITLE and vendor specific keywords are ignored
+            continue;
+        }
+
+        if (tokens.count() != 3)
+        {
+            qDebug() << "Invalid LUT entry" << line << "in" << path;
+            return ColorLookupTable();
+        }
+
+        for (int c = 0 ; c < 3 ; ++c)
+        {
+            bool ok = false;
+            table.append(tokens.at(c).toFloat(&ok));
+
+            if (!ok)
+            {
+                qDebug() << "Invalid LUT entry" << line << "in" << path;
+                return ColorLookupTable();
+            }
+        }
+    }
+
+    const int expected = lut3D ? 3 * lutSize * lutSize * lutSize : 3 * lutSize;
+
+    if (lutSize < 2 || table.count() != expected)
+    {
+        qDebug() << "Invalid LUT size in" << path;
+        return ColorLookupTable();
+    }
+
+    for (int c = 0 ; c < 3 ; ++c)
+    {
+        if (result.m_domain_max[c] <= result.m_domain_min[c])
+        {
+            qDebug() << "Invalid LUT domain in" << path;
+            return ColorLookupTable();
+        }
+    }
+
+    result.m_size  = lutSize;
+    result.m_3d    = lut3D;
+    result.m_table = table;
+
+    return result;
+}
+
+bool ColorLookupTable::isValid() const
+{
+    return (m_size >= 2);
+}
+
+bool ColorLookupTable::is3D() const
+{
+    return m_3d;
+}
+
+int ColorLookupTable::size() const
+{
+    return m_size;
+}
+
+void ColorLookupTable::locate(int channel, int value, int& index, float& fraction) const
+{
+    float t = (value / 255.0F - m_domain_min[channel]) / (m_domain_max[channel] - m_domain_min[channel]);
+    t        = qBound(0.0F, t, 1.0F) * (m_size - 1);
+    index    = qMin(static_cast<int>(t), m_size - 2);
+    fraction = t - index;
+}
+
+void ColorLookupTable::interpolate(const int index[3], const float fraction[3], float result[3]) const
+{
+    const float* const table = m_table.constData();
+
+    if (!m_3d)
+    {
+        for (int c = 0 ; c < 3 ; ++c)
+        {
+            const float* const e = table + 3 * index[c] + c;
+            result[c]            = e[0] + (e[3] - e[0]) * fraction[c];
+        }
+
+        return;
+    }
+
+    const int dr = 3;
+    const int dg = 3 * m_size;
+    const int db = 3 * m_size * m_size;
+
+    const float fr = fraction[0];
+    const float fg = fraction[1];
+    const float fb = fraction[2];
+
+    const float* const c000 = table + index[0] * dr + index[1] * dg + index[2] * db;
+    const float* const c111 = c000 + dr + dg + db;
+    const float* c1;
+    const float* c2;
+    float w0, w1, w2, w3;
+
+    // Tetrahedral interpolation, the cube is split along its main diagonal
+    if (fr > fg)
+    {
+        if      (fg > fb)
+        {
+            c1 = c000 + dr;      c2 = c000 + dr + dg;
+            w0 = 1 - fr;         w1 = fr - fg;       w2 = fg - fb;       w3 = fb;
+        }
+        else if (fr > fb)
+        {
+            c1 = c000 + dr;      c2 = c000 + dr + db;
+            w0 = 1 - fr;         w1 = fr - fb;       w2 = fb - fg;       w3 = fg;
+        }
+        else
+        {
+            c1 = c000 + db;      c2 = c000 + dr + db;
+            w0 = 1 - fb;         w1 = fb - fr;       w2 = fr - fg;       w3 = fg;
+        }
+    }
+    else
+    {
+        if      (fb > fg)
+        {
+            c1 = c000 + db;      c2 = c000 + dg + db;
+            w0 = 1 - fb;         w1 = fb - fg;       w2 = fg - fr;       w3 = fr;
+        }
+        else if (fb > fr)
+        {
+            c1 = c000 + dg;      c2 = c000 + dg + db;
+            w0 = 1 - fg;         w1 = fg - fb;       w2 = fb - fr;       w3 = fr;
+        }
+        else
+        {
+            c1 = c000 + dg;      c2 = c000 + dr + dg;
+            w0 = 1 - fg;         w1 = fg - fr;       w2 = fr - fb;       w3 = fb;
+        }
+    }
+
+    for (int c = 0 ; c < 3 ; ++c)
+        result[c] = w0 * c000[c] + w1 * c1[c] + w2 * c2[c] + w3 * c111[c];
+}
+
+QRgb ColorLookupTable::toRgb(const float color[3], int alpha)
+{
+    return qRgba(qBound(0, static_cast<int>(color[0] * 255.0F + 0.5F), 255),
+                 qBound(0, static_cast<int>(color[1] * 255.0F + 0.5F), 255),
+                 qBound(0, static_cast<int>(color[2] * 255.0F + 0.5F), 255),
+                 alpha);
+}
+
+QRgb ColorLookupTable::map(QRgb color) const
+{
+    if (!isValid())
+        return color;
+
+    const int values[3] = { qRed(color), qGreen(color), qBlue(color) };
+    int index[3];
+    float fraction[3];
+    float result[3];
+
+    for (int c = 0 ; c < 3 ; ++c)
+        locate(c, values[c], index[c], fraction[c]);
+
+    interpolate(index, fraction, result);
+
+    return toRgb(result, qAlpha(color));
+}
+
+QImage ColorLookupTable::apply(const QImage& image, int strength) const
+{
+    if (!isValid() || image.isNull() || (strength <= 0))
+        return image;
+
+    // Cells of all 8-bit values are found once, the per pixel work is only the interpolation
+    QVector<int> indexes(3 * 256);
+    QVector<float> fractions(3 * 256);
+
+    for (int c = 0 ; c < 3 ; ++c)
+    {
+        for (int v = 0 ; v < 256 ; ++v)
+            locate(c, v, indexes[c * 256 + v], fractions[c * 256 + v]);
+    }
+
+    const QImage source = image.convertToFormat(QImage::Format_ARGB32);
+    QImage result(source.size(), QImage::Format_ARGB32);
+
+    const uchar* const srcBits = source.constBits();
+    const int srcStride        = source.bytesPerLine();
+    uchar* const dstBits       = result.bits();
+    const int dstStride        = result.bytesPerLine();
+    const int width            = source.width();
+    const int height           = source.height();
+    const int* const idx       = indexes.constData();
+    const float* const frac    = fractions.constData();
+    const int bandHeight       = 64;
+    const int s                = qMin(strength, 100);
+
+    QList<int> bands;
+
+    for (int top = 0 ; top < height ; top += bandHeight)
+        bands.append(top);
+
+    QtConcurrent::blockingMap(bands, [=](const int& top)
+        {
+            const int bottom = qMin(height, top + bandHeight);
+
+            for (int y = top ; y < bottom ; ++y)
+            {
+                const QRgb* const in = reinterpret_cast<const QRgb*>(srcBits + y * srcStride);
+                QRgb* const out      = reinterpret_cast<QRgb*>(dstBits + y * dstStride);
+
+                for (int x = 0 ; x < width ; ++x)
+                {
+                    const int r = qRed(in[x]);
+                    const int g = qGreen(in[x]);
+                    const int b = qBlue(in[x]);
+                    const int index[3]      = { idx[r],  idx[256 + g],  idx[512 + b]  };
+                    const float fraction[3] = { frac[r], frac[256 + g], frac[512 + b] };
+                    float color[3];
+
+                    interpolate(index, fraction, color);
+                    out[x] = toRgb(color, qAlpha(in[x]));
+
+                    if (s != 100)
+                    {
+                        out[x] = qRgba((qRed(out[x])   * s + r * (100 - s) + 50) / 100,
+                                       (qGreen(out[x]) * s + g * (100 - s) + 50) / 100,
+                                       (qBlue(out[x])  * s + b * (100 - s) + 50) / 100,
+                                       qAlpha(in[x]));
+                    }
+                }
+            }
+        }
+    );
+
+    return result;
+}
+
+} // namespace PhotoLayoutsEditor
@@ -0,0 +1,85 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef COLOR_LOOKUP_TABLE_H
+#define COLOR_LOOKUP_TABLE_H
+
+// Qt includes
+
+#include <QImage>
+#include <QList>
+#include <QVector>
+#include <QString>
+
+namespace PhotoLayoutsEditor
+{
+
+class AbstractPhotoEffectInterface;
+
+/** Color transformation stored as a 1D (per channel) or 3D lookup table.
+ * 3D tables are interpolated tetrahedrally, entries are stored with red changing
+ * fastest like in .cube files.
+ */
+class ColorLookupTable
+{
+public:
+
+    /// Creates invalid (empty) table
+    ColorLookupTable();
+
+    /// Compiles chain of point effects (bottom effect first) into a 3D table
+    static ColorLookupTable fromEffects(const QList<AbstractPhotoEffectInterface*>& effects, int size = 33);
+
+    /// Loads table from .cube file, returns invalid table on error
+    static ColorLookupTable fromCubeFile(const QString& path);
+
+    bool isValid() const;
+    bool is3D() const;
+    int size() const;
+
+    QRgb map(QRgb color) const;
+
+    /// Maps all pixels of the image, \a strength (0-100) blends result with the original colors
+    QImage apply(const QImage& image, int strength = 100) const;
+
+private:
+
+    /// Finds cell containing 8-bit channel value and position inside of it
+    void locate(int channel, int value, int& index, float& fraction) const;
+
+    /// Interpolates table entries of the cell, result is normalized to [0, 1]
+    void interpolate(const int index[3], const float fraction[3], float result[3]) const;
+
+    static QRgb toRgb(const float color[3], int alpha);
+
+    int            m_size;
+    bool           m_3d;
+    QVector<float> m_table;
+    float          m_domain_min[3];
+    float          m_domain_max[3];
+};
+
+} // namespace PhotoLayoutsEditor
+
+#endif // COLOR_LOOKUP_TABLE_H
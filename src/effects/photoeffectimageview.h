@@ -0,0 +1,116 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef PHOTO_EFFECT_IMAGE_VIEW_H
+#define PHOTO_EFFECT_IMAGE_VIEW_H
+
+// Qt includes
+
+#include <QImage>
+#include <QRect>
+
+namespace PhotoLayoutsEditor
+{
+
+/** Non owning view of premultiplied ARGB32 pixels.
+ * Rows are addressed through the stride so views can describe parts of
+ * bigger buffers. Views of the same image may be shared by threads working
+ * on disjoint tiles.
+ */
+class PhotoEffectImageView
+{
+public:
+
+    PhotoEffectImageView()
+        : m_bits(nullptr),
+          m_width(0),
+          m_height(0),
+          m_stride(0)
+    {
+    }
+
+    PhotoEffectImageView(uchar* bits, int width, int height, int stride)
+        : m_bits(bits),
+          m_width(width),
+          m_height(height),
+          m_stride(stride)
+    {
+    }
+
+    /// Image has to be in QImage::Format_ARGB32_Premultiplied and it's detached here
+    explicit PhotoEffectImageView(QImage& image)
+        : m_bits(image.bits()),
+          m_width(image.width()),
+          m_height(image.height()),
+          m_stride(image.bytesPerLine())
+    {
+        Q_ASSERT(image.format() == QImage::Format_ARGB32_Premultiplied);
+    }
+
+    bool isNull() const
+    {
+        return !m_bits;
+    }
+
+    int width() const
+    {
+        return m_width;
+    }
+
+    int height() const
+    {
+        return m_height;
+    }
+
+    int stride() const
+    {
+        return m_stride;
+    }
+
+    QRect rect() const
+    {
+        return QRect(0, 0, m_width, m_height);
+    }
+
+    QRgb* scanLine(int y) const
+    {
+        return reinterpret_cast<QRgb*>(m_bits + y * m_stride);
+    }
+
+    QRgb pixel(int x, int y) const
+    {
+        return scanLine(y)[x];
+    }
+
+private:
+
+    uchar* m_bits;
+    int    m_width;
+    int    m_height;
+    int    m_stride;
+};
+
+} // namespace PhotoLayoutsEditor
+
+#endif // PHOTO_EFFECT_IMAGE_VIEW_H
@@ -0,0 +1,174 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "photoeffectscache.h"
+
+// Qt includes
+
+#include <QCache>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSettings>
+#include <QDataStream>
+#include <QMetaProperty>
+#include <QCryptographicHash>
+
+// Local includes
+
+#include "abstractphotoeffectinterface.h"
+
+namespace PhotoLayoutsEditor
+{
+
+class PhotoEffectsCache::Private
+{
+public:
+
+    explicit Private()
+    {
+        QSettings config(QLatin1String("PhotoLayoutEditor"));
+        config.beginGroup(QLatin1String("Effects"));
+        cache.setMaxCost(config.value(QLatin1String("CacheSize"), 256).toInt() * 1024);
+        config.endGroup();
+    }
+
+    mutable QMutex                 mutex;
+    QCache<QByteArray, QImage>     cache;
+};
+
+PhotoEffectsCache::PhotoEffectsCache()
+    : d(new Private)
+{
+}
+
+PhotoEffectsCache::~PhotoEffectsCache()
+{
+    delete d;
+}
+
+PhotoEffectsCache* PhotoEffectsCache::instance()
+{
+    static PhotoEffectsCache m_instance;
+    return &m_instance;
+}
+
+QByteArray PhotoEffectsCache::imageKey(const QImage& image)
+{
+    QCryptographicHash hash(QCryptographicHash::Md5);
+
+    {
+        QByteArray header;
+        QDataStream stream(&header, QIODevice::WriteOnly);
+        stream << image.width() << image.height() << static_cast<int>(image.format());
+        hash.addData(header);
+    }
+
+    // Only the visible part of each scanline is hashed, padding bytes are undefined
+    const int lineLength = (image.width() * image.depth() + 7) / 8;
+
+    for (int y = 0 ; y < image.height() ; ++y)
+        hash.addData(reinterpret_cast<const char*>(image.constScanLine(y)), lineLength);
+
+    return hash.result();
+}
+
+QByteArray PhotoEffectsCache::stageKey(const QByteArray& inputKey, const AbstractPhotoEffectInterface* effect, qreal scale)
+{
+    QByteArray className;
+    QList<QPair<QByteArray, QVariant> > properties;
+
+    if (effect)
+    {
+        const QMetaObject* meta = effect->metaObject();
+        className               = QByteArray(meta->className());
+
+        for (int i = 0 ; i < meta->propertyCount() ; ++i)
+        {
+            QMetaProperty p = meta->property(i);
+            properties << qMakePair(QByteArray(p.name()), p.read(effect));
+        }
+    }
+
+    return stageKey(inputKey, className, properties, scale);
+}
+
+QByteArray PhotoEffectsCache::stageKey(const QByteArray& inputKey, const QByteArray& className,
+                                       const QList<QPair<QByteArray, QVariant> >& properties, qreal scale)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream << inputKey << scale;
+
+    if (!className.isEmpty())
+    {
+        stream << className;
+
+        for (int i = 0 ; i < properties.count() ; ++i)
+            stream << properties.at(i).first << properties.at(i).second;
+    }
+
+    return QCryptographicHash::hash(data, QCryptographicHash::Md5);
+}
+
+bool PhotoEffectsCache::find(const QByteArray& key, QImage& image) const
+{
+    QMutexLocker locker(&d->mutex);
+    QImage* const cached = d->cache.object(key);
+
+    if (!cached)
+        return false;
+
+    image = *cached;
+    return true;
+}
+
+void PhotoEffectsCache::insert(const QByteArray& key, const QImage& image)
+{
+    if (image.isNull())
+        return;
+
+    QMutexLocker locker(&d->mutex);
+    int cost = qMax(1, image.bytesPerLine() * image.height() / 1024);
+    d->cache.insert(key, new QImage(image), cost);
+}
+
+void PhotoEffectsCache::clear()
+{
+    QMutexLocker locker(&d->mutex);
+    d->cache.clear();
+}
+
+int PhotoEffectsCache::memoryBudget() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->cache.maxCost();
+}
+
+void PhotoEffectsCache::setMemoryBudget(int kilobytes)
+{
+    QMutexLocker locker(&d->mutex);
+    d->cache.setMaxCost(kilobytes);
+}
+
+} // namespace PhotoLayoutsEditor
@@ -0,0 +1,84 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef PHOTO_EFFECTS_CACHE_H
+#define PHOTO_EFFECTS_CACHE_H
+
+// Qt includes
+
+#include <QByteArray>
+#include <QImage>
+#include <QList>
+#include <QPair>
+#include <QVariant>
+
+namespace PhotoLayoutsEditor
+{
+
+class AbstractPhotoEffectInterface;
+
+/** Memoizes intermediate results of effects chains.
+ * Each stage of a chain is keyed by the hash of its input, the effect type and its
+ * serialized properties, so editing one effect only recomputes the stages above it.
+ * The cache is shared by all items and evicts the least recently used images when
+ * its memory budget is exceeded.
+ */
+class PhotoEffectsCache
+{
+public:
+
+    static PhotoEffectsCache* instance();
+
+    /// Returns content hash of the image pixels
+    static QByteArray imageKey(const QImage& image);
+
+    /// Returns key of the stage produced by applying \a effect at \a scale to the input identified by \a inputKey
+    static QByteArray stageKey(const QByteArray& inputKey, const AbstractPhotoEffectInterface* effect, qreal scale = 1.0);
+
+    /// Same key computed from the class name of the effect and its property values in the order of its meta object
+    static QByteArray stageKey(const QByteArray& inputKey, const QByteArray& className,
+                               const QList<QPair<QByteArray, QVariant> >& properties, qreal scale = 1.0);
+
+    bool find(const QByteArray& key, QImage& image) const;
+    void insert(const QByteArray& key, const QImage& image);
+    void clear();
+
+    /// Memory budget in kilobytes
+    int memoryBudget() const;
+    void setMemoryBudget(int kilobytes);
+
+private:
+
+    PhotoEffectsCache();
+    ~PhotoEffectsCache();
+    PhotoEffectsCache(const PhotoEffectsCache&) = delete;
+    PhotoEffectsCache& operator=(const PhotoEffectsCache&) = delete;
+
+    class Private;
+    Private* const d;
+};
+
+} // namespace PhotoLayoutsEditor
+
+#endif // PHOTO_EFFECTS_CACHE_H
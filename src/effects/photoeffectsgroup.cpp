@@ -27,12 +27,141 @@
 // Local includes
 
 #include "photoeffectsloader.h"
+#include "photoeffectscache.h"
+#include "colorlookuptable.h"
 #include "abstractphoto.h"
 #include "abstractphotoeffectfactory.h"
 
 namespace PhotoLayoutsEditor
 {
 
+/// Returns the topmost stage which is cached and sets \a image to its result, -1 if there's none
+static int cachedStage(const QList<QByteArray>& keys, QImage& image)
+{
+    PhotoEffectsCache* const cache = PhotoEffectsCache::instance();
+    int stage                      = keys.count()-1;
+
+    for ( ; stage >= 0; --stage)
+    {
+        if (cache->find(keys[stage], image))
+            break;
+    }
+
+    return stage;
+}
+
+/** Applies effects of the stages above \a stage to its result \a image and caches results of the stages.
+ * Effects are in the order of the group, so the last one is the first stage.
+ */
+static QImage applyStages(const QList<AbstractPhotoEffectInterface*>& effects, const QList<QByteArray>& keys,
+                          int stage, const QImage& image, qreal scale)
+{
+    PhotoEffectsCache* const cache = PhotoEffectsCache::instance();
+    const int count                = effects.count();
+    QImage temp                    = image;
+
+    for (++stage; stage < count; ++stage)
+    {
+        AbstractPhotoEffectInterface* effect = effects[count-1-stage];
+        QList<AbstractPhotoEffectInterface*> chain;
+
+        // Point operations, single or consecutive, are compiled into one color lookup table
+        while (effect && effect->isPointOperation())
+        {
+            chain.push_back(effect);
+
+            if (stage+1 == count)
+                break;
+
+            AbstractPhotoEffectInterface* const next = effects[count-2-stage];
+
+            if (!next || !next->isPointOperation())
+                break;
+
+            effect = next;
+            ++stage;
+        }
+
+        // Loaded table used alone is applied as is, resampling it would only lose precision
+        if      ((chain.count() == 1) && chain.first()->lookupTable())
+            temp = chain.first()->lookupTable()->apply(temp, chain.first()->strength());
+        else if (!chain.isEmpty())
+            temp = ColorLookupTable::fromEffects(chain).apply(temp);
+        else if (effect)
+            temp = effect->applyScaled(temp, scale);
+
+        cache->insert(keys[stage], temp);
+    }
+
+    return temp;
+}
+
+/// Creates effect in the calling thread, effects have no parent so they can be used by the thread which created them
+static AbstractPhotoEffectInterface* createEffect(const PhotoEffectsChain::Effect& description)
+{
+    AbstractPhotoEffectFactory* const factory = PhotoEffectsLoader::getFactoryByName(description.name);
+
+    if (!factory)
+        return nullptr;
+
+    AbstractPhotoEffectInterface* const effect = factory->getEffectInstance(description.name);
+
+    if (!effect)
+        return nullptr;
+
+    const QMetaObject* meta = effect->metaObject();
+
+    for (int i = 0 ; i < description.properties.count() ; ++i)
+    {
+        const int index = meta->indexOfProperty(description.properties.at(i).first.constData());
+
+        if (index >= 0)
+            meta->property(index).write(effect, description.properties.at(i).second);
+    }
+
+    return effect;
+}
+
+bool PhotoEffectsChain::isEmpty() const
+{
+    return effects.isEmpty();
+}
+
+QImage PhotoEffectsChain::apply(const QImage& image, qreal scale) const
+{
+    if (effects.isEmpty() || image.isNull())
+        return image;
+
+    QList<QByteArray> keys;
+    QByteArray key = PhotoEffectsCache::imageKey(image);
+
+    for (int i = effects.count()-1; i >= 0; --i)
+    {
+        key = PhotoEffectsCache::stageKey(key, effects[i].className, effects[i].properties, scale);
+        keys.push_back(key);
+    }
+
+    QImage temp     = image;
+    const int stage = cachedStage(keys, temp);
+    const int count = effects.count();
+
+    if (stage == count-1)
+        return temp;
+
+    // Effects below the cached stage aren't needed
+    QList<AbstractPhotoEffectInterface*> instances;
+
+    for (int i = 0 ; i < count ; ++i)
+        instances << ((count-1-i > stage) ? createEffect(effects[i]) : nullptr);
+
+    temp = applyStages(instances, keys, stage, temp, scale);
+    qDeleteAll(instances);
+
+    return temp;
+}
+
+// ---------------------------------------------------------------------
+
 class PhotoEffectsGroupPrivate
 {
     explicit PhotoEffectsGroupPrivate(PhotoEffectsGroup* group)
@@ -133,19 +262,52 @@ void PhotoEffectsGroup::push_front(AbstractPhotoEffectInterface* effect)
     Q_EMIT layoutChanged();
 }
 
-QImage PhotoEffectsGroup::apply(const QImage& image)
+QImage PhotoEffectsGroup::apply(const QImage& image, qreal scale)
 {
-    QImage temp = image;
+    if (d->effects.isEmpty() || image.isNull())
+        return image;
+
+    // Stage keys are chained so each one depends on every effect below it
+    QList<QByteArray> keys;
+    QByteArray key = PhotoEffectsCache::imageKey(image);
 
     for (int i = d->effects.count()-1; i >= 0; --i)
     {
-        AbstractPhotoEffectInterface* effect = d->effects[i];
+        key = PhotoEffectsCache::stageKey(key, d->effects[i], scale);
+        keys.push_back(key);
+    }
+
+    QImage temp     = image;
+    const int stage = cachedStage(keys, temp);
+
+    return applyStages(d->effects, keys, stage, temp, scale);
+}
+
+PhotoEffectsChain PhotoEffectsGroup::chain() const
+{
+    PhotoEffectsChain result;
+
+    foreach (AbstractPhotoEffectInterface* const effect, d->effects)
+    {
+        PhotoEffectsChain::Effect description;
 
         if (effect)
-            temp = effect->apply(temp);
+        {
+            const QMetaObject* meta = effect->metaObject();
+            description.name        = effect->name();
+            description.className   = QByteArray(meta->className());
+
+            for (int i = 0 ; i < meta->propertyCount() ; ++i)
+            {
+                QMetaProperty p = meta->property(i);
+                description.properties << qMakePair(QByteArray(p.name()), p.read(effect));
+            }
+        }
+
+        result.effects << description;
     }
 
-    return temp;
+    return result;
 }
 
 AbstractPhoto* PhotoEffectsGroup::photo() const
@@ -25,6 +25,15 @@
 #ifndef PHOTOEFFECTSGROUP_H
 #define PHOTOEFFECTSGROUP_H
 
+// Qt includes
+
+#include <QByteArray>
+#include <QImage>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QVariant>
+
 // Local includes
 
 #include "abstractmovablemodel.h"
@@ -40,6 +49,29 @@ class PhotoEffectsLoader;
 class AbstractPhotoEffectInterface;
 class PhotoEffectsGroupPrivate;
 
+/** Copy of the effects of a group which can be applied in any thread.
+ * Effects are stored by their names and property values, they're recreated by their factories
+ * in the applying thread and only for the stages which aren't cached yet.
+ */
+class PhotoEffectsChain
+{
+public:
+
+    /// Name the factory knows the effect by, its class name and values of its properties in the order of its meta object
+    struct Effect
+    {
+        QString                             name;
+        QByteArray                          className;
+        QList<QPair<QByteArray, QVariant> > properties;
+    };
+
+    bool isEmpty() const;
+    QImage apply(const QImage& image, qreal scale = 1.0) const;
+
+    /// Effects in the order of the group, the last one is applied first
+    QList<Effect> effects;
+};
+
 class PhotoEffectsGroup : public AbstractMovableModel
 {
     Q_OBJECT
@@ -57,6 +89,9 @@ public:
     static PhotoEffectsGroup* fromSvg(const QDomElement& element, AbstractPhoto* graphicsItem);
     AbstractPhoto* photo() const;
 
+    /// Returns copy of the effects to be applied outside of the GUI thread
+    PhotoEffectsChain chain() const;
+
 protected:
     // Implement AbstractMovableModel methods
     bool moveRowsData(int sourcePosition, int sourceCount, int destPosition) override;
@@ -82,7 +117,7 @@ public Q_SLOTS:
     void push_back(AbstractPhotoEffectInterface* effect);
     void push_front(AbstractPhotoEffectInterface* effect);
     void emitEffectsChanged(AbstractPhotoEffectInterface* effect = nullptr);
-    QImage apply(const QImage& image);
+    QImage apply(const QImage& image, qreal scale = 1.0);
 };
 
 } // namespace PhotoLayoutsEditor
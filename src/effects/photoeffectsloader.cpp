@@ -27,6 +27,9 @@
 // Qt includes
 
 #include <QApplication>
+#include <QDir>
+#include <QLibrary>
+#include <QPluginLoader>
 
 // Local includes
 
@@ -95,6 +98,47 @@ bool PhotoEffectsLoader::registerEffect(AbstractPhotoEffectFactory* effectFactor
     return result;
 }
 
+int PhotoEffectsLoader::loadPlugins()
+{
+    QStringList paths;
+
+    foreach (const QString& path, QCoreApplication::libraryPaths())
+        paths << path + QLatin1String("/photolayoutseditor/effects");
+
+    paths << QString::fromLocal8Bit(qgetenv("PLE_EFFECTS_PATH")).split(QDir::listSeparator(), QString::SkipEmptyParts);
+
+    int result = 0;
+
+    foreach (const QString& path, paths)
+    {
+        QDir dir(path);
+
+        foreach (const QString& fileName, dir.entryList(QDir::Files))
+        {
+            const QString filePath = dir.absoluteFilePath(fileName);
+
+            if (!QLibrary::isLibrary(filePath))
+                continue;
+
+            QPluginLoader loader(filePath);
+            AbstractPhotoEffectFactory* const factory = qobject_cast<AbstractPhotoEffectFactory*>(loader.instance());
+
+            // Plugins built against another interface version fail the cast too
+            if (!factory)
+            {
+                qDebug() << "Not a compatible effects plugin:" << filePath << loader.errorString();
+                loader.unload();
+                continue;
+            }
+
+            if (registerEffect(factory))
+                ++result;
+        }
+    }
+
+    return result;
+}
+
 QStringList PhotoEffectsLoader::registeredEffectsNames()
 {
     return registeredEffects.keys();
@@ -88,6 +88,13 @@ public:
      */
     static bool registerEffect(AbstractPhotoEffectFactory* effectFactory);
 
+    /** Loads effects plugins and registers their factories.
+     * Plugins are searched in "photolayoutseditor/effects" subdirectory of Qt library paths,
+     * and in directories listed in PLE_EFFECTS_PATH environment variable.
+     * Returns number of loaded plugins.
+     */
+    static int loadPlugins();
+
     /** Returns registered effects names
      * This implementation returns \class QStringList object with effects names obtained by calling \fn effectName()
      * method of its factory object.
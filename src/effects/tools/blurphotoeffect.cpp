@@ -39,7 +39,12 @@ BlurPhotoEffect::BlurPhotoEffect(StandardEffectsFactory* factory, QObject* paren
 
 QImage BlurPhotoEffect::apply(const QImage& image) const
 {
-    int tempRadius = radius();
+    return applyScaled(image, 1.0);
+}
+
+QImage BlurPhotoEffect::applyScaled(const QImage& image, qreal scale) const
+{
+    int tempRadius = qRound(radius() * scale);
 
     if (!tempRadius)
         return image;
@@ -47,6 +47,7 @@ public:
 
     explicit BlurPhotoEffect(StandardEffectsFactory* factory, QObject* parent = nullptr);
     QImage apply(const QImage& image) const override;
+    QImage applyScaled(const QImage& image, qreal scale) const override;
     QString name() const override;
     QString toString() const override;
     operator QString() const override;
@@ -51,6 +51,32 @@ public:
     QString toString() const override;
     operator QString() const override;
 
+    int processingFlags() const override
+    {
+        return PointOperation;
+    }
+
+    /// Same as colorized(): gray value overlaid with the color
+    QRgb mapColor(QRgb color) const override
+    {
+        if (!m_color.alpha())
+            return color;
+
+        const qreal d    = qGray(color) / 255.0;
+        const qreal sa   = m_color.alphaF();
+        const qreal s[3] = { m_color.redF() * sa, m_color.greenF() * sa, m_color.blueF() * sa };
+        int result[3];
+
+        for (int c = 0; c < 3; ++c)
+        {
+            qreal v   = (2 * d < 1) ? 2 * s[c] * d
+                                    : sa - 2 * (1 - d) * (sa - s[c]);
+            result[c] = qBound(0, qRound((v + d * (1 - sa)) * 255), 255);
+        }
+
+        return qRgba(result[0], result[1], result[2], qAlpha(color));
+    }
+
     QString propertyName(const QMetaProperty& property) const override
     {
         if (!QString::fromLatin1("color").compare(QLatin1String(property.name())))
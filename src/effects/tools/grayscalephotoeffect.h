@@ -47,6 +47,17 @@ public:
     QString toString() const override;
     operator QString() const override;
 
+    int processingFlags() const override
+    {
+        return PointOperation;
+    }
+
+    QRgb mapColor(QRgb color) const override
+    {
+        int val = qGray(color);
+        return qRgba(val, val, val, qAlpha(color));
+    }
+
 private:
 
     static inline QImage greyscaled(const QImage& image)
@@ -0,0 +1,79 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "lutphotoeffect.h"
+
+// Qt includes
+
+#include <QFileInfo>
+
+// Local includes
+
+#include "standardeffectsfactory.h"
+
+namespace PhotoLayoutsEditor
+{
+
+LutPhotoEffect::LutPhotoEffect(StandardEffectsFactory* factory, QObject* parent)
+    : AbstractPhotoEffectInterface(factory, parent)
+{
+}
+
+void LutPhotoEffect::setFile(const QString& file)
+{
+    if (file == m_file)
+        return;
+
+    m_file  = file;
+    m_table = ColorLookupTable::fromCubeFile(file);
+    this->propertiesChanged();
+}
+
+QImage LutPhotoEffect::apply(const QImage& image) const
+{
+    if (!strength() || !m_table.isValid())
+        return image;
+
+    return m_table.apply(image, strength());
+}
+
+QString LutPhotoEffect::name() const
+{
+    return QObject::tr("LUT effect");
+}
+
+QString LutPhotoEffect::toString() const
+{
+    if (m_file.isEmpty())
+        return this->name();
+
+    return this->name() + QLatin1String(" [") + QFileInfo(m_file).fileName() + QLatin1Char(']');
+}
+
+LutPhotoEffect::operator QString() const
+{
+    return toString();
+}
+
+} // namespace PhotoLayoutsEditor
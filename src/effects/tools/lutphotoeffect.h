@@ -0,0 +1,107 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef LUT_PHOTO_EFFECT_H
+#define LUT_PHOTO_EFFECT_H
+
+// Local includes
+
+#include "abstractphotoeffectinterface.h"
+#include "colorlookuptable.h"
+
+#define FILE_PROPERTY QLatin1String("LUT file")
+
+namespace PhotoLayoutsEditor
+{
+
+class StandardEffectsFactory;
+
+/// Applies color lookup table loaded from .cube file
+class LutPhotoEffect : public AbstractPhotoEffectInterface
+{
+    Q_OBJECT
+
+    QString          m_file;
+    ColorLookupTable m_table;
+
+public:
+
+    explicit LutPhotoEffect(StandardEffectsFactory* factory, QObject* parent = nullptr);
+    QImage apply(const QImage& image) const override;
+    QString name() const override;
+    QString toString() const override;
+    operator QString() const override;
+
+    int processingFlags() const override
+    {
+        return PointOperation;
+    }
+
+    QRgb mapColor(QRgb color) const override
+    {
+        return m_table.map(color);
+    }
+
+    const ColorLookupTable* lookupTable() const override
+    {
+        return &m_table;
+    }
+
+    QString propertyName(const QMetaProperty& property) const override
+    {
+        if (!QString::fromLatin1("file").compare(QLatin1String(property.name())))
+            return FILE_PROPERTY;
+
+        return AbstractPhotoEffectInterface::propertyName(property);
+    }
+
+    QVariant propertyValue(const QString& propertyName) const override
+    {
+        if (propertyName == FILE_PROPERTY)
+            return m_file;
+
+        return AbstractPhotoEffectInterface::propertyValue(propertyName);
+    }
+
+    void setPropertyValue(const QString& propertyName, const QVariant& value) override
+    {
+        if (FILE_PROPERTY == propertyName)
+            this->setFile(value.toString());
+        else
+            AbstractPhotoEffectInterface::setPropertyValue(propertyName, value);
+    }
+
+    Q_PROPERTY(QString file READ file WRITE setFile)
+
+    QString file() const
+    {
+        return m_file;
+    }
+
+    void setFile(const QString& file);
+};
+
+} // namespace PhotoLayoutsEditor
+
+#endif // LUT_PHOTO_EFFECT_H
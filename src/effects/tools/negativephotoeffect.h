@@ -52,6 +52,16 @@ public:
     QString toString() const override;
     operator QString() const override;
 
+    int processingFlags() const override
+    {
+        return PointOperation;
+    }
+
+    QRgb mapColor(QRgb color) const override
+    {
+        return qRgba(255-qRed(color), 255-qGreen(color), 255-qBlue(color), qAlpha(color));
+    }
+
 private:
 
     static QImage negative(const QImage& image)
@@ -0,0 +1,146 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "pixelizephotoeffect.h"
+
+// Qt includes
+
+#include <QVector>
+
+// Local includes
+
+#include "standardeffectsfactory.h"
+
+namespace PhotoLayoutsEditor
+{
+
+/**
+ * Averages blocks of one band of rows [top, top+pixelSize) which intersect \a area
+ * and writes them into the \a area part of \a destination.
+ * Column sums of the band are turned into a summed-area table along the row,
+ * so the sum of any block costs two lookups whatever the pixel size is.
+ * Rows are addressed through their own stride, images don't have to be contiguous.
+ */
+static void pixelizeBand(const PhotoEffectImageView& source, const PhotoEffectImageView& destination,
+                         int top, int pixelSize, const QRect& area)
+{
+    const int bottom = qMin(source.height(), top + pixelSize);
+    const int first  = (area.left() / pixelSize) * pixelSize;
+    const int last   = qMin(source.width(), (area.right() / pixelSize + 1) * pixelSize);
+    QVector<quint32> sums(4 * (last - first + 1), 0);
+
+    for (int y = top ; y < bottom ; ++y)
+    {
+        const QRgb* const line = source.scanLine(y);
+        quint32* s             = sums.data() + 4;
+
+        for (int x = first ; x < last ; ++x, s += 4)
+        {
+            s[0] += qAlpha(line[x]);
+            s[1] += qRed(line[x]);
+            s[2] += qGreen(line[x]);
+            s[3] += qBlue(line[x]);
+        }
+    }
+
+    for (int i = 4 ; i < sums.count() ; ++i)
+        sums[i] += sums[i - 4];
+
+    const int rowBegin = qMax(top, area.top());
+    const int rowEnd   = qMin(bottom, area.bottom() + 1);
+
+    for (int left = first ; left < last ; left += pixelSize)
+    {
+        const int right        = qMin(last, left + pixelSize);
+        const quint32 count    = (right - left) * (bottom - top);
+        const quint32* const l = sums.constData() + 4 * (left - first);
+        const quint32* const r = sums.constData() + 4 * (right - first);
+
+        QRgb color = qRgba((r[1] - l[1] + count / 2) / count,
+                           (r[2] - l[2] + count / 2) / count,
+                           (r[3] - l[3] + count / 2) / count,
+                           (r[0] - l[0] + count / 2) / count);
+
+        const int columnBegin = qMax(left, area.left());
+        const int columnEnd   = qMin(right, area.right() + 1);
+
+        for (int y = rowBegin ; y < rowEnd ; ++y)
+        {
+            QRgb* const line = destination.scanLine(y);
+
+            for (int x = columnBegin ; x < columnEnd ; ++x)
+                line[x] = color;
+        }
+    }
+}
+
+PixelizePhotoEffect::PixelizePhotoEffect(StandardEffectsFactory* factory, QObject* parent)
+    : AbstractPhotoEffectInterface(factory, parent),
+      m_pixel_size(10)
+{
+}
+
+QImage PixelizePhotoEffect::apply(const QImage& image) const
+{
+    return applyScaled(image, 1.0);
+}
+
+QImage PixelizePhotoEffect::applyScaled(const QImage& image, qreal scale) const
+{
+    if (qRound(pixelSize() * scale) <= 1)
+        return image;
+
+    return AbstractPhotoEffectInterface::applyScaled(image, scale);
+}
+
+int PixelizePhotoEffect::haloSize(qreal scale) const
+{
+    return qMax(1, qRound(pixelSize() * scale)) - 1;
+}
+
+void PixelizePhotoEffect::process(const PhotoEffectImageView& source, PhotoEffectImageView& destination,
+                                  const QRect& tile, qreal scale) const
+{
+    const int tempPixelSize = qMax(1, qRound(pixelSize() * scale));
+
+    for (int top = (tile.top() / tempPixelSize) * tempPixelSize ; top <= tile.bottom() ; top += tempPixelSize)
+        pixelizeBand(source, destination, top, tempPixelSize, tile);
+}
+
+QString PixelizePhotoEffect::name() const
+{
+    return QObject::tr("Pixelize effect");
+}
+
+QString PixelizePhotoEffect::toString() const
+{
+    return this->name() + QLatin1String(" [") + QString::number(this->pixelSize()) + QLatin1Char(']');
+}
+
+PixelizePhotoEffect::operator QString() const
+{
+    return toString();
+}
+
+} // namespace PhotoLayoutsEditor
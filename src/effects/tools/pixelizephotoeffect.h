@@ -0,0 +1,135 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef PIXELIZE_PHOTO_EFFECT_H
+#define PIXELIZE_PHOTO_EFFECT_H
+
+#include "abstractphotoeffectinterface.h"
+
+#include <QImage>
+
+#define PIXEL_SIZE_PROPERTY QLatin1String("Pixel size")
+
+namespace PhotoLayoutsEditor
+{
+
+class StandardEffectsFactory;
+
+class PixelizePhotoEffect : public AbstractPhotoEffectInterface
+{
+    Q_OBJECT
+
+    int m_pixel_size;
+
+public:
+
+    explicit PixelizePhotoEffect(StandardEffectsFactory* factory, QObject* parent = nullptr);
+    QImage apply(const QImage& image) const override;
+    QImage applyScaled(const QImage& image, qreal scale) const override;
+    QString name() const override;
+    QString toString() const override;
+    operator QString() const override;
+
+    int processingFlags() const override
+    {
+        return NeighbourhoodOperation | TiledProcessing;
+    }
+
+    int haloSize(qreal scale) const override;
+    void process(const PhotoEffectImageView& source, PhotoEffectImageView& destination,
+                 const QRect& tile, qreal scale) const override;
+
+    QString propertyName(const QMetaProperty& property) const override
+    {
+        if (!QString::fromLatin1("pixelSize").compare(QLatin1String(property.name())))
+            return PIXEL_SIZE_PROPERTY;
+
+        return AbstractPhotoEffectInterface::propertyName(property);
+    }
+
+    QVariant propertyValue(const QString& propertyName) const override
+    {
+        if (propertyName == PIXEL_SIZE_PROPERTY)
+            return m_pixel_size;
+
+        return AbstractPhotoEffectInterface::propertyValue(propertyName);
+    }
+
+    void setPropertyValue(const QString& propertyName, const QVariant& value) override
+    {
+        if (PIXEL_SIZE_PROPERTY == propertyName)
+            this->setPixelSize(value.toInt());
+        else
+            AbstractPhotoEffectInterface::setPropertyValue(propertyName, value);
+    }
+
+    QVariant stringNames(const QMetaProperty& property) override
+    {
+        return AbstractPhotoEffectInterface::stringNames(property);
+    }
+
+    QVariant minimumValue(const QMetaProperty& property) override
+    {
+        if (!QString::fromLatin1("pixelSize").compare(QLatin1String(property.name())))
+            return 1;
+
+        return AbstractPhotoEffectInterface::minimumValue(property);
+    }
+
+    QVariant maximumValue(const QMetaProperty& property) override
+    {
+        if (!QString::fromLatin1("pixelSize").compare(QLatin1String(property.name())))
+            return 200;
+
+        return AbstractPhotoEffectInterface::maximumValue(property);
+    }
+
+    QVariant stepValue(const QMetaProperty& property) override
+    {
+        if (!QString::fromLatin1("pixelSize").compare(QLatin1String(property.name())))
+            return 1;
+
+        return AbstractPhotoEffectInterface::stepValue(property);
+    }
+
+    Q_PROPERTY(int pixelSize READ pixelSize WRITE setPixelSize)
+
+    int pixelSize() const
+    {
+        return m_pixel_size;
+    }
+
+    void setPixelSize(int pixelSize)
+    {
+        if (pixelSize < 1 || pixelSize > 200)
+            return;
+
+        m_pixel_size = pixelSize;
+        this->propertiesChanged();
+    }
+};
+
+} // namespace PhotoLayoutsEditor
+
+#endif // PIXELIZE_PHOTO_EFFECT_H
@@ -46,6 +46,17 @@ public:
     QString toString() const override;
     operator QString() const override;
 
+    int processingFlags() const override
+    {
+        return PointOperation;
+    }
+
+    QRgb mapColor(QRgb color) const override
+    {
+        int gr = qGray(color);
+        return qRgba(qMin(gr+40, 255), qMin(gr+20, 255), qMax(gr-20, 0), qAlpha(color));
+    }
+
 private:
 
     static inline QImage sepia_converted(const QImage& image)
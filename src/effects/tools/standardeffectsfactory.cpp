@@ -31,6 +31,8 @@
 #include "grayscalephotoeffect.h"
 #include "sepiaphotoeffect.h"
 #include "negativephotoeffect.h"
+#include "pixelizephotoeffect.h"
+#include "lutphotoeffect.h"
 
 namespace PhotoLayoutsEditor
 {
@@ -57,6 +59,12 @@ AbstractPhotoEffectInterface* StandardEffectsFactory::getEffectInstance(const QS
     if (name == QObject::tr("Negative effect"))
         return new NegativePhotoEffect(this);
 
+    if (name == QObject::tr("Pixelize effect"))
+        return new PixelizePhotoEffect(this);
+
+    if (name == QObject::tr("LUT effect"))
+        return new LutPhotoEffect(this);
+
     return nullptr;
 }
 
@@ -66,7 +74,9 @@ QString StandardEffectsFactory::effectName() const
            QObject::tr("Colorize effect") + QLatin1String(";") +
            QObject::tr("Grayscale effect") + QLatin1String(";") +
            QObject::tr("Sepia effect") + QLatin1String(";") +
-           QObject::tr("Negative effect");
+           QObject::tr("Negative effect") + QLatin1String(";") +
+           QObject::tr("Pixelize effect") + QLatin1String(";") +
+           QObject::tr("LUT effect");
 }
 
 } // namespace PhotoLayoutsEditor
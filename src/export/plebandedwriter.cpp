@@ -0,0 +1,1188 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "plebandedwriter.h"
+
+// C++ includes
+
+#include <csetjmp>
+#include <cstdio>
+
+// Qt includes
+
+#include <QDateTime>
+#include <QFile>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QSaveFile>
+#include <QScopedPointer>
+#include <QDebug>
+
+// Libpng, libjpeg and libtiff includes
+
+#include <png.h>
+#include <tiffio.h>
+
+extern "C"
+{
+#include <jpeglib.h>
+#include <jerror.h>
+}
+
+#define JPEG_QUALITY        75      // Same as default quality of QImageWriter
+#define JPEG_BUFFER_SIZE    4096
+#define TIFF_ROWS_PER_STRIP 64      // Updated TIFF files are re-encoded in multiples of these rows
+
+namespace PhotoLayoutsEditor
+{
+
+/**
+ * TIFF writer passing band rows to libtiff as deflate compressed RGBA strips.
+ * Files written before are updated like PNG ones, the new file is written next to the old one
+ * and strips which weren't replaced are copied from it as they are, without decoding them.
+ */
+class PLETiffBandedWriter : public PLEBandedWriter
+{
+public:
+
+    PLETiffBandedWriter()
+        : m_tiff(nullptr),
+          m_source_tiff(nullptr),
+          m_rows_per_strip(TIFF_ROWS_PER_STRIP),
+          m_rows(0)
+    {
+    }
+
+    ~PLETiffBandedWriter() override
+    {
+        cleanup();
+    }
+
+    bool isStreaming() const override
+    {
+        return true;
+    }
+
+    bool open(const QString& fileName, const QSize& size) override
+    {
+        cleanup();
+
+        // BigTIFF is used only when the file could exceed 4 GB, classic TIFF is read by more applications
+        const bool big = (qint64(size.width()) * size.height() * 4 > Q_INT64_C(0x7FFFFFFF));
+
+        m_size           = size;
+        m_rows           = 0;
+        m_rows_per_strip = TIFF_ROWS_PER_STRIP;
+
+        return createEncoder(fileName, big ? "w8" : "w");
+    }
+
+    bool writeBand(const QImage& band) override
+    {
+        if (!m_tiff || band.width() != m_size.width() || m_rows + band.height() > m_size.height())
+        {
+            m_error = QObject::tr("Invalid band size.");
+            return false;
+        }
+
+        // Byte order of RGBA8888 is the order of TIFF RGBA samples
+        const QImage rgba   = band.convertToFormat(QImage::Format_RGBA8888);
+        const int rowLength = m_size.width() * 4;
+
+        for (int y = 0 ; y < rgba.height() ; ++y)
+        {
+            memcpy(m_strip.data() + (m_rows % m_rows_per_strip) * rowLength, rgba.constScanLine(y), rowLength);
+            ++m_rows;
+
+            if (m_rows % m_rows_per_strip && m_rows != m_size.height())
+                continue;
+
+            const quint32 strip = quint32((m_rows - 1) / m_rows_per_strip);
+            const int rows      = m_rows - int(strip) * m_rows_per_strip;
+
+            if (TIFFWriteEncodedStrip(m_tiff, strip, m_strip.data(), tmsize_t(rows) * rowLength) < 0)
+            {
+                setWriteError();
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool canUpdate() const override
+    {
+        return true;
+    }
+
+    /// Only files with the layout this writer produces are updated, so their strips can be copied as they are
+    bool openForUpdate(const QString& fileName, const QSize& size) override
+    {
+        cleanup();
+
+        m_source.setFileName(fileName);
+
+        if (!m_source.open(QIODevice::ReadOnly))
+        {
+            m_error = m_source.errorString();
+            return false;
+        }
+
+        m_source_tiff = TIFFClientOpen(QFile::encodeName(fileName).constData(), "r", &m_source,
+                                       tiffRead, tiffWrite, tiffSeek, tiffClose, tiffSize, tiffMap, tiffUnmap);
+
+        quint32 width        = 0;
+        quint32 height       = 0;
+        quint32 rowsPerStrip = 0;
+        quint16 samples      = 0;
+        quint16 bits         = 0;
+        quint16 compression  = 0;
+        quint16 predictor    = 0;
+        quint16 planar       = 0;
+
+        if (!m_source_tiff                                                      ||
+            !TIFFGetField(m_source_tiff, TIFFTAG_IMAGEWIDTH,      &width)        ||
+            !TIFFGetField(m_source_tiff, TIFFTAG_IMAGELENGTH,     &height)       ||
+            !TIFFGetField(m_source_tiff, TIFFTAG_ROWSPERSTRIP,    &rowsPerStrip) ||
+            !TIFFGetField(m_source_tiff, TIFFTAG_SAMPLESPERPIXEL, &samples)      ||
+            !TIFFGetField(m_source_tiff, TIFFTAG_BITSPERSAMPLE,   &bits)         ||
+            !TIFFGetField(m_source_tiff, TIFFTAG_COMPRESSION,     &compression)  ||
+            !TIFFGetField(m_source_tiff, TIFFTAG_PREDICTOR,       &predictor)    ||
+            !TIFFGetField(m_source_tiff, TIFFTAG_PLANARCONFIG,    &planar)       ||
+            width        != quint32(size.width())                               ||
+            height       != quint32(size.height())                              ||
+            rowsPerStrip == 0                                                   ||
+            samples      != 4                                                   ||
+            bits         != 8                                                   ||
+            compression  != COMPRESSION_ADOBE_DEFLATE                           ||
+            predictor    != PREDICTOR_HORIZONTAL                                ||
+            planar       != PLANARCONFIG_CONTIG)
+        {
+            m_error = QObject::tr("File can't be updated.");
+            cleanup();
+            return false;
+        }
+
+        m_size           = size;
+        m_rows           = 0;
+        m_rows_per_strip = int(qMin(rowsPerStrip, height));
+
+        QByteArray mode("w");
+        mode += (TIFFIsBigEndian(m_source_tiff) ? "b" : "l");
+
+        if (TIFFIsBigTIFF(m_source_tiff))
+            mode += '8';
+
+        if (!createEncoder(fileName, mode.constData()))
+        {
+            cleanup();
+            return false;
+        }
+
+        return true;
+    }
+
+    int updateRows() const override
+    {
+        return m_rows_per_strip;
+    }
+
+    bool replaceBand(int top, const QImage& band) override
+    {
+        if (!m_source_tiff || top % m_rows_per_strip || m_rows % m_rows_per_strip || top < m_rows)
+        {
+            m_error = QObject::tr("Invalid band size.");
+            return false;
+        }
+
+        return copySourceStrips(top) && writeBand(band);
+    }
+
+    bool close() override
+    {
+        bool result = (m_tiff != nullptr);
+
+        if (result && m_source_tiff)
+            result = copySourceStrips(m_size.height());
+
+        if (result && m_rows != m_size.height())
+        {
+            m_error = QObject::tr("Image is incomplete.");
+            result  = false;
+        }
+
+        // Directory is written by the flush
+        if (result && !TIFFFlush(m_tiff))
+        {
+            setWriteError();
+            result = false;
+        }
+
+        if (m_tiff)
+            TIFFClose(m_tiff);
+
+        m_tiff = nullptr;
+
+        // The old file is replaced only after all its strips have been copied
+        if (m_source_tiff)
+            TIFFClose(m_source_tiff);
+
+        m_source_tiff = nullptr;
+        m_source.close();
+
+        if (result && !m_file->commit())
+        {
+            m_error = m_file->errorString();
+            result  = false;
+        }
+
+        cleanup();
+
+        return result;
+    }
+
+    void cancel() override
+    {
+        cleanup();
+    }
+
+private:
+
+    bool createEncoder(const QString& fileName, const char* mode)
+    {
+        m_file.reset(new QSaveFile(fileName));
+
+        if (!m_file->open(QIODevice::WriteOnly))
+        {
+            m_error = m_file->errorString();
+            return false;
+        }
+
+        m_tiff = TIFFClientOpen(QFile::encodeName(fileName).constData(), mode, m_file.data(),
+                                tiffRead, tiffWrite, tiffSeek, tiffClose, tiffSize, tiffMap, tiffUnmap);
+
+        if (!m_tiff)
+        {
+            m_error = QObject::tr("Can't create TIFF file: %1").arg(fileName);
+            return false;
+        }
+
+        quint16 extraSamples      = EXTRASAMPLE_UNASSALPHA;
+        const QByteArray software = "Photo Layouts Editor";
+        const QByteArray dateTime = QDateTime::currentDateTime().toString(QLatin1String("yyyy:MM:dd HH:mm:ss")).toLatin1();
+
+        TIFFSetField(m_tiff, TIFFTAG_IMAGEWIDTH,      quint32(m_size.width()));
+        TIFFSetField(m_tiff, TIFFTAG_IMAGELENGTH,     quint32(m_size.height()));
+        TIFFSetField(m_tiff, TIFFTAG_BITSPERSAMPLE,   8);
+        TIFFSetField(m_tiff, TIFFTAG_SAMPLESPERPIXEL, 4);
+        TIFFSetField(m_tiff, TIFFTAG_EXTRASAMPLES,    1, &extraSamples);
+        TIFFSetField(m_tiff, TIFFTAG_PHOTOMETRIC,     PHOTOMETRIC_RGB);
+        TIFFSetField(m_tiff, TIFFTAG_PLANARCONFIG,    PLANARCONFIG_CONTIG);
+        TIFFSetField(m_tiff, TIFFTAG_COMPRESSION,     COMPRESSION_ADOBE_DEFLATE);
+        TIFFSetField(m_tiff, TIFFTAG_PREDICTOR,       PREDICTOR_HORIZONTAL);
+        TIFFSetField(m_tiff, TIFFTAG_ROWSPERSTRIP,    quint32(m_rows_per_strip));
+        TIFFSetField(m_tiff, TIFFTAG_XRESOLUTION,     m_dpi.width());
+        TIFFSetField(m_tiff, TIFFTAG_YRESOLUTION,     m_dpi.height());
+        TIFFSetField(m_tiff, TIFFTAG_RESOLUTIONUNIT,  RESUNIT_INCH);
+        TIFFSetField(m_tiff, TIFFTAG_SOFTWARE,        software.constData());
+        TIFFSetField(m_tiff, TIFFTAG_DATETIME,        dateTime.constData());
+
+        if (!m_icc_profile.isEmpty())
+            TIFFSetField(m_tiff, TIFFTAG_ICCPROFILE, quint32(m_icc_profile.size()), m_icc_profile.constData());
+
+        m_strip.resize(m_rows_per_strip * m_size.width() * 4);
+
+        return true;
+    }
+
+    /// Copies strips of the old file from the current row up to \a until
+    bool copySourceStrips(int until)
+    {
+        QByteArray data;
+
+        for ( ; m_rows < until ; m_rows = qMin(m_size.height(), m_rows + m_rows_per_strip))
+        {
+            const quint32 strip = quint32(m_rows / m_rows_per_strip);
+            const tmsize_t size = TIFFRawStripSize(m_source_tiff, strip);
+
+            if (size <= 0)
+            {
+                m_error = QObject::tr("File can't be updated.");
+                return false;
+            }
+
+            data.resize(int(size));
+
+            if (TIFFReadRawStrip(m_source_tiff, strip, data.data(), size) != size)
+            {
+                m_error = QObject::tr("File can't be updated.");
+                return false;
+            }
+
+            if (TIFFWriteRawStrip(m_tiff, strip, data.data(), size) != size)
+            {
+                setWriteError();
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void setWriteError()
+    {
+        m_error = (m_file && m_file->error() != QFileDevice::NoError) ? m_file->errorString()
+                                                                      : QObject::tr("Can't write TIFF file.");
+    }
+
+    void cleanup()
+    {
+        if (m_tiff)
+            TIFFClose(m_tiff);
+
+        if (m_source_tiff)
+            TIFFClose(m_source_tiff);
+
+        m_tiff        = nullptr;
+        m_source_tiff = nullptr;
+
+        // Not committed file is discarded
+        m_file.reset();
+        m_source.close();
+        m_strip.clear();
+    }
+
+    static tmsize_t tiffRead(thandle_t handle, void* data, tmsize_t size)
+    {
+        return tmsize_t(static_cast<QIODevice*>(handle)->read(static_cast<char*>(data), qint64(size)));
+    }
+
+    static tmsize_t tiffWrite(thandle_t handle, void* data, tmsize_t size)
+    {
+        return tmsize_t(static_cast<QIODevice*>(handle)->write(static_cast<const char*>(data), qint64(size)));
+    }
+
+    static toff_t tiffSeek(thandle_t handle, toff_t offset, int whence)
+    {
+        QIODevice* const device = static_cast<QIODevice*>(handle);
+        qint64 position         = qint64(offset);
+
+        if      (whence == SEEK_CUR)
+            position += device->pos();
+        else if (whence == SEEK_END)
+            position += device->size();
+
+        if (!device->seek(position))
+            return toff_t(-1);
+
+        return toff_t(device->pos());
+    }
+
+    /// Devices are closed by the writer
+    static int tiffClose(thandle_t /*handle*/)
+    {
+        return 0;
+    }
+
+    static toff_t tiffSize(thandle_t handle)
+    {
+        return toff_t(static_cast<QIODevice*>(handle)->size());
+    }
+
+    static int tiffMap(thandle_t /*handle*/, void** /*base*/, toff_t* /*size*/)
+    {
+        return 0;
+    }
+
+    static void tiffUnmap(thandle_t /*handle*/, void* /*base*/, toff_t /*size*/)
+    {
+    }
+
+private:
+
+    QScopedPointer<QSaveFile> m_file;
+    QFile                     m_source;
+    TIFF*                     m_tiff;
+    TIFF*                     m_source_tiff;
+    QSize                     m_size;
+    QByteArray                m_strip;
+    int                       m_rows_per_strip;
+    int                       m_rows;
+};
+
+// --------------------------------------------------------------------------------------------------------------
+
+/**
+ * PNG writer passing band rows to libpng as soon as they're received.
+ * Files written before are updated by decoding them row by row while the new
+ * file is encoded next to them, so only a single row of the old image is kept.
+ * libpng reports errors with longjmp(), so everything called under guarded()
+ * keeps only trivially destructible locals.
+ */
+class PLEPngBandedWriter : public PLEBandedWriter
+{
+    typedef void (PLEPngBandedWriter::*Step)();
+
+public:
+
+    PLEPngBandedWriter()
+        : m_png(nullptr),
+          m_info(nullptr),
+          m_source_png(nullptr),
+          m_source_info(nullptr),
+          m_rows(0),
+          m_copy_until(0)
+    {
+    }
+
+    ~PLEPngBandedWriter() override
+    {
+        cleanup();
+    }
+
+    bool isStreaming() const override
+    {
+        return true;
+    }
+
+    bool open(const QString& fileName, const QSize& size) override
+    {
+        cleanup();
+
+        if (!createEncoder(fileName))
+            return false;
+
+        m_size = size;
+        m_rows = 0;
+
+        return guarded(&PLEPngBandedWriter::writeHeader);
+    }
+
+    bool writeBand(const QImage& band) override
+    {
+        if (!m_png || band.width() != m_size.width() || m_rows + band.height() > m_size.height())
+        {
+            m_error = QObject::tr("Invalid band size.");
+            return false;
+        }
+
+        // Byte order of RGBA8888 is the order of PNG RGBA samples
+        m_band            = band.convertToFormat(QImage::Format_RGBA8888);
+        const bool result = guarded(&PLEPngBandedWriter::writeBandRows);
+        m_band            = QImage();
+
+        return result;
+    }
+
+    bool canUpdate() const override
+    {
+        return true;
+    }
+
+    bool openForUpdate(const QString& fileName, const QSize& size) override
+    {
+        cleanup();
+
+        m_source.setFileName(fileName);
+
+        if (!m_source.open(QIODevice::ReadOnly))
+        {
+            m_error = m_source.errorString();
+            return false;
+        }
+
+        m_source_png = png_create_read_struct(PNG_LIBPNG_VER_STRING, this, pngError, pngWarning);
+
+        if (m_source_png)
+            m_source_info = png_create_info_struct(m_source_png);
+
+        if (!m_source_info || !createEncoder(fileName))
+        {
+            if (m_error.isEmpty())
+                m_error = QObject::tr("Not enough memory to export the image.");
+
+            cleanup();
+            return false;
+        }
+
+        png_set_read_fn(m_source_png, &m_source, pngRead);
+
+        m_size = size;
+        m_rows = 0;
+        m_row.resize(size.width() * 4);
+
+        if (!guarded(&PLEPngBandedWriter::readHeader) || !guarded(&PLEPngBandedWriter::writeHeader))
+        {
+            cleanup();
+            return false;
+        }
+
+        return true;
+    }
+
+    bool replaceBand(int top, const QImage& band) override
+    {
+        if (!m_source_png || band.width() != m_size.width() || top < m_rows || top + band.height() > m_size.height())
+        {
+            m_error = QObject::tr("Invalid band size.");
+            return false;
+        }
+
+        m_copy_until = top;
+
+        if (!guarded(&PLEPngBandedWriter::copySourceRows))
+            return false;
+
+        return writeBand(band);
+    }
+
+    bool close() override
+    {
+        bool result = (m_png != nullptr);
+
+        if (result && m_source_png)
+        {
+            m_copy_until = m_size.height();
+            result       = guarded(&PLEPngBandedWriter::copySourceRows);
+        }
+
+        if (result && m_rows != m_size.height())
+        {
+            m_error = QObject::tr("Image is incomplete.");
+            result  = false;
+        }
+
+        result = result && guarded(&PLEPngBandedWriter::writeEnd);
+
+        // The old file is replaced only after it has been read completely
+        m_source.close();
+
+        if (result && !m_file->commit())
+        {
+            m_error = m_file->errorString();
+            result  = false;
+        }
+
+        cleanup();
+
+        return result;
+    }
+
+    void cancel() override
+    {
+        cleanup();
+    }
+
+private:
+
+    bool createEncoder(const QString& fileName)
+    {
+        m_file.reset(new QSaveFile(fileName));
+
+        if (!m_file->open(QIODevice::WriteOnly))
+        {
+            m_error = m_file->errorString();
+            return false;
+        }
+
+        m_png = png_create_write_struct(PNG_LIBPNG_VER_STRING, this, pngError, pngWarning);
+
+        if (m_png)
+            m_info = png_create_info_struct(m_png);
+
+        if (!m_info)
+        {
+            m_error = QObject::tr("Not enough memory to export the image.");
+            return false;
+        }
+
+        png_set_write_fn(m_png, m_file.data(), pngWrite, pngFlush);
+
+        return true;
+    }
+
+    /// Runs libpng calls of \a step, returns false if any of them failed
+    bool guarded(Step step)
+    {
+        if (setjmp(png_jmpbuf(m_png)))
+            return false;
+
+        if (m_source_png && setjmp(png_jmpbuf(m_source_png)))
+            return false;
+
+        (this->*step)();
+
+        return true;
+    }
+
+    void writeHeader()
+    {
+        png_set_IHDR(m_png, m_info, png_uint_32(m_size.width()), png_uint_32(m_size.height()), 8,
+                     PNG_COLOR_TYPE_RGB_ALPHA, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+        png_set_pHYs(m_png, m_info, png_uint_32(qRound(m_dpi.width()  / 0.0254)),
+                                    png_uint_32(qRound(m_dpi.height() / 0.0254)), PNG_RESOLUTION_METER);
+
+        if (!m_icc_profile.isEmpty())
+        {
+            png_set_iCCP(m_png, m_info, "ICC Profile", PNG_COMPRESSION_TYPE_BASE,
+                         reinterpret_cast<png_const_bytep>(m_icc_profile.constData()), png_uint_32(m_icc_profile.size()));
+        }
+
+        png_write_info(m_png, m_info);
+    }
+
+    /// Old file is read as non interlaced 8 bits RGBA rows, whatever it was written with
+    void readHeader()
+    {
+        png_read_info(m_source_png, m_source_info);
+
+        if (int(png_get_image_width(m_source_png, m_source_info))  != m_size.width() ||
+            int(png_get_image_height(m_source_png, m_source_info)) != m_size.height())
+        {
+            png_error(m_source_png, "Image size differs");
+        }
+
+        if (png_get_interlace_type(m_source_png, m_source_info) != PNG_INTERLACE_NONE)
+            png_error(m_source_png, "Interlaced images can't be read row by row");
+
+        png_set_expand(m_source_png);
+        png_set_strip_16(m_source_png);
+        png_set_gray_to_rgb(m_source_png);
+        png_set_add_alpha(m_source_png, 0xFF, PNG_FILLER_AFTER);
+        png_read_update_info(m_source_png, m_source_info);
+
+        if (int(png_get_rowbytes(m_source_png, m_source_info)) != m_row.size())
+            png_error(m_source_png, "Unsupported pixel format");
+    }
+
+    /// Rows of the band replace the same rows of the old file, if there is one
+    void writeBandRows()
+    {
+        for (int y = 0 ; y < m_band.height() ; ++y, ++m_rows)
+        {
+            if (m_source_png)
+                png_read_row(m_source_png, reinterpret_cast<png_bytep>(m_row.data()), nullptr);
+
+            png_write_row(m_png, m_band.constScanLine(y));
+        }
+    }
+
+    void copySourceRows()
+    {
+        for ( ; m_rows < m_copy_until ; ++m_rows)
+        {
+            png_read_row(m_source_png, reinterpret_cast<png_bytep>(m_row.data()), nullptr);
+            png_write_row(m_png, reinterpret_cast<png_const_bytep>(m_row.constData()));
+        }
+    }
+
+    void writeEnd()
+    {
+        png_write_end(m_png, m_info);
+
+        if (m_source_png)
+            png_read_end(m_source_png, nullptr);
+    }
+
+    void cleanup()
+    {
+        if (m_png)
+            png_destroy_write_struct(&m_png, m_info ? &m_info : nullptr);
+
+        if (m_source_png)
+            png_destroy_read_struct(&m_source_png, m_source_info ? &m_source_info : nullptr, nullptr);
+
+        m_png         = nullptr;
+        m_info        = nullptr;
+        m_source_png  = nullptr;
+        m_source_info = nullptr;
+
+        // Not committed file is discarded
+        m_file.reset();
+        m_source.close();
+        m_row.clear();
+    }
+
+    static void pngError(png_structp png, png_const_charp message)
+    {
+        static_cast<PLEPngBandedWriter*>(png_get_error_ptr(png))->m_error = QString::fromLatin1(message);
+        png_longjmp(png, 1);
+    }
+
+    static void pngWarning(png_structp /*png*/, png_const_charp message)
+    {
+        qDebug() << "PNG warning:" << message;
+    }
+
+    static void pngWrite(png_structp png, png_bytep data, png_size_t length)
+    {
+        QIODevice* const device = static_cast<QIODevice*>(png_get_io_ptr(png));
+
+        if (device->write(reinterpret_cast<const char*>(data), qint64(length)) != qint64(length))
+            png_error(png, "Can't write the file");
+    }
+
+    static void pngFlush(png_structp /*png*/)
+    {
+    }
+
+    static void pngRead(png_structp png, png_bytep data, png_size_t length)
+    {
+        QIODevice* const device = static_cast<QIODevice*>(png_get_io_ptr(png));
+
+        if (device->read(reinterpret_cast<char*>(data), qint64(length)) != qint64(length))
+            png_error(png, "Can't read the file");
+    }
+
+private:
+
+    QScopedPointer<QSaveFile> m_file;
+    QFile                     m_source;
+    png_structp               m_png;
+    png_infop                 m_info;
+    png_structp               m_source_png;
+    png_infop                 m_source_info;
+    QSize                     m_size;
+    QImage                    m_band;
+    QByteArray                m_row;
+    int                       m_rows;
+    int                       m_copy_until;
+};
+
+// --------------------------------------------------------------------------------------------------------------
+
+/**
+ * Baseline JPEG writer passing band rows to libjpeg as scanlines.
+ * libjpeg reports errors with longjmp(), so everything called under guarded()
+ * keeps only trivially destructible locals.
+ */
+class PLEJpegBandedWriter : public PLEBandedWriter
+{
+    typedef void (PLEJpegBandedWriter::*Step)();
+
+    struct ErrorManager
+    {
+        jpeg_error_mgr       manager;
+        jmp_buf              jump;
+        PLEJpegBandedWriter* writer;
+    };
+
+    struct Destination
+    {
+        jpeg_destination_mgr manager;
+        QIODevice*           device;
+        JOCTET               buffer[JPEG_BUFFER_SIZE];
+    };
+
+public:
+
+    PLEJpegBandedWriter()
+        : m_created(false),
+          m_rows(0)
+    {
+        m_cinfo.err                        = jpeg_std_error(&m_error_manager.manager);
+        m_error_manager.manager.error_exit = jpegErrorExit;
+        m_error_manager.writer             = this;
+
+        m_destination.manager.init_destination    = jpegInitDestination;
+        m_destination.manager.empty_output_buffer = jpegEmptyOutputBuffer;
+        m_destination.manager.term_destination    = jpegTermDestination;
+        m_destination.device                      = nullptr;
+    }
+
+    ~PLEJpegBandedWriter() override
+    {
+        cleanup();
+    }
+
+    bool isStreaming() const override
+    {
+        return true;
+    }
+
+    bool open(const QString& fileName, const QSize& size) override
+    {
+        cleanup();
+
+        m_file.reset(new QSaveFile(fileName));
+
+        if (!m_file->open(QIODevice::WriteOnly))
+        {
+            m_error = m_file->errorString();
+            return false;
+        }
+
+        m_size               = size;
+        m_rows               = 0;
+        m_destination.device = m_file.data();
+        m_icc_markers.clear();
+
+        // Profile is split into 64 KB APP2 markers, prepared here as they're written under guarded()
+        const int maximum = 65533 - 16;
+        const int count   = (m_icc_profile.size() + maximum - 1) / maximum;
+
+        for (int i = 0 ; i < count ; ++i)
+        {
+            QByteArray marker("ICC_PROFILE", 12);
+            marker.append(char(i + 1));
+            marker.append(char(count));
+            marker.append(m_icc_profile.mid(i * maximum, maximum));
+            m_icc_markers.append(marker);
+        }
+
+        if (!guarded(&PLEJpegBandedWriter::startCompress))
+        {
+            cleanup();
+            return false;
+        }
+
+        return true;
+    }
+
+    bool writeBand(const QImage& band) override
+    {
+        if (!m_created || band.width() != m_size.width() || m_rows + band.height() > m_size.height())
+        {
+            m_error = QObject::tr("Invalid band size.");
+            return false;
+        }
+
+        // Alpha is dropped like QImageWriter does, transparent areas become black
+        m_band            = band.convertToFormat(QImage::Format_RGB888);
+        const bool result = guarded(&PLEJpegBandedWriter::writeScanlines);
+        m_band            = QImage();
+
+        return result;
+    }
+
+    bool close() override
+    {
+        bool result = m_created;
+
+        if (result && m_rows != m_size.height())
+        {
+            m_error = QObject::tr("Image is incomplete.");
+            result  = false;
+        }
+
+        result = result && guarded(&PLEJpegBandedWriter::finishCompress);
+
+        if (result && !m_file->commit())
+        {
+            m_error = m_file->errorString();
+            result  = false;
+        }
+
+        cleanup();
+
+        return result;
+    }
+
+    void cancel() override
+    {
+        cleanup();
+    }
+
+private:
+
+    /// Runs libjpeg calls of \a step, returns false if any of them failed
+    bool guarded(Step step)
+    {
+        if (setjmp(m_error_manager.jump))
+            return false;
+
+        (this->*step)();
+
+        return true;
+    }
+
+    void startCompress()
+    {
+        jpeg_create_compress(&m_cinfo);
+        m_created = true;
+
+        m_cinfo.dest             = &m_destination.manager;
+        m_cinfo.image_width      = JDIMENSION(m_size.width());
+        m_cinfo.image_height     = JDIMENSION(m_size.height());
+        m_cinfo.input_components = 3;
+        m_cinfo.in_color_space   = JCS_RGB;
+
+        jpeg_set_defaults(&m_cinfo);
+        jpeg_set_quality(&m_cinfo, JPEG_QUALITY, TRUE);
+
+        m_cinfo.write_JFIF_header = TRUE;
+        m_cinfo.density_unit      = 1;                 // Dots per inch
+        m_cinfo.X_density         = UINT16(qRound(m_dpi.width()));
+        m_cinfo.Y_density         = UINT16(qRound(m_dpi.height()));
+
+        jpeg_start_compress(&m_cinfo, TRUE);
+
+        for (int i = 0 ; i < m_icc_markers.size() ; ++i)
+        {
+            jpeg_write_marker(&m_cinfo, JPEG_APP0 + 2,
+                              reinterpret_cast<const JOCTET*>(m_icc_markers.at(i).constData()),
+                              static_cast<unsigned int>(m_icc_markers.at(i).size()));
+        }
+    }
+
+    void writeScanlines()
+    {
+        for (int y = 0 ; y < m_band.height() ; ++y, ++m_rows)
+        {
+            JSAMPROW row = const_cast<JSAMPROW>(m_band.constScanLine(y));
+            jpeg_write_scanlines(&m_cinfo, &row, 1);
+        }
+    }
+
+    void finishCompress()
+    {
+        jpeg_finish_compress(&m_cinfo);
+    }
+
+    void cleanup()
+    {
+        if (m_created)
+            jpeg_destroy_compress(&m_cinfo);
+
+        m_created            = false;
+        m_destination.device = nullptr;
+
+        // Not committed file is discarded
+        m_file.reset();
+    }
+
+    static void jpegErrorExit(j_common_ptr cinfo)
+    {
+        ErrorManager* const manager = reinterpret_cast<ErrorManager*>(cinfo->err);
+        char message[JMSG_LENGTH_MAX];
+        (*cinfo->err->format_message)(cinfo, message);
+        manager->writer->m_error = QString::fromLocal8Bit(message);
+        longjmp(manager->jump, 1);
+    }
+
+    static void jpegInitDestination(j_compress_ptr cinfo)
+    {
+        Destination* const destination        = reinterpret_cast<Destination*>(cinfo->dest);
+        destination->manager.next_output_byte = destination->buffer;
+        destination->manager.free_in_buffer   = JPEG_BUFFER_SIZE;
+    }
+
+    static boolean jpegEmptyOutputBuffer(j_compress_ptr cinfo)
+    {
+        Destination* const destination = reinterpret_cast<Destination*>(cinfo->dest);
+
+        // Whole buffer is written, free_in_buffer isn't valid here
+        if (destination->device->write(reinterpret_cast<const char*>(destination->buffer), JPEG_BUFFER_SIZE) != JPEG_BUFFER_SIZE)
+            ERREXIT(cinfo, JERR_FILE_WRITE);
+
+        jpegInitDestination(cinfo);
+
+        return TRUE;
+    }
+
+    static void jpegTermDestination(j_compress_ptr cinfo)
+    {
+        Destination* const destination = reinterpret_cast<Destination*>(cinfo->dest);
+        const qint64 size              = qint64(JPEG_BUFFER_SIZE - destination->manager.free_in_buffer);
+
+        if (destination->device->write(reinterpret_cast<const char*>(destination->buffer), size) != size)
+            ERREXIT(cinfo, JERR_FILE_WRITE);
+    }
+
+private:
+
+    QScopedPointer<QSaveFile> m_file;
+    jpeg_compress_struct      m_cinfo;
+    ErrorManager              m_error_manager;
+    Destination               m_destination;
+    QList<QByteArray>         m_icc_markers;
+    QSize                     m_size;
+    QImage                    m_band;
+    bool                      m_created;
+    int                       m_rows;
+};
+
+// --------------------------------------------------------------------------------------------------------------
+
+/**
+ * Writer for formats handled by QImageWriter.
+ * Bands are copied into the single image which is encoded on close().
+ */
+class PLEImageBandedWriter : public PLEBandedWriter
+{
+public:
+
+    explicit PLEImageBandedWriter(const QByteArray& format)
+        : m_format(format),
+          m_rows(0)
+    {
+    }
+
+    bool isStreaming() const override
+    {
+        return false;
+    }
+
+    bool open(const QString& fileName, const QSize& size) override
+    {
+        m_file_name = fileName;
+        m_rows      = 0;
+        m_image     = QImage(size, QImage::Format_ARGB32_Premultiplied);
+
+        if (m_image.isNull())
+        {
+            m_error = QObject::tr("Not enough memory to export the image.");
+            return false;
+        }
+
+        return true;
+    }
+
+    bool writeBand(const QImage& band) override
+    {
+        if (band.width() != m_image.width() || m_rows + band.height() > m_image.height())
+        {
+            m_error = QObject::tr("Invalid band size.");
+            return false;
+        }
+
+        const QImage converted = band.convertToFormat(m_image.format());
+
+        for (int y = 0 ; y < converted.height() ; ++y, ++m_rows)
+            memcpy(m_image.scanLine(m_rows), converted.constScanLine(y), converted.width() * 4);
+
+        return true;
+    }
+
+    /// Only lossless formats are updated, other ones would lose quality with every update
+    bool canUpdate() const override
+    {
+        return (m_format == "bmp" || m_format == "ppm");
+    }
+
+    bool openForUpdate(const QString& fileName, const QSize& size) override
+    {
+        QImageReader reader(fileName, m_format);
+
+        if (!canUpdate() || reader.size() != size || !open(fileName, size))
+        {
+            m_error = QObject::tr("File can't be updated.");
+            return false;
+        }
+
+        // Pixels are copied, so the encoded image doesn't get attributes of the read one
+        const QImage image = reader.read().convertToFormat(m_image.format());
+
+        if (image.size() != size)
+        {
+            m_error = reader.errorString();
+            m_image = QImage();
+            return false;
+        }
+
+        for (int y = 0 ; y < image.height() ; ++y)
+            memcpy(m_image.scanLine(y), image.constScanLine(y), image.width() * 4);
+
+        m_rows = size.height();
+
+        return true;
+    }
+
+    bool replaceBand(int top, const QImage& band) override
+    {
+        if (band.width() != m_image.width() || top < 0 || top + band.height() > m_image.height())
+        {
+            m_error = QObject::tr("Invalid band size.");
+            return false;
+        }
+
+        const QImage converted = band.convertToFormat(m_image.format());
+
+        for (int y = 0 ; y < converted.height() ; ++y)
+            memcpy(m_image.scanLine(top + y), converted.constScanLine(y), converted.width() * 4);
+
+        return true;
+    }
+
+    bool close() override
+    {
+        m_image.setDotsPerMeterX(qRound(m_dpi.width()  / 0.0254));
+        m_image.setDotsPerMeterY(qRound(m_dpi.height() / 0.0254));
+
+        if (!m_icc_profile.isEmpty())
+            qDebug() << "ICC profile can't be embedded into" << m_format << "files";
+
+        // Old file is replaced only when the new one is complete
+        QSaveFile file(m_file_name);
+        QImageWriter writer(&file, m_format);
+        bool result = false;
+
+        if      (!file.open(QIODevice::WriteOnly))
+            m_error = file.errorString();
+        else if (!writer.write(m_image))
+            m_error = writer.errorString();
+        else if (!(result = file.commit()))
+            m_error = file.errorString();
+
+        m_image = QImage();
+
+        return result;
+    }
+
+    /// Nothing is written before close()
+    void cancel() override
+    {
+        m_image = QImage();
+    }
+
+private:
+
+    QByteArray m_format;
+    QString    m_file_name;
+    QImage     m_image;
+    int        m_rows;
+};
+
+// --------------------------------------------------------------------------------------------------------------
+
+PLEBandedWriter* PLEBandedWriter::create(const QByteArray& format)
+{
+    const QByteArray f = format.toLower();
+
+    if (f == "tif" || f == "tiff")
+        return new PLETiffBandedWriter;
+
+    if (f == "png")
+        return new PLEPngBandedWriter;
+
+    if (f == "jpg" || f == "jpeg")
+        return new PLEJpegBandedWriter;
+
+    if (QImageWriter::supportedImageFormats().contains(f))
+        return new PLEImageBandedWriter(f);
+
+    return nullptr;
+}
+
+} // namespace PhotoLayoutsEditor
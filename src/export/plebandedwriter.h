@@ -0,0 +1,118 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef PLE_BANDED_WRITER_H
+#define PLE_BANDED_WRITER_H
+
+// Qt includes
+
+#include <QImage>
+#include <QObject>
+#include <QString>
+#include <QSize>
+
+namespace PhotoLayoutsEditor
+{
+
+/** Image encoder fed with horizontal bands of rows, from top to bottom.
+ * Writers which can't stream rows to the file keep only the image being assembled.
+ * Files are replaced only when close() succeeds, so a failed or cancelled export keeps the old file.
+ */
+class PLEBandedWriter
+{
+public:
+
+    virtual ~PLEBandedWriter() = default;
+
+    /// Returns writer for given format (file suffix), or nullptr if the format isn't supported
+    static PLEBandedWriter* create(const QByteArray& format);
+
+    /// Returns true if the writer streams bands to the file keeping memory usage independent of image height
+    virtual bool isStreaming() const = 0;
+
+    virtual bool open(const QString& fileName, const QSize& size) = 0;
+    virtual bool writeBand(const QImage& band) = 0;
+    virtual bool close() = 0;
+
+    /// Drops the file being written or updated, file which existed before is left as it was
+    virtual void cancel() = 0;
+
+    /// Returns true if bands of a file written before can be replaced without writing the whole image again
+    virtual bool canUpdate() const
+    {
+        return false;
+    }
+
+    /** Opens file written before by the writer with the same size and settings, replaceBand() overwrites
+     * its rows and close() finishes the update. Returns false if the file can't be updated.
+     */
+    virtual bool openForUpdate(const QString& /*fileName*/, const QSize& /*size*/)
+    {
+        m_error = QObject::tr("File can't be updated.");
+        return false;
+    }
+
+    /// Replaced bands have to start at multiple of this number of rows and cover whole multiples of it
+    virtual int updateRows() const
+    {
+        return 1;
+    }
+
+    virtual bool replaceBand(int /*top*/, const QImage& /*band*/)
+    {
+        return false;
+    }
+
+    /// Resolution written into file, in dots per inch
+    void setResolution(const QSizeF& dpi)
+    {
+        m_dpi = dpi;
+    }
+
+    /// ICC profile embedded into file, the bands have to be in its color space
+    void setIccProfile(const QByteArray& profile)
+    {
+        m_icc_profile = profile;
+    }
+
+    QString errorString() const
+    {
+        return m_error;
+    }
+
+protected:
+
+    PLEBandedWriter()
+        : m_dpi(72, 72)
+    {
+    }
+
+    QSizeF     m_dpi;
+    QByteArray m_icc_profile;
+    QString    m_error;
+};
+
+} // namespace PhotoLayoutsEditor
+
+#endif // PLE_BANDED_WRITER_H
@@ -0,0 +1,309 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "plebatchrenderer.h"
+
+// Qt includes
+
+#include <QDir>
+#include <QDomDocument>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSharedPointer>
+#include <QThread>
+#include <QDebug>
+
+// Local includes
+
+#include "plecanvas.h"
+#include "plecanvassize.h"
+#include "plescene.h"
+#include "plescenesnapshot.h"
+#include "pleexportjob.h"
+#include "plepdfexporter.h"
+#include "pletemplatefiller.h"
+#include "photoeffectsloader.h"
+#include "standardeffectsfactory.h"
+#include "borderdrawersloader.h"
+#include "standardbordersfactory.h"
+
+namespace PhotoLayoutsEditor
+{
+
+PLEBatchRenderer::PLEBatchRenderer(QObject* parent)
+    : QObject(parent),
+      m_max_jobs(qMax(1, QThread::idealThreadCount())),
+      m_default_dpi(0),
+      m_intent(PLEColorTransform::Perceptual),
+      m_loop(nullptr),
+      m_starting(false)
+{
+}
+
+PLEBatchRenderer::~PLEBatchRenderer()
+{
+    // Job's destructor waits until it's finished
+    foreach (PLEExportJob* const job, m_running)
+    {
+        job->cancel();
+        delete job;
+    }
+}
+
+void PLEBatchRenderer::setMaxJobs(int jobs)
+{
+    m_max_jobs = qMax(1, jobs);
+}
+
+int PLEBatchRenderer::maxJobs() const
+{
+    return m_max_jobs;
+}
+
+void PLEBatchRenderer::setDefaultDpi(qreal dpi)
+{
+    m_default_dpi = dpi;
+}
+
+void PLEBatchRenderer::setColorProfile(const PLEIccProfile& profile, PLEColorTransform::RenderingIntent intent)
+{
+    m_profile = profile;
+    m_intent  = intent;
+}
+
+void PLEBatchRenderer::addDocument(const Document& document)
+{
+    m_documents.enqueue(document);
+}
+
+bool PLEBatchRenderer::loadManifest(const QString& fileName)
+{
+    QFile file(fileName);
+
+    if (!file.open(QFile::ReadOnly))
+    {
+        m_errors << QObject::tr("Can't open manifest: %1").arg(fileName);
+        return false;
+    }
+
+    QJsonParseError error;
+    const QJsonDocument json = QJsonDocument::fromJson(file.readAll(), &error);
+
+    if (!json.isObject())
+    {
+        m_errors << QObject::tr("Invalid manifest %1: %2").arg(fileName, error.errorString());
+        return false;
+    }
+
+    const QDir dir             = QFileInfo(fileName).absoluteDir();
+    const QJsonObject root     = json.object();
+    const qreal dpi            = root.value(QLatin1String("dpi")).toDouble(m_default_dpi);
+    const QJsonArray documents = root.value(QLatin1String("documents")).toArray();
+
+    foreach (const QJsonValue& value, documents)
+    {
+        const QJsonObject object = value.toObject();
+        Document document;
+        document.templateFile    = dir.absoluteFilePath(object.value(QLatin1String("template")).toString());
+        document.output          = dir.absoluteFilePath(object.value(QLatin1String("output")).toString());
+        document.dpi             = object.value(QLatin1String("dpi")).toDouble(dpi);
+
+        foreach (const QJsonValue& image, object.value(QLatin1String("images")).toArray())
+            document.images << dir.absoluteFilePath(image.toString());
+
+        addDocument(document);
+    }
+
+    return true;
+}
+
+bool PLEBatchRenderer::run()
+{
+    QEventLoop loop;
+    m_loop = &loop;
+
+    startNext();
+
+    if (!m_running.isEmpty())
+        loop.exec();
+
+    m_loop = nullptr;
+
+    return m_errors.isEmpty();
+}
+
+QStringList PLEBatchRenderer::errors() const
+{
+    return m_errors;
+}
+
+void PLEBatchRenderer::registerStandardPlugins()
+{
+    StandardEffectsFactory* const stdEffects = new StandardEffectsFactory(PhotoEffectsLoader::instance());
+    PhotoEffectsLoader::registerEffect(stdEffects);
+    PhotoEffectsLoader::loadPlugins();
+
+    StandardBordersFactory* const stdBorders = new StandardBordersFactory(BorderDrawersLoader::instance());
+    BorderDrawersLoader::registerDrawer(stdBorders);
+}
+
+void PLEBatchRenderer::jobFinished()
+{
+    PLEExportJob* const job = qobject_cast<PLEExportJob*>(sender());
+
+    if (!job || !m_running.removeOne(job))
+        return;
+
+    m_errors << job->errors();
+
+    foreach (const QString& output, job->outputs())
+        Q_EMIT documentFinished(output, job->writtenOutputs().contains(output));
+
+    job->deleteLater();
+    startNext();
+}
+
+void PLEBatchRenderer::startNext()
+{
+    // Loading of a document runs an event loop, which delivers finished jobs
+    if (m_starting)
+        return;
+
+    m_starting = true;
+
+    while (m_running.count() < m_max_jobs && !m_documents.isEmpty())
+    {
+        const Document document = m_documents.dequeue();
+        PLEExportJob* const job = createJob(document);
+
+        if (!job)
+        {
+            Q_EMIT documentFinished(document.output, false);
+            continue;
+        }
+
+        m_running << job;
+        connect(job, SIGNAL(finished()), this, SLOT(jobFinished()));
+        job->start(QThread::LowPriority);
+    }
+
+    m_starting = false;
+
+    if (m_running.isEmpty() && m_loop)
+        m_loop->quit();
+}
+
+PLEExportJob* PLEBatchRenderer::createJob(const Document& document)
+{
+    const QString suffix = QFileInfo(document.output).suffix().toLower();
+
+    if (document.output.isEmpty() || suffix.isEmpty())
+    {
+        m_errors << QObject::tr("%1: output file isn't set").arg(document.templateFile);
+        return nullptr;
+    }
+
+    PLECanvas* const canvas = loadCanvas(document.templateFile);
+
+    if (!canvas)
+    {
+        m_errors << QObject::tr("%1: can't load layout").arg(document.templateFile);
+        return nullptr;
+    }
+
+    // Output has physical size of the canvas at the requested resolution
+    const PLECanvasSize size = canvas->canvasSize();
+    const qreal canvasDpi    = size.resolution(PLECanvasSize::PixelsPerInch).width();
+    const qreal dpi          = (document.dpi > 0 ? document.dpi : (m_default_dpi > 0 ? m_default_dpi : canvasDpi));
+    const QSize outputSize   = (size.size(PLECanvasSize::Inches) * dpi).toSize();
+    PLEScene* const scene    = canvas->scene();
+    const qreal resolution   = outputSize.width() / scene->sceneRect().width();
+
+    // Photos are decoded at the output resolution of their slots
+    fillPhotos(canvas, document.images, resolution);
+
+    PLEExportJob* const job  = new PLEExportJob(PLESceneSnapshot::capture(scene, resolution), this);
+    job->setOutputSize(outputSize);
+    job->setResolution(QSizeF(dpi, dpi));
+    job->setColorProfile(m_profile, m_intent);
+    job->addOutput(QFileInfo(document.output).absoluteFilePath(), suffix.toLatin1());
+
+    if (suffix == QLatin1String("pdf"))
+        job->setPdfExporter(QSharedPointer<PLEPdfExporter>(new PLEPdfExporter(scene, size.size(PLECanvasSize::Points))));
+
+    // Job has its own copy of the content
+    delete canvas;
+
+    return job;
+}
+
+PLECanvas* PLEBatchRenderer::loadCanvas(const QString& fileName)
+{
+    QFile file(fileName);
+
+    if (!file.open(QFile::ReadOnly))
+        return nullptr;
+
+    QDomDocument document;
+
+    if (!document.setContent(&file, true))
+        return nullptr;
+
+    PLECanvas* const canvas = PLECanvas::fromSvg(document);
+
+    if (!canvas)
+        return nullptr;
+
+    PLEScene* const scene = canvas->scene();
+
+    if (scene->isLoading())
+    {
+        QEventLoop loop;
+        connect(scene, SIGNAL(loadingFinished()), &loop, SLOT(quit()));
+        loop.exec();
+    }
+
+    return canvas;
+}
+
+void PLEBatchRenderer::fillPhotos(PLECanvas* canvas, const QStringList& images, qreal resolution)
+{
+    if (images.isEmpty())
+        return;
+
+    PLETemplateFiller filler(canvas->scene());
+    const int count = filler.emptyPhotos().count();
+
+    if (images.count() > count)
+        qDebug() << "Layout has" << count << "empty photos," << images.count() - count << "images won't be used";
+
+    filler.fill(images, resolution);
+    m_errors << filler.errors();
+}
+
+} // namespace PhotoLayoutsEditor
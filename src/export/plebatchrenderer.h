@@ -0,0 +1,135 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef PLE_BATCH_RENDERER_H
+#define PLE_BATCH_RENDERER_H
+
+// Qt includes
+
+#include <QObject>
+#include <QQueue>
+#include <QStringList>
+#include <QByteArray>
+
+// Local includes
+
+#include "plecolortransform.h"
+
+class QEventLoop;
+
+namespace PhotoLayoutsEditor
+{
+
+class PLECanvas;
+class PLEExportJob;
+
+/** Renders layout documents to image or PDF files without the editor window.
+ * Documents are loaded and filled with photos one by one on the calling (GUI) thread,
+ * captured scenes are written by export jobs running in parallel.
+ */
+class PLEBatchRenderer : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    struct Document
+    {
+        Document()
+            : dpi(0)
+        {
+        }
+
+        QString     templateFile;   ///< Layout or template file
+        QStringList images;         ///< Photos filling empty photo items, matched to them by aspect ratio
+        QString     output;         ///< Output file, format is given by its suffix
+        qreal       dpi;            ///< Output resolution, resolution of the document when not set
+    };
+
+public:
+
+    explicit PLEBatchRenderer(QObject* parent = nullptr);
+    ~PLEBatchRenderer() override;
+
+    /// Number of documents written at the same time, number of CPU cores by default
+    void setMaxJobs(int jobs);
+    int maxJobs() const;
+
+    /// Default resolution of documents which don't set their own
+    void setDefaultDpi(qreal dpi);
+
+    /// Color profile of the outputs, sRGB when not set
+    void setColorProfile(const PLEIccProfile& profile,
+                         PLEColorTransform::RenderingIntent intent = PLEColorTransform::Perceptual);
+
+    void addDocument(const Document& document);
+
+    /** Reads documents from JSON manifest:
+     * { "dpi": 300, "documents": [ { "template": "a.ple", "images": [ "1.jpg", "2.jpg" ], "output": "a.png", "dpi": 150 } ] }
+     * Relative paths are resolved against the manifest directory.
+     */
+    bool loadManifest(const QString& fileName);
+
+    /// Renders all added documents, returns when they are written
+    bool run();
+
+    QStringList errors() const;
+
+    /// Registers effects and borders the editor window registers on its creation
+    static void registerStandardPlugins();
+
+Q_SIGNALS:
+
+    void documentFinished(const QString& output, bool succeeded);
+
+private Q_SLOTS:
+
+    void jobFinished();
+
+private:
+
+    void startNext();
+    PLEExportJob* createJob(const Document& document);
+    PLECanvas* loadCanvas(const QString& fileName);
+    void fillPhotos(PLECanvas* canvas, const QStringList& images, qreal resolution);
+
+private:
+
+    QQueue<Document>                   m_documents;
+    QList<PLEExportJob*>               m_running;
+    int                                m_max_jobs;
+    qreal                              m_default_dpi;
+    PLEIccProfile                      m_profile;
+    PLEColorTransform::RenderingIntent m_intent;
+    QStringList                        m_errors;
+    QEventLoop*                        m_loop;
+    bool                               m_starting;
+
+    PLEBatchRenderer(const PLEBatchRenderer&) = delete;
+    PLEBatchRenderer& operator=(const PLEBatchRenderer&) = delete;
+};
+
+} // namespace PhotoLayoutsEditor
+
+#endif // PLE_BATCH_RENDERER_H
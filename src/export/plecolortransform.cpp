@@ -0,0 +1,150 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+
+#include "plecolortransform.h"
+
+// Qt includes
+
+#include <QThread>
+#include <QVector>
+#include <QtConcurrent>
+#include <QDebug>
+
+// digiKam includes
+
+#include "icctransform.h"
+
+namespace PhotoLayoutsEditor
+{
+
+class PLEColorTransform::Private
+{
+public:
+
+    Private(const PLEIccProfile& source, const PLEIccProfile& destination, RenderingIntent intent)
+    {
+        transform.setInputProfile(source.iccProfile());
+        transform.setOutputProfile(destination.iccProfile());
+        transform.setIntent(Digikam::IccTransform::RenderingIntent(intent));
+        transform.setUseBlackPointCompensation(intent != AbsoluteColorimetric);
+    }
+
+public:
+
+    struct Tile
+    {
+        uchar*         bits;
+        int            rows;
+        int            width;
+        int            bytesPerLine;
+        QImage::Format format;
+        const Private* transform;
+    };
+
+    static void convertTile(Tile& tile)
+    {
+        // Copy opens its own lcms2 transform, so the tiles don't share one handle
+        Digikam::IccTransform transform = tile.transform->transform;
+        QImage rows(tile.bits, tile.width, tile.rows, tile.bytesPerLine, tile.format);
+
+        if (!transform.apply(rows))
+            qDebug() << "Color transform failed";
+    }
+
+public:
+
+    Digikam::IccTransform transform;
+};
+
+// --------------------------------------------------------------------------------------------------------------
+
+PLEColorTransform::PLEColorTransform()
+{
+}
+
+PLEColorTransform PLEColorTransform::transform(const PLEIccProfile& source,
+                                               const PLEIccProfile& destination,
+                                               RenderingIntent intent)
+{
+    PLEColorTransform result;
+
+    if (source.isNull() || destination.isNull())
+        return result;
+
+    if (source.hash() == destination.hash() && intent != AbsoluteColorimetric)
+        return result;
+
+    if (source.components() != 3 || destination.components() != 3)
+    {
+        qDebug() << "Color transform needs RGB profiles:" << source.description() << destination.description();
+        return result;
+    }
+
+    result.d = QSharedPointer<const Private>(new Private(source, destination, intent));
+
+    return result;
+}
+
+bool PLEColorTransform::isIdentity() const
+{
+    return !d;
+}
+
+void PLEColorTransform::apply(QImage& image) const
+{
+    if (!d || image.isNull())
+        return;
+
+    const bool premultiplied = (image.format() != QImage::Format_ARGB32 &&
+                                image.format() != QImage::Format_RGB32);
+
+    if (premultiplied)
+        image = image.convertToFormat(QImage::Format_ARGB32);
+
+    // Rows are addressed directly so that tiles don't detach the image from worker threads,
+    // one tile per thread as each of them opens a transform
+    const int tileRows = qMax(32, (image.height() + QThread::idealThreadCount() - 1) / qMax(1, QThread::idealThreadCount()));
+    uchar* const bits  = image.bits();
+    QVector<Private::Tile> tiles;
+
+    for (int y = 0 ; y < image.height() ; y += tileRows)
+    {
+        Private::Tile tile;
+        tile.bits         = bits + y * image.bytesPerLine();
+        tile.rows         = qMin(tileRows, image.height() - y);
+        tile.width        = image.width();
+        tile.bytesPerLine = image.bytesPerLine();
+        tile.format       = image.format();
+        tile.transform    = d.data();
+        tiles.append(tile);
+    }
+
+    QtConcurrent::blockingMap(tiles, Private::convertTile);
+
+    if (premultiplied)
+        image = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+}
+
+} // namespace PhotoLayoutsEditor
@@ -0,0 +1,79 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef PLE_COLOR_TRANSFORM_H
+#define PLE_COLOR_TRANSFORM_H
+
+// Qt includes
+
+#include <QImage>
+#include <QSharedPointer>
+
+// Local includes
+
+#include "pleiccprofile.h"
+
+namespace PhotoLayoutsEditor
+{
+
+/** Conversion of 8 bit RGB images between two ICC profiles, done by the digiKam color management (lcms2).
+ * Both profiles must have RGB color space, the image format can't store other color spaces.
+ */
+class PLEColorTransform
+{
+public:
+
+    enum RenderingIntent
+    {
+        Perceptual = 0,
+        RelativeColorimetric,
+        Saturation,
+        AbsoluteColorimetric
+    };
+
+    /// Creates identity transform
+    PLEColorTransform();
+
+    /// Returns transform between the profiles, identity if any of them is null or isn't RGB
+    static PLEColorTransform transform(const PLEIccProfile& source,
+                                       const PLEIccProfile& destination,
+                                       RenderingIntent intent = Perceptual);
+
+    bool isIdentity() const;
+
+    /** Converts pixels in place, tiles of rows are converted in parallel.
+     * Formats other than (A)RGB32 are converted to ARGB32_Premultiplied first,
+     * premultiplied pixels are converted with their straight color.
+     */
+    void apply(QImage& image) const;
+
+private:
+
+    class Private;
+    QSharedPointer<const Private> d;
+};
+
+} // namespace PhotoLayoutsEditor
+
+#endif // PLE_COLOR_TRANSFORM_H
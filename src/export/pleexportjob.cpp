@@ -0,0 +1,282 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "pleexportjob.h"
+
+// Qt includes
+
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QFileInfo>
+#include <QHash>
+#include <QDebug>
+
+// Local includes
+
+#include "plesceneexporter.h"
+#include "plepdfexporter.h"
+#include "progressevent.h"
+
+namespace PhotoLayoutsEditor
+{
+
+class PLEExportJob::Private
+{
+public:
+
+    explicit Private(const PLESceneSnapshot& scene)
+        : snapshot(scene),
+          size((scene.sceneRect().size() * scene.resolution()).toSize()),
+          dpi(72, 72),
+          intent(PLEColorTransform::Perceptual),
+          receiver(nullptr),
+          current(0)
+    {
+    }
+
+    PLESceneSnapshot                   snapshot;
+    QHash<QString, PLESceneSnapshot>   previous;
+    QSize                              size;
+    QSizeF                             dpi;
+    PLEIccProfile                      profile;
+    PLEColorTransform::RenderingIntent intent;
+    QSharedPointer<PLEPdfExporter>     pdf;
+    QStringList                        files;
+    QList<QByteArray>                  formats;
+    QStringList                        written;
+    QStringList                        errors;
+    QAtomicInt                         cancelled;
+    QObject*                           receiver;
+    int                                current;
+};
+
+PLEExportJob::PLEExportJob(const PLESceneSnapshot& snapshot, QObject* parent)
+    : QThread(parent),
+      d(new Private(snapshot))
+{
+}
+
+PLEExportJob::~PLEExportJob()
+{
+    cancel();
+    wait();
+    delete d;
+}
+
+PLESceneSnapshot PLEExportJob::snapshot() const
+{
+    return d->snapshot;
+}
+
+void PLEExportJob::setOutputSize(const QSize& size)
+{
+    d->size = size;
+}
+
+QSize PLEExportJob::outputSize() const
+{
+    return d->size;
+}
+
+void PLEExportJob::setPdfExporter(const QSharedPointer<PLEPdfExporter>& exporter)
+{
+    d->pdf = exporter;
+}
+
+void PLEExportJob::setResolution(const QSizeF& dpi)
+{
+    d->dpi = dpi;
+}
+
+QSizeF PLEExportJob::resolution() const
+{
+    return d->dpi;
+}
+
+void PLEExportJob::setColorProfile(const PLEIccProfile& profile, PLEColorTransform::RenderingIntent intent)
+{
+    d->profile = profile;
+    d->intent  = intent;
+}
+
+PLEIccProfile PLEExportJob::colorProfile() const
+{
+    return d->profile;
+}
+
+void PLEExportJob::addOutput(const QString& fileName, const QByteArray& format)
+{
+    removeOutput(fileName);
+
+    d->files   << fileName;
+    d->formats << format.toLower();
+}
+
+void PLEExportJob::removeOutput(const QString& fileName)
+{
+    const int index = d->files.indexOf(fileName);
+
+    if (index < 0)
+        return;
+
+    d->files.removeAt(index);
+    d->formats.removeAt(index);
+}
+
+QStringList PLEExportJob::outputs() const
+{
+    return d->files;
+}
+
+QByteArray PLEExportJob::outputHash(const QString& fileName) const
+{
+    const QByteArray settings = settingsHash(fileName);
+
+    if (settings.isEmpty())
+        return QByteArray();
+
+    return QCryptographicHash::hash(d->snapshot.contentHash() + settings, QCryptographicHash::Md5);
+}
+
+QByteArray PLEExportJob::settingsHash(const QString& fileName) const
+{
+    const int index = d->files.indexOf(fileName);
+
+    if (index < 0)
+        return QByteArray();
+
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream << d->size << d->dpi << d->formats.at(index) << d->profile.hash() << qint32(d->intent);
+
+    return QCryptographicHash::hash(data, QCryptographicHash::Md5);
+}
+
+void PLEExportJob::setPreviousSnapshot(const QString& fileName, const PLESceneSnapshot& previous)
+{
+    d->previous.insert(fileName, previous);
+}
+
+QStringList PLEExportJob::writtenOutputs() const
+{
+    return d->written;
+}
+
+QStringList PLEExportJob::errors() const
+{
+    return d->errors;
+}
+
+bool PLEExportJob::isCancelled() const
+{
+    return d->cancelled.loadAcquire();
+}
+
+void PLEExportJob::cancel()
+{
+    d->cancelled.storeRelease(1);
+}
+
+void PLEExportJob::setProgressReceiver(QObject* receiver)
+{
+    d->receiver = receiver;
+}
+
+void PLEExportJob::progresChanged(double progress)
+{
+    const int count = qMax(1, d->files.count());
+    postProgressEvent(ProgressEvent::ProgressUpdate, (d->current + progress) / count);
+}
+
+void PLEExportJob::progresName(const QString& name)
+{
+    postProgressEvent(ProgressEvent::ActionUpdate, name);
+}
+
+void PLEExportJob::run()
+{
+    d->written.clear();
+    d->errors.clear();
+
+    postProgressEvent(ProgressEvent::Init, 0);
+
+    for (d->current = 0 ; d->current < d->files.count() && !isCancelled() ; ++d->current)
+    {
+        const QString& fileName = d->files.at(d->current);
+        progresName(QObject::tr("Exporting %1...").arg(QFileInfo(fileName).fileName()));
+
+        bool result = false;
+        QString error;
+
+        if (d->pdf && d->formats.at(d->current) == "pdf")
+        {
+            d->pdf->setObserver(this);
+            d->pdf->setCancelFlag(&d->cancelled);
+            d->pdf->setColorProfile(d->profile, d->intent);
+            result = d->pdf->exportTo(fileName);
+            error  = d->pdf->errorString();
+        }
+        else
+        {
+            PLESceneExporter exporter(d->snapshot);
+            exporter.setOutputSize(d->size);
+            exporter.setResolution(d->dpi);
+            exporter.setColorProfile(d->profile, d->intent);
+            exporter.setPreviousSnapshot(d->previous.value(fileName));
+            exporter.setObserver(this);
+            exporter.setCancelFlag(&d->cancelled);
+            result = exporter.exportTo(fileName, d->formats.at(d->current));
+            error  = exporter.errorString();
+        }
+
+        if (result)
+        {
+            d->written << fileName;
+            continue;
+        }
+
+        // Writers drop their partial output, files written before are kept
+        if (isCancelled())
+            break;
+
+        qDebug() << "Export to" << fileName << "failed:" << error;
+        d->errors << QString::fromLatin1("%1: %2").arg(fileName, error);
+    }
+
+    postProgressEvent(ProgressEvent::Finish, 0);
+}
+
+void PLEExportJob::postProgressEvent(int type, const QVariant& data)
+{
+    if (!d->receiver)
+        return;
+
+    ProgressEvent* const event = new ProgressEvent(this);
+    event->setData(static_cast<ProgressEvent::Type>(type), data);
+    QCoreApplication::postEvent(d->receiver, event);
+}
+
+} // namespace PhotoLayoutsEditor
@@ -0,0 +1,124 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef PLE_EXPORT_JOB_H
+#define PLE_EXPORT_JOB_H
+
+// Qt includes
+
+#include <QThread>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QSizeF>
+#include <QVariant>
+
+// Local includes
+
+#include "plecolortransform.h"
+#include "plescenesnapshot.h"
+#include "progressobserver.h"
+
+namespace PhotoLayoutsEditor
+{
+
+class PLEPdfExporter;
+
+/** Writes scene snapshot into one or more files in a worker thread.
+ * Job has to be set up before it's started, progress is posted to the receiver as ProgressEvent.
+ */
+class PLEExportJob : public QThread, public ProgressObserver
+{
+    Q_OBJECT
+
+public:
+
+    explicit PLEExportJob(const PLESceneSnapshot& snapshot, QObject* parent = nullptr);
+    ~PLEExportJob() override;
+
+    PLESceneSnapshot snapshot() const;
+
+    /// Size of the output images in pixels, snapshot size at its resolution by default
+    void setOutputSize(const QSize& size);
+    QSize outputSize() const;
+
+    /// Resolution written into files, in dots per inch
+    void setResolution(const QSizeF& dpi);
+    QSizeF resolution() const;
+
+    /// Color profile of the outputs, PDF outputs keep sRGB colors and declare the profile as their output intent
+    void setColorProfile(const PLEIccProfile& profile,
+                         PLEColorTransform::RenderingIntent intent = PLEColorTransform::Perceptual);
+    PLEIccProfile colorProfile() const;
+
+    /// Adds file written by the job, format is given as a file suffix
+    void addOutput(const QString& fileName, const QByteArray& format);
+    void removeOutput(const QString& fileName);
+    QStringList outputs() const;
+
+    /// PDF outputs are written by the exporter instead of painting the snapshot
+    void setPdfExporter(const QSharedPointer<PLEPdfExporter>& exporter);
+
+    /// Identifies data written into the output, exports with equal hashes produce equal files
+    QByteArray outputHash(const QString& fileName) const;
+
+    /// Identifies settings of the output, files with equal settings hashes differ only by the scene content
+    QByteArray settingsHash(const QString& fileName) const;
+
+    /// Snapshot the existing output was written from with the same settings, only its changed parts are updated
+    void setPreviousSnapshot(const QString& fileName, const PLESceneSnapshot& previous);
+
+    /// Outputs successfully written by the finished job
+    QStringList writtenOutputs() const;
+    QStringList errors() const;
+
+    bool isCancelled() const;
+
+    /// Object receiving ProgressEvents of the job, it has to outlive the job
+    void setProgressReceiver(QObject* receiver);
+
+    void progresChanged(double progress) override;
+    void progresName(const QString& name) override;
+
+public Q_SLOTS:
+
+    /// May be called from any thread, partially written files are dropped and existing ones are kept
+    void cancel();
+
+protected:
+
+    void run() override;
+
+private:
+
+    void postProgressEvent(int type, const QVariant& data);
+
+private:
+
+    class Private;
+    Private* const d;
+};
+
+} // namespace PhotoLayoutsEditor
+
+#endif // PLE_EXPORT_JOB_H
@@ -0,0 +1,149 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "pleexportqueue.h"
+
+// Qt includes
+
+#include <QFileInfo>
+#include <QDebug>
+
+// Local includes
+
+#include "pleexportjob.h"
+
+namespace PhotoLayoutsEditor
+{
+
+PLEExportQueue::PLEExportQueue(QObject* parent)
+    : QObject(parent),
+      m_current(nullptr)
+{
+}
+
+PLEExportQueue::~PLEExportQueue()
+{
+    cancelAll();
+
+    // Job's destructor waits until it's stopped
+    delete m_current;
+}
+
+void PLEExportQueue::enqueue(PLEExportJob* job, QObject* progressReceiver)
+{
+    if (!job)
+        return;
+
+    job->setParent(this);
+    job->setProgressReceiver(progressReceiver);
+    m_jobs.enqueue(job);
+
+    if (!m_current)
+        startNext();
+}
+
+bool PLEExportQueue::isBusy() const
+{
+    return (m_current || !m_jobs.isEmpty());
+}
+
+void PLEExportQueue::cancelAll()
+{
+    qDeleteAll(m_jobs);
+    m_jobs.clear();
+
+    if (m_current)
+        m_current->cancel();
+}
+
+void PLEExportQueue::currentJobFinished()
+{
+    PLEExportJob* const job = m_current;
+    m_current               = nullptr;
+
+    if (!job)
+        return;
+
+    foreach (const QString& fileName, job->writtenOutputs())
+    {
+        const QFileInfo info(fileName);
+        ExportRecord record;
+        record.outputHash   = job->outputHash(fileName);
+        record.settingsHash = job->settingsHash(fileName);
+        record.snapshot     = job->snapshot().outline();
+        record.modified     = info.lastModified();
+        record.size         = info.size();
+        m_exported.insert(fileName, record);
+    }
+
+    Q_EMIT jobFinished(job);
+
+    job->deleteLater();
+    startNext();
+}
+
+void PLEExportQueue::startNext()
+{
+    while (!m_current && !m_jobs.isEmpty())
+    {
+        PLEExportJob* const job = m_jobs.dequeue();
+
+        // Checked just before the start, previous job could write the same files
+        foreach (const QString& fileName, job->outputs())
+        {
+            if (!m_exported.contains(fileName))
+                continue;
+
+            const ExportRecord record = m_exported.value(fileName);
+            const QFileInfo info(fileName);
+
+            // Files modified by other applications are written again
+            if (!info.exists() || info.lastModified() != record.modified || info.size() != record.size)
+                continue;
+
+            if (record.outputHash == job->outputHash(fileName))
+            {
+                qDebug() << "Scene wasn't changed since last export to" << fileName << ", skipping";
+                job->removeOutput(fileName);
+            }
+            else if (record.settingsHash == job->settingsHash(fileName))
+            {
+                job->setPreviousSnapshot(fileName, record.snapshot);
+            }
+        }
+
+        if (job->outputs().isEmpty())
+        {
+            Q_EMIT jobFinished(job);
+            job->deleteLater();
+            continue;
+        }
+
+        m_current = job;
+        connect(job, SIGNAL(finished()), this, SLOT(currentJobFinished()));
+        job->start(QThread::LowPriority);
+    }
+}
+
+} // namespace PhotoLayoutsEditor
@@ -0,0 +1,107 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef PLE_EXPORT_QUEUE_H
+#define PLE_EXPORT_QUEUE_H
+
+// Qt includes
+
+#include <QObject>
+#include <QQueue>
+#include <QHash>
+#include <QByteArray>
+#include <QDateTime>
+
+// Local includes
+
+#include "plescenesnapshot.h"
+
+namespace PhotoLayoutsEditor
+{
+
+class PLEExportJob;
+
+/** Runs export jobs one after another in background.
+ * Outputs which were already written from the same scene content with the same
+ * settings and weren't modified since are skipped, outputs written with the same
+ * settings get only the changed parts updated.
+ */
+class PLEExportQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    explicit PLEExportQueue(QObject* parent = nullptr);
+    ~PLEExportQueue() override;
+
+    /// Takes ownership of the job, progress of the job is posted to the receiver
+    void enqueue(PLEExportJob* job, QObject* progressReceiver = nullptr);
+
+    bool isBusy() const;
+
+public Q_SLOTS:
+
+    void cancelAll();
+
+Q_SIGNALS:
+
+    /// Emitted when the job is done, it's deleted after returning to the event loop
+    void jobFinished(PLEExportJob* job);
+
+private Q_SLOTS:
+
+    void currentJobFinished();
+
+private:
+
+    void startNext();
+
+private:
+
+    /** Last export of the file, the file is recognized by its size and modification time.
+     * Only outline of the snapshot is kept, its item hashes and rects.
+     */
+    struct ExportRecord
+    {
+        ExportRecord()
+            : size(0)
+        {
+        }
+
+        QByteArray       outputHash;
+        QByteArray       settingsHash;
+        PLESceneSnapshot snapshot;
+        QDateTime        modified;
+        qint64           size;
+    };
+
+    QQueue<PLEExportJob*>        m_jobs;
+    PLEExportJob*                m_current;
+    QHash<QString, ExportRecord> m_exported;
+};
+
+} // namespace PhotoLayoutsEditor
+
+#endif // PLE_EXPORT_QUEUE_H
@@ -0,0 +1,161 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+
+#include "pleiccprofile.h"
+
+// Qt includes
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QObject>
+
+namespace PhotoLayoutsEditor
+{
+
+class PLEIccProfile::Private
+{
+public:
+
+    Private()
+        : components(0)
+    {
+    }
+
+    /// Opens the profile and reads everything copies need, so they never touch the lcms2 handle
+    bool open()
+    {
+        if (profile.isNull() || !profile.open())
+        {
+            error = QObject::tr("The file isn't an ICC profile.");
+            return false;
+        }
+
+        data        = profile.data();
+        description = profile.description();
+        hash        = QCryptographicHash::hash(data, QCryptographicHash::Md5).toHex();
+
+        // Color space signature of the profile header
+        const QByteArray colorSpace = data.mid(16, 4);
+
+        if (colorSpace == "RGB ")
+            components = 3;
+        else if (colorSpace == "CMYK")
+            components = 4;
+        else if (colorSpace == "GRAY")
+            components = 1;
+
+        return true;
+    }
+
+public:
+
+    Digikam::IccProfile profile;
+    QByteArray          data;
+    QByteArray          hash;
+    QString             description;
+    QString             error;
+    int                 components;
+};
+
+// --------------------------------------------------------------------------------------------------------------
+
+PLEIccProfile::PLEIccProfile()
+{
+}
+
+PLEIccProfile PLEIccProfile::sRGB()
+{
+    static const PLEIccProfile profile = fromData(Digikam::IccProfile::sRGB().data());
+
+    return profile;
+}
+
+PLEIccProfile PLEIccProfile::fromFile(const QString& fileName)
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        Private* const p = new Private;
+        p->error         = file.errorString();
+        PLEIccProfile profile;
+        profile.d        = QSharedPointer<const Private>(p);
+
+        return profile;
+    }
+
+    return fromData(file.readAll());
+}
+
+PLEIccProfile PLEIccProfile::fromData(const QByteArray& data)
+{
+    Private* const p = new Private;
+    p->profile       = Digikam::IccProfile(data);
+
+    if (!p->open())
+        p->profile = Digikam::IccProfile();
+
+    PLEIccProfile profile;
+    profile.d = QSharedPointer<const Private>(p);
+
+    return profile;
+}
+
+bool PLEIccProfile::isNull() const
+{
+    return (!d || d->hash.isEmpty());
+}
+
+QByteArray PLEIccProfile::data() const
+{
+    return (d ? d->data : QByteArray());
+}
+
+QString PLEIccProfile::description() const
+{
+    return (d ? d->description : QString());
+}
+
+int PLEIccProfile::components() const
+{
+    return (d ? d->components : 0);
+}
+
+QByteArray PLEIccProfile::hash() const
+{
+    return (d ? d->hash : QByteArray());
+}
+
+QString PLEIccProfile::errorString() const
+{
+    return (d ? d->error : QString());
+}
+
+Digikam::IccProfile PLEIccProfile::iccProfile() const
+{
+    return (d ? d->profile : Digikam::IccProfile());
+}
+
+} // namespace PhotoLayoutsEditor
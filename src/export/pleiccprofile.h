@@ -0,0 +1,84 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef PLE_ICC_PROFILE_H
+#define PLE_ICC_PROFILE_H
+
+// Qt includes
+
+#include <QByteArray>
+#include <QSharedPointer>
+#include <QString>
+
+// digiKam includes
+
+#include "iccprofile.h"
+
+namespace PhotoLayoutsEditor
+{
+
+/** ICC color profile read with the digiKam color management (lcms2), any profile class
+ * and color space lcms2 understands is accepted. Copies share the profile data.
+ */
+class PLEIccProfile
+{
+public:
+
+    /// Creates null profile
+    PLEIccProfile();
+
+    /// sRGB profile of digiKam, scene pixels are in this color space
+    static PLEIccProfile sRGB();
+
+    static PLEIccProfile fromFile(const QString& fileName);
+    static PLEIccProfile fromData(const QByteArray& data);
+
+    bool isNull() const;
+
+    /// Data of the ICC file
+    QByteArray data() const;
+
+    QString description() const;
+
+    /// Number of components of the profile color space, 3 for RGB, 4 for CMYK, 0 if unknown
+    int components() const;
+
+    /// Identifies the profile, equal for profiles with the same data
+    QByteArray hash() const;
+
+    /// Reason why the profile couldn't be read
+    QString errorString() const;
+
+    /// Profile handled by the digiKam color management
+    Digikam::IccProfile iccProfile() const;
+
+private:
+
+    class Private;
+    QSharedPointer<const Private> d;
+};
+
+} // namespace PhotoLayoutsEditor
+
+#endif // PLE_ICC_PROFILE_H
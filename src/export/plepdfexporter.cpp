@@ -0,0 +1,1266 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "plepdfexporter.h"
+
+// C++ includes
+
+#include <climits>
+
+// Qt includes
+
+#include <QBuffer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDateTime>
+#include <QHash>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QPaintDevice>
+#include <QPaintEngine>
+#include <QPainter>
+#include <QPainterPath>
+#include <QStyleOptionGraphicsItem>
+#include <QVector>
+#include <QtConcurrent>
+#include <QDebug>
+
+// Local includes
+
+#include "plescene.h"
+#include "plescenebackground.h"
+#include "plesceneborder.h"
+#include "photoitem.h"
+#include "photoeffectsgroup.h"
+#include "bordersgroup.h"
+#include "progressobserver.h"
+
+namespace PhotoLayoutsEditor
+{
+
+/** Image embedded into the document, it's copied from the JPEG file if the file is set and wasn't modified since.
+ * Photos with effects are recorded as their fills and rendered when the document is written.
+ */
+struct PLEPdfImage
+{
+    PLEPdfImage()
+        : lossy(false)
+    {
+    }
+
+    QImage          image;
+    PhotoItemFill   fill;
+    QSize           size;
+    QString         jpegFile;
+    QDateTime       jpegModified;
+    bool            lossy;
+};
+
+/// Image encoded into PDF streams, mask is empty for opaque images
+struct PLEPdfImageData
+{
+    QByteArray dictionary;
+    QByteArray data;
+    QByteArray maskDictionary;
+    QByteArray maskData;
+};
+
+static QByteArray pdfNumber(qreal value)
+{
+    if (qAbs(value) < 0.00005)
+        return QByteArray("0");
+
+    QByteArray result = QByteArray::number(value, 'f', 4);
+
+    while (result.endsWith('0'))
+        result.chop(1);
+
+    if (result.endsWith('.'))
+        result.chop(1);
+
+    return result;
+}
+
+static QByteArray pdfMatrixValues(const QTransform& matrix)
+{
+    return pdfNumber(matrix.m11()) + ' ' + pdfNumber(matrix.m12()) + ' ' +
+           pdfNumber(matrix.m21()) + ' ' + pdfNumber(matrix.m22()) + ' ' +
+           pdfNumber(matrix.dx())  + ' ' + pdfNumber(matrix.dy());
+}
+
+static QByteArray pdfMatrix(const QTransform& matrix)
+{
+    return pdfMatrixValues(matrix) + " cm\n";
+}
+
+static QByteArray pdfColorValues(const QColor& color)
+{
+    return pdfNumber(color.redF()) + ' ' + pdfNumber(color.greenF()) + ' ' + pdfNumber(color.blueF());
+}
+
+/// Text string in UTF-16BE, it needs no escaping
+static QByteArray pdfText(const QString& text)
+{
+    QByteArray result = "<FEFF";
+
+    foreach (const QChar& c, text)
+        result += QByteArray::number(c.unicode(), 16).rightJustified(4, '0').toUpper();
+
+    return result + '>';
+}
+
+/// Rendering intent operator of the content stream
+static QByteArray pdfIntent(PLEColorTransform::RenderingIntent intent)
+{
+    switch (intent)
+    {
+        case PLEColorTransform::RelativeColorimetric:
+            return "/RelativeColorimetric ri\n";
+        case PLEColorTransform::Saturation:
+            return "/Saturation ri\n";
+        case PLEColorTransform::AbsoluteColorimetric:
+            return "/AbsoluteColorimetric ri\n";
+        default:
+            return "/Perceptual ri\n";
+    }
+}
+
+static QByteArray pdfColor(const QColor& color, bool stroke)
+{
+    return pdfColorValues(color) + (stroke ? " RG\n" : " rg\n");
+}
+
+/** Shading pattern of linear or radial gradient, \a matrix maps gradient coordinates to the page.
+ * Stops are joined with a stitching function of linear segments. Spread modes other than pad and
+ * alpha varying between stops can't be expressed by the shading, they're written as pad and opaque.
+ */
+static QByteArray pdfShadingPattern(const QGradient& gradient, const QTransform& matrix)
+{
+    QGradientStops stops = gradient.stops();
+
+    if (stops.first().first > 0)
+        stops.prepend(qMakePair(qreal(0), stops.first().second));
+
+    if (stops.last().first < 1)
+        stops.append(qMakePair(qreal(1), stops.last().second));
+
+    QByteArray functions;
+    QByteArray bounds;
+    QByteArray encode;
+
+    for (int i = 0 ; i < stops.count() - 1 ; ++i)
+    {
+        functions += "<< /FunctionType 2 /Domain [0 1] /C0 [" + pdfColorValues(stops.at(i).second)     +
+                     "] /C1 [" + pdfColorValues(stops.at(i + 1).second) + "] /N 1 >> ";
+        encode    += "0 1 ";
+
+        if (i > 0)
+            bounds += pdfNumber(stops.at(i).first) + ' ';
+    }
+
+    QByteArray shading;
+
+    if (gradient.type() == QGradient::LinearGradient)
+    {
+        const QLinearGradient& linear = static_cast<const QLinearGradient&>(gradient);
+        shading = "/ShadingType 2 /Coords [" + pdfNumber(linear.start().x()) + ' ' + pdfNumber(linear.start().y())     + ' ' +
+                                               pdfNumber(linear.finalStop().x()) + ' ' + pdfNumber(linear.finalStop().y()) + ']';
+    }
+    else
+    {
+        const QRadialGradient& radial = static_cast<const QRadialGradient&>(gradient);
+        shading = "/ShadingType 3 /Coords [" + pdfNumber(radial.focalPoint().x()) + ' ' + pdfNumber(radial.focalPoint().y()) + ' ' +
+                                               pdfNumber(radial.focalRadius())     + ' '                                      +
+                                               pdfNumber(radial.center().x())      + ' ' + pdfNumber(radial.center().y())     + ' ' +
+                                               pdfNumber(radial.radius())          + ']';
+    }
+
+    return "/PatternType 2 /Matrix [" + pdfMatrixValues(matrix) + "] /Shading << " + shading +
+           " /ColorSpace /DeviceRGB /Extend [true true] /Function << /FunctionType 3 /Domain [0 1] /Functions [" +
+           functions + "] /Bounds [" + bounds + "] /Encode [" + encode + "] >> >>";
+}
+
+static QByteArray pdfPath(const QPainterPath& path)
+{
+    QByteArray result;
+
+    for (int i = 0 ; i < path.elementCount() ; ++i)
+    {
+        const QPainterPath::Element& element = path.elementAt(i);
+
+        switch (element.type)
+        {
+            case QPainterPath::MoveToElement:
+                result += pdfNumber(element.x) + ' ' + pdfNumber(element.y) + " m\n";
+                break;
+
+            case QPainterPath::LineToElement:
+                result += pdfNumber(element.x) + ' ' + pdfNumber(element.y) + " l\n";
+                break;
+
+            case QPainterPath::CurveToElement:
+
+                if (i + 2 < path.elementCount())
+                {
+                    const QPainterPath::Element& c2  = path.elementAt(i + 1);
+                    const QPainterPath::Element& end = path.elementAt(i + 2);
+                    result += pdfNumber(element.x) + ' ' + pdfNumber(element.y) + ' ' +
+                              pdfNumber(c2.x)      + ' ' + pdfNumber(c2.y)      + ' ' +
+                              pdfNumber(end.x)     + ' ' + pdfNumber(end.y)     + " c\n";
+                    i += 2;
+                }
+
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    return result;
+}
+
+static QByteArray pdfFlate(const QByteArray& data)
+{
+    // qCompress() prepends uncompressed size to the zlib stream
+    return qCompress(data).mid(4);
+}
+
+/// Reads size and number of components of 8 bit baseline or progressive JPEG data
+static bool pdfJpegInfo(const QByteArray& data, QSize* const size, int* const components)
+{
+    const uchar* const p = reinterpret_cast<const uchar*>(data.constData());
+    const int length     = data.size();
+
+    if (length < 4 || p[0] != 0xFF || p[1] != 0xD8)
+        return false;
+
+    int pos = 2;
+
+    while (pos + 4 <= length)
+    {
+        if (p[pos] != 0xFF)
+            return false;
+
+        const uchar marker = p[pos + 1];
+
+        // Fill bytes and markers without segment
+        if (marker == 0xFF)
+        {
+            ++pos;
+            continue;
+        }
+
+        if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD8))
+        {
+            pos += 2;
+            continue;
+        }
+
+        // Start of frame, arithmetic coding and lossless modes aren't supported by PDF readers
+        if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC)
+        {
+            if (marker > 0xC2 || pos + 10 > length)
+                return false;
+
+            *size       = QSize((p[pos + 7] << 8) | p[pos + 8], (p[pos + 5] << 8) | p[pos + 6]);
+            *components = p[pos + 9];
+
+            return (p[pos + 4] == 8);
+        }
+
+        // End of image or scan data before the frame header
+        if (marker == 0xD9 || marker == 0xDA)
+            return false;
+
+        pos += 2 + ((p[pos + 2] << 8) | p[pos + 3]);
+    }
+
+    return false;
+}
+
+static PLEPdfImageData pdfEncodeImage(const PLEPdfImage& entry)
+{
+    PLEPdfImageData result;
+
+    // Original file is copied if it's still the same image, rotated photos are displayed as read with autoTransform
+    if (!entry.jpegFile.isEmpty())
+    {
+        QFile file(entry.jpegFile);
+
+        if (QFileInfo(file).lastModified() == entry.jpegModified && file.open(QIODevice::ReadOnly))
+        {
+            const QByteArray data = file.readAll();
+            QSize size;
+            int components        = 0;
+            QBuffer buffer;
+            buffer.setData(data);
+            QImageReader reader(&buffer, "jpeg");
+
+            if (reader.transformation() == QImageIOHandler::TransformationNone &&
+                pdfJpegInfo(data, &size, &components) && size == entry.image.size() && (components == 1 || components == 3))
+            {
+                result.dictionary = "/Width " + QByteArray::number(size.width()) + " /Height " + QByteArray::number(size.height()) +
+                                    (components == 1 ? " /ColorSpace /DeviceGray" : " /ColorSpace /DeviceRGB") +
+                                    " /BitsPerComponent 8 /Filter /DCTDecode";
+                result.data       = data;
+
+                return result;
+            }
+        }
+
+        qDebug() << "Can't copy" << entry.jpegFile << "into PDF, image is encoded again";
+    }
+
+    const QImage image = (entry.fill.isNull() ? entry.image : entry.fill.render()).convertToFormat(QImage::Format_ARGB32);
+    const int width    = image.width();
+    const int height   = image.height();
+    QByteArray rgb(width * height * 3, Qt::Uninitialized);
+    QByteArray alpha(width * height, Qt::Uninitialized);
+    bool opaque        = true;
+
+    for (int y = 0 ; y < height ; ++y)
+    {
+        const QRgb* const line = reinterpret_cast<const QRgb*>(image.constScanLine(y));
+        char* const color      = rgb.data() + y * width * 3;
+        char* const mask       = alpha.data() + y * width;
+
+        for (int x = 0 ; x < width ; ++x)
+        {
+            color[3 * x]     = char(qRed(line[x]));
+            color[3 * x + 1] = char(qGreen(line[x]));
+            color[3 * x + 2] = char(qBlue(line[x]));
+            mask[x]          = char(qAlpha(line[x]));
+            opaque           = opaque && (qAlpha(line[x]) == 255);
+        }
+    }
+
+    const QByteArray size = "/Width " + QByteArray::number(width) + " /Height " + QByteArray::number(height);
+
+    if (entry.lossy && opaque)
+    {
+        const QImage rgbImage(reinterpret_cast<const uchar*>(rgb.constData()), width, height, width * 3, QImage::Format_RGB888);
+        QBuffer buffer;
+        buffer.open(QIODevice::WriteOnly);
+        QImageWriter writer(&buffer, "jpeg");
+        writer.setQuality(92);
+
+        if (writer.write(rgbImage))
+        {
+            result.dictionary = size + " /ColorSpace /DeviceRGB /BitsPerComponent 8 /Filter /DCTDecode";
+            result.data       = buffer.data();
+
+            return result;
+        }
+    }
+
+    result.dictionary = size + " /ColorSpace /DeviceRGB /BitsPerComponent 8 /Filter /FlateDecode";
+    result.data       = pdfFlate(rgb);
+
+    if (!opaque)
+    {
+        result.maskDictionary = size + " /ColorSpace /DeviceGray /BitsPerComponent 8 /Filter /FlateDecode";
+        result.maskData       = pdfFlate(alpha);
+    }
+
+    return result;
+}
+
+// ---------------------------------------------------------------------
+
+/// Page content stream with resources it uses
+class PLEPdfDocument
+{
+public:
+
+    int addImage(const QImage& image, bool lossy)
+    {
+        const qint64 key = image.cacheKey();
+
+        if (imageIndexes.contains(key))
+            return imageIndexes.value(key);
+
+        PLEPdfImage entry;
+        entry.image = image;
+        entry.size  = image.size();
+        entry.lossy = lossy;
+
+        return insertImage(key, entry);
+    }
+
+    /// Photo with effects, it's rendered by pdfEncodeImage()
+    int addPhoto(const PhotoItemFill& fill)
+    {
+        PLEPdfImage entry;
+        entry.fill  = fill;
+        entry.size  = fill.imageSize();
+        entry.lossy = true;
+        images     << entry;
+
+        return (images.count() - 1);
+    }
+
+    /// \a modified is the time of file modification when the image was read from it
+    int addJpeg(const QString& fileName, const QDateTime& modified, const QImage& image)
+    {
+        const qint64 key = image.cacheKey();
+
+        if (imageIndexes.contains(key))
+            return imageIndexes.value(key);
+
+        PLEPdfImage entry;
+        entry.image        = image;
+        entry.size         = image.size();
+        entry.jpegFile     = fileName;
+        entry.jpegModified = modified;
+        entry.lossy        = true;
+
+        return insertImage(key, entry);
+    }
+
+    /// Pattern dictionary, or tiling pattern dictionary with its content stream
+    int addPattern(const QByteArray& dictionary, const QByteArray& stream = QByteArray())
+    {
+        patterns << qMakePair(dictionary, stream);
+
+        return (patterns.count() - 1);
+    }
+
+    /// Sets opacity of painting until the end of current graphics state block
+    void setAlpha(qreal alpha)
+    {
+        if (alpha >= 1)
+            return;
+
+        alpha     = qRound(qMax(0.0, alpha) * 1000) / 1000.0;
+        int index = alphas.indexOf(alpha);
+
+        if (index < 0)
+        {
+            alphas << alpha;
+            index = alphas.count() - 1;
+        }
+
+        content += "/GS" + QByteArray::number(index) + " gs\n";
+    }
+
+    /// Draws whole image mapped by the transform from its pixel coordinates
+    void drawImage(int index, const QTransform& transform)
+    {
+        const QSize size = images.at(index).size;
+
+        content += "q\n" + pdfMatrix(QTransform(size.width(), 0, 0, -size.height(), 0, size.height()) * transform) +
+                   "/Im" + QByteArray::number(index) + " Do\nQ\n";
+    }
+
+private:
+
+    int insertImage(qint64 key, const PLEPdfImage& entry)
+    {
+        images << entry;
+        imageIndexes.insert(key, images.count() - 1);
+
+        return (images.count() - 1);
+    }
+
+public:
+
+    QByteArray                             content;
+    QVector<PLEPdfImage>                   images;
+    QHash<qint64, int>                     imageIndexes;
+    QList<qreal>                           alphas;
+    QVector<QPair<QByteArray, QByteArray> > patterns;
+};
+
+// ---------------------------------------------------------------------
+
+/// Paint engine writing painted paths and images into PDF content stream
+class PLEPdfPaintEngine : public QPaintEngine
+{
+public:
+
+    PLEPdfPaintEngine(PLEPdfDocument* const document, const QTransform& base)
+        : QPaintEngine(QPaintEngine::AllFeatures),
+          m_document(document),
+          m_base(base),
+          m_opacity(1),
+          m_clip_enabled(false)
+    {
+    }
+
+    using QPaintEngine::drawRects;
+    using QPaintEngine::drawLines;
+    using QPaintEngine::drawEllipse;
+    using QPaintEngine::drawPolygon;
+
+    bool begin(QPaintDevice* /*device*/) override
+    {
+        return true;
+    }
+
+    bool end() override
+    {
+        return true;
+    }
+
+    QPaintEngine::Type type() const override
+    {
+        return QPaintEngine::User;
+    }
+
+    void updateState(const QPaintEngineState& state) override
+    {
+        const QPaintEngine::DirtyFlags flags = state.state();
+
+        if (flags & QPaintEngine::DirtyTransform)
+            m_transform = state.transform();
+
+        if (flags & QPaintEngine::DirtyPen)
+            m_pen = state.pen();
+
+        if (flags & QPaintEngine::DirtyBrush)
+            m_brush = state.brush();
+
+        if (flags & QPaintEngine::DirtyBrushOrigin)
+            m_brush_origin = state.brushOrigin();
+
+        if (flags & QPaintEngine::DirtyOpacity)
+            m_opacity = state.opacity();
+
+        if (flags & QPaintEngine::DirtyClipEnabled)
+            m_clip_enabled = state.isClipEnabled();
+
+        if (flags & QPaintEngine::DirtyClipRegion)
+        {
+            QPainterPath path;
+            path.addRegion(state.clipRegion());
+            addClip(path, state.clipOperation());
+        }
+
+        if (flags & QPaintEngine::DirtyClipPath)
+            addClip(state.clipPath(), state.clipOperation());
+    }
+
+    void drawPath(const QPainterPath& path) override
+    {
+        fillPath(path, m_brush);
+        strokePath(path);
+    }
+
+    void drawRects(const QRectF* rects, int rectCount) override
+    {
+        QPainterPath path;
+
+        for (int i = 0 ; i < rectCount ; ++i)
+            path.addRect(rects[i]);
+
+        drawPath(path);
+    }
+
+    void drawLines(const QLineF* lines, int lineCount) override
+    {
+        QPainterPath path;
+
+        for (int i = 0 ; i < lineCount ; ++i)
+        {
+            path.moveTo(lines[i].p1());
+            path.lineTo(lines[i].p2());
+        }
+
+        strokePath(path);
+    }
+
+    void drawEllipse(const QRectF& rect) override
+    {
+        QPainterPath path;
+        path.addEllipse(rect);
+        drawPath(path);
+    }
+
+    void drawPolygon(const QPointF* points, int pointCount, PolygonDrawMode mode) override
+    {
+        if (pointCount < 1)
+            return;
+
+        QPainterPath path(points[0]);
+
+        for (int i = 1 ; i < pointCount ; ++i)
+            path.lineTo(points[i]);
+
+        if (mode == QPaintEngine::PolylineMode)
+        {
+            strokePath(path);
+            return;
+        }
+
+        path.closeSubpath();
+        path.setFillRule(mode == QPaintEngine::OddEvenMode ? Qt::OddEvenFill : Qt::WindingFill);
+        drawPath(path);
+    }
+
+    void drawPixmap(const QRectF& rect, const QPixmap& pixmap, const QRectF& sourceRect) override
+    {
+        drawImage(rect, pixmap.toImage(), sourceRect, Qt::AutoColor);
+    }
+
+    void drawImage(const QRectF& rect, const QImage& image, const QRectF& sourceRect, Qt::ImageConversionFlags /*flags*/) override
+    {
+        const QImage source = (sourceRect == QRectF(image.rect()) ? image : image.copy(sourceRect.toAlignedRect()));
+
+        if (source.isNull())
+            return;
+
+        const int index = m_document->addImage(source, false);
+
+        beginBlock(1);
+        m_document->drawImage(index, QTransform::fromScale(rect.width()  / source.width(),
+                                                           rect.height() / source.height()) *
+                                     QTransform::fromTranslate(rect.left(), rect.top())     *
+                                     m_transform * m_base);
+        m_document->content += "Q\n";
+    }
+
+    void drawTextItem(const QPointF& point, const QTextItem& textItem) override
+    {
+        // Texts are written as outlines, so no fonts have to be embedded
+        QPainterPath path;
+        path.addText(point, textItem.font(), textItem.text());
+        fillPath(path, m_pen.brush());
+    }
+
+private:
+
+    void addClip(const QPainterPath& path, Qt::ClipOperation operation)
+    {
+        if (operation == Qt::NoClip)
+        {
+            m_clip.clear();
+            m_clip_enabled = false;
+            return;
+        }
+
+        if (operation == Qt::ReplaceClip)
+            m_clip.clear();
+
+        // Clip paths are stored in page coordinates
+        m_clip        << (m_transform * m_base).map(path);
+        m_clip_enabled = true;
+    }
+
+    /// Starts graphics state block with current clipping
+    void beginBlock(qreal alpha)
+    {
+        m_document->content += "q\n";
+
+        if (m_clip_enabled)
+        {
+            foreach (const QPainterPath& clip, m_clip)
+                m_document->content += pdfPath(clip) + (clip.fillRule() == Qt::OddEvenFill ? "W* n\n" : "W n\n");
+        }
+
+        m_document->setAlpha(alpha * m_opacity);
+    }
+
+    void fillPath(const QPainterPath& path, const QBrush& brush)
+    {
+        if (brush.style() == Qt::NoBrush || path.isEmpty())
+            return;
+
+        if (brush.style() >= Qt::Dense1Pattern && brush.style() <= Qt::DiagCrossPattern)
+        {
+            // Hatch patterns are tiled from their pixels, one pixel per unit of the painter
+            QImage tile(8, 8, QImage::Format_ARGB32_Premultiplied);
+            tile.fill(Qt::transparent);
+            QPainter p(&tile);
+            p.fillRect(tile.rect(), QBrush(brush.color(), brush.style()));
+            p.end();
+
+            QBrush texture(tile);
+            texture.setTransform(brush.transform());
+            fillPath(path, texture);
+
+            return;
+        }
+
+        if (brush.style() == Qt::TexturePattern)
+        {
+            const QImage texture = brush.textureImage();
+
+            if (texture.isNull())
+                return;
+
+            const int index              = m_document->addImage(texture, false);
+            const QTransform brushMatrix = brush.transform() * QTransform::fromTranslate(m_brush_origin.x(), m_brush_origin.y());
+            beginBlock(1);
+
+            // Images filling their shapes are drawn once, textures smaller than the shape are repeated by a tiling pattern
+            if (QRectF(texture.rect()).adjusted(-0.5, -0.5, 0.5, 0.5).contains(brushMatrix.inverted().mapRect(path.boundingRect())))
+            {
+                m_document->content += pdfMatrix(m_transform * m_base) + pdfPath(path) +
+                                       (path.fillRule() == Qt::OddEvenFill ? "W* n\n" : "W n\n");
+                m_document->drawImage(index, brushMatrix);
+                m_document->content += "Q\n";
+
+                return;
+            }
+
+            const QByteArray width  = QByteArray::number(texture.width());
+            const QByteArray height = QByteArray::number(texture.height());
+            const int pattern       = m_document->addPattern("/PatternType 1 /PaintType 1 /TilingType 1 /BBox [0 0 " + width +
+                                                             ' ' + height + "] /XStep " + width + " /YStep " + height     +
+                                                             " /Matrix [" + pdfMatrixValues(brushMatrix * m_transform * m_base) + ']',
+                                                             width + " 0 0 -" + height + " 0 " + height + " cm /Im"        +
+                                                             QByteArray::number(index) + " Do\n");
+
+            m_document->content += pdfMatrix(m_transform * m_base) + "/Pattern cs /P" + QByteArray::number(pattern) + " scn\n" +
+                                   pdfPath(path) + (path.fillRule() == Qt::OddEvenFill ? "f*\nQ\n" : "f\nQ\n");
+
+            return;
+        }
+
+        if (brush.style() == Qt::LinearGradientPattern || brush.style() == Qt::RadialGradientPattern)
+        {
+            const QGradient* const gradient = brush.gradient();
+
+            if (gradient->stops().isEmpty())
+                return;
+
+            QTransform matrix = brush.transform() * QTransform::fromTranslate(m_brush_origin.x(), m_brush_origin.y()) *
+                                m_transform * m_base;
+
+            // Gradient coordinates are fractions of the filled shape
+            if (gradient->coordinateMode() == QGradient::ObjectBoundingMode)
+            {
+                const QRectF box = path.boundingRect();
+                matrix           = QTransform(box.width(), 0, 0, box.height(), box.left(), box.top()) * matrix;
+            }
+
+            const int index = m_document->addPattern(pdfShadingPattern(*gradient, matrix));
+
+            beginBlock(gradient->stops().first().second.alphaF());
+            m_document->content += pdfMatrix(m_transform * m_base) + "/Pattern cs /P" + QByteArray::number(index) + " scn\n" +
+                                   pdfPath(path) + (path.fillRule() == Qt::OddEvenFill ? "f*\nQ\n" : "f\nQ\n");
+
+            return;
+        }
+
+        const QColor color = solidColor(brush);
+
+        if (color.alpha() == 0)
+            return;
+
+        beginBlock(color.alphaF());
+        m_document->content += pdfMatrix(m_transform * m_base) + pdfColor(color, false) + pdfPath(path) +
+                               (path.fillRule() == Qt::OddEvenFill ? "f*\nQ\n" : "f\nQ\n");
+    }
+
+    void strokePath(const QPainterPath& path)
+    {
+        if (m_pen.style() == Qt::NoPen || path.isEmpty())
+            return;
+
+        const QColor color = solidColor(m_pen.brush());
+
+        if (color.alpha() == 0)
+            return;
+
+        qreal width = m_pen.widthF();
+
+        // Cosmetic width is given in scene units
+        if (m_pen.isCosmetic() && width > 0)
+            width /= qMax(0.0001, qSqrt(qAbs(m_transform.determinant())));
+
+        beginBlock(color.alphaF());
+        m_document->content += pdfMatrix(m_transform * m_base) + pdfColor(color, true) + pdfNumber(width) + " w\n";
+
+        switch (m_pen.capStyle())
+        {
+            case Qt::RoundCap:
+                m_document->content += "1 J\n";
+                break;
+
+            case Qt::SquareCap:
+                m_document->content += "2 J\n";
+                break;
+
+            default:
+                m_document->content += "0 J\n";
+                break;
+        }
+
+        switch (m_pen.joinStyle())
+        {
+            case Qt::RoundJoin:
+                m_document->content += "1 j\n";
+                break;
+
+            case Qt::BevelJoin:
+                m_document->content += "2 j\n";
+                break;
+
+            default:
+                m_document->content += "0 j\n";
+                break;
+        }
+
+        if (m_pen.style() != Qt::SolidLine)
+        {
+            QByteArray dashes;
+
+            foreach (qreal dash, m_pen.dashPattern())
+                dashes += pdfNumber(dash * qMax(width, 1.0)) + ' ';
+
+            m_document->content += '[' + dashes + "] 0 d\n";
+        }
+
+        m_document->content += pdfPath(path) + "S\nQ\n";
+    }
+
+    /// Conical gradients and gradient or pattern pens are approximated with a single color
+    static QColor solidColor(const QBrush& brush)
+    {
+        if (brush.gradient() && !brush.gradient()->stops().isEmpty())
+            return brush.gradient()->stops().first().second;
+
+        return brush.color();
+    }
+
+private:
+
+    PLEPdfDocument*      m_document;
+    QTransform           m_base;
+    QTransform           m_transform;
+    QPen                 m_pen;
+    QBrush               m_brush;
+    QPointF              m_brush_origin;
+    qreal                m_opacity;
+    bool                 m_clip_enabled;
+    QList<QPainterPath>  m_clip;
+};
+
+// ---------------------------------------------------------------------
+
+class PLEPdfPaintDevice : public QPaintDevice
+{
+public:
+
+    PLEPdfPaintDevice(PLEPdfPaintEngine* const engine, const QSize& size)
+        : m_engine(engine),
+          m_size(size)
+    {
+    }
+
+    ~PLEPdfPaintDevice() override
+    {
+    }
+
+    QPaintEngine* paintEngine() const override
+    {
+        return m_engine;
+    }
+
+protected:
+
+    int metric(PaintDeviceMetric id) const override
+    {
+        switch (id)
+        {
+            case PdmWidth:
+                return m_size.width();
+
+            case PdmHeight:
+                return m_size.height();
+
+            case PdmWidthMM:
+                return qRound(m_size.width() * 25.4 / 72);
+
+            case PdmHeightMM:
+                return qRound(m_size.height() * 25.4 / 72);
+
+            case PdmNumColors:
+                return INT_MAX;
+
+            case PdmDepth:
+                return 32;
+
+            case PdmDpiX:
+            case PdmDpiY:
+            case PdmPhysicalDpiX:
+            case PdmPhysicalDpiY:
+                return 72;
+
+            case PdmDevicePixelRatio:
+                return 1;
+
+            case PdmDevicePixelRatioScaled:
+                return qRound(devicePixelRatioFScale());
+
+            default:
+                return QPaintDevice::metric(id);
+        }
+    }
+
+private:
+
+    PLEPdfPaintEngine* m_engine;
+    QSize              m_size;
+};
+
+// ---------------------------------------------------------------------
+
+class PLEPdfExporter::Private
+{
+public:
+
+    explicit Private(const QSizeF& size)
+        : pageSize(size),
+          intent(PLEColorTransform::Perceptual),
+          observer(nullptr),
+          cancelFlag(nullptr)
+    {
+    }
+
+    bool isCancelled() const
+    {
+        return (cancelFlag && cancelFlag->loadAcquire());
+    }
+
+    /// Writes object and records its offset
+    bool writeObject(QSaveFile& file, int id, const QByteArray& dictionary, const QByteArray& stream = QByteArray())
+    {
+        if (offsets.count() < id)
+            offsets.resize(id);
+
+        offsets[id - 1] = file.pos();
+
+        QByteArray object = QByteArray::number(id) + " 0 obj\n<< " + dictionary;
+
+        if (stream.isNull())
+            return (file.write(object + " >>\nendobj\n") > 0);
+
+        object += " /Length " + QByteArray::number(stream.size()) + " >>\nstream\n";
+
+        return (file.write(object)                   == object.size() &&
+                file.write(stream)                   == stream.size() &&
+                file.write("\nendstream\nendobj\n") > 0);
+    }
+
+    QSizeF                             pageSize;
+    PLEPdfDocument                     document;
+    PLEIccProfile                      profile;
+    PLEColorTransform::RenderingIntent intent;
+    QVector<qint64>                    offsets;
+    ProgressObserver*                  observer;
+    const QAtomicInt*                  cancelFlag;
+    QString                            error;
+};
+
+PLEPdfExporter::PLEPdfExporter(PLEScene* const scene, const QSizeF& pageSize)
+    : d(new Private(pageSize))
+{
+    if (scene)
+        record(scene);
+}
+
+PLEPdfExporter::~PLEPdfExporter()
+{
+    delete d;
+}
+
+QSizeF PLEPdfExporter::pageSize() const
+{
+    return d->pageSize;
+}
+
+void PLEPdfExporter::setObserver(ProgressObserver* observer)
+{
+    d->observer = observer;
+}
+
+void PLEPdfExporter::setCancelFlag(const QAtomicInt* flag)
+{
+    d->cancelFlag = flag;
+}
+
+void PLEPdfExporter::setColorProfile(const PLEIccProfile& profile, PLEColorTransform::RenderingIntent intent)
+{
+    d->profile = profile;
+    d->intent  = intent;
+}
+
+QString PLEPdfExporter::errorString() const
+{
+    return d->error;
+}
+
+void PLEPdfExporter::record(PLEScene* const scene)
+{
+    const QRectF sceneRect = scene->sceneRect();
+
+    if (d->pageSize.isEmpty())
+        d->pageSize = sceneRect.size();
+
+    if (sceneRect.isEmpty())
+        return;
+
+    // PDF page has its origin in the bottom left corner
+    const QTransform base = QTransform::fromTranslate(-sceneRect.left(), -sceneRect.top()) *
+                            QTransform::fromScale(d->pageSize.width()  / sceneRect.width(),
+                                                  d->pageSize.height() / sceneRect.height()) *
+                            QTransform(1, 0, 0, -1, 0, d->pageSize.height());
+
+    PLEPdfPaintEngine engine(&d->document, base);
+    PLEPdfPaintDevice device(&engine, sceneRect.size().toSize());
+    QPainter painter(&device);
+
+    const QList<QGraphicsItem*> items = scene->items(Qt::AscendingOrder);
+
+    foreach (QGraphicsItem* const item, items)
+    {
+        if (!item->isVisible())
+            continue;
+
+        if (!dynamic_cast<AbstractPhoto*>(item)       &&
+            !dynamic_cast<PLESceneBackground*>(item)  &&
+            !dynamic_cast<PLESceneBorder*>(item))
+        {
+            continue;
+        }
+
+        QStyleOptionGraphicsItem option;
+        option.exposedRect = item->boundingRect();
+        option.rect        = option.exposedRect.toAlignedRect();
+
+        PhotoItem* const photo = dynamic_cast<PhotoItem*>(item);
+
+        // Photo is written as a single image clipped with its shape, empty photos are only placeholders
+        if (photo && !photo->isEmpty())
+        {
+            const QImage& image = photo->image();
+            const QSizeF area   = photo->m_image_path.boundingRect().size();
+            QTransform imageTransform;
+            int index;
+
+            if (!photo->effectsGroup() || photo->effectsGroup()->rowCount() == 0)
+            {
+                // Original image is scaled into the item the same way as effectiveImage() does
+                const QSize scaled = image.size().scaled(area.toSize(), Qt::KeepAspectRatioByExpanding);
+                imageTransform     = QTransform::fromScale(qreal(scaled.width())  / image.width(),
+                                                           qreal(scaled.height()) / image.height()) *
+                                     photo->d->m_brush_transform;
+
+                const QFileInfo file(photo->d->m_file_path.toLocalFile());
+                const QString suffix = file.suffix().toLower();
+
+                if (file.isFile() && (suffix == QLatin1String("jpg") || suffix == QLatin1String("jpeg") || suffix == QLatin1String("jpe")))
+                    index = d->document.addJpeg(file.absoluteFilePath(), photo->d->m_file_modified, image);
+                else
+                    index = d->document.addImage(image, true);
+            }
+            else
+            {
+                // Effects are applied in the exporting thread
+                const qreal nativeScale  = qMax(1.0, qMin(image.width() / area.width(), image.height() / area.height()));
+                const PhotoItemFill fill = photo->imageFill(nativeScale);
+                index                    = d->document.addPhoto(fill);
+                imageTransform           = fill.brushTransform;
+            }
+
+            const QPainterPath clip = photo->itemOpaqueArea() & photo->m_complete_path;
+
+            d->document.content += "q\n";
+            d->document.setAlpha(item->effectiveOpacity());
+            d->document.content += pdfMatrix(item->sceneTransform() * base) + pdfPath(clip) +
+                                   (clip.fillRule() == Qt::OddEvenFill ? "W* n\n" : "W n\n");
+            d->document.drawImage(index, imageTransform);
+            d->document.content += "Q\n";
+        }
+
+        painter.save();
+        painter.setTransform(item->sceneTransform());
+        painter.setOpacity(item->effectiveOpacity());
+
+        if (photo)
+        {
+            if (photo->bordersGroup())
+                photo->bordersGroup()->paint(&painter, &option);
+        }
+        else
+        {
+            item->paint(&painter, &option, nullptr);
+        }
+
+        painter.restore();
+    }
+
+    painter.end();
+}
+
+bool PLEPdfExporter::exportTo(const QString& fileName)
+{
+    // Existing file is replaced only when the new one is complete
+    QSaveFile file(fileName);
+
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        d->error = file.errorString();
+        return false;
+    }
+
+    // Catalog, pages, page and content have fixed ids, images are numbered from 5
+    d->offsets.fill(0, 4);
+    bool result = (file.write("%PDF-1.4\n%\xE2\xE3\xCF\xD3\n") > 0);
+
+    QByteArray xobjects;
+    const int count = d->document.images.count();
+    const int chunk = qMax(1, QThread::idealThreadCount());
+
+    // Images are encoded in parallel, a few at a time to limit memory usage
+    for (int first = 0 ; result && first < count ; first += chunk)
+    {
+        if (d->isCancelled())
+        {
+            d->error = QObject::tr("Export canceled");
+            result   = false;
+            break;
+        }
+
+        const QVector<PLEPdfImage> part        = d->document.images.mid(first, chunk);
+        const QVector<PLEPdfImageData> encoded = QtConcurrent::blockingMapped<QVector<PLEPdfImageData> >(part, pdfEncodeImage);
+
+        for (int i = 0 ; result && i < encoded.count() ; ++i)
+        {
+            const PLEPdfImageData& image = encoded.at(i);
+            QByteArray dictionary        = "/Type /XObject /Subtype /Image " + image.dictionary;
+
+            if (!image.maskData.isEmpty())
+            {
+                const int maskId = d->offsets.count() + 1;
+                result           = d->writeObject(file, maskId, "/Type /XObject /Subtype /Image " + image.maskDictionary, image.maskData);
+                dictionary      += " /SMask " + QByteArray::number(maskId) + " 0 R";
+            }
+
+            const int id = d->offsets.count() + 1;
+            result       = result && d->writeObject(file, id, dictionary, image.data);
+            xobjects    += "/Im" + QByteArray::number(first + i) + ' ' + QByteArray::number(id) + " 0 R ";
+        }
+
+        if (d->observer)
+            d->observer->progresChanged(0.95 * qMin(count, first + chunk) / count);
+    }
+
+    QByteArray patterns;
+
+    for (int i = 0 ; result && i < d->document.patterns.count() ; ++i)
+    {
+        QByteArray dictionary = d->document.patterns.at(i).first;
+
+        // Tiling patterns paint the images of the page
+        if (!d->document.patterns.at(i).second.isNull())
+            dictionary += " /Resources << /XObject << " + xobjects + ">> >>";
+
+        const int id = d->offsets.count() + 1;
+        result       = d->writeObject(file, id, dictionary, d->document.patterns.at(i).second);
+        patterns    += "/P" + QByteArray::number(i) + ' ' + QByteArray::number(id) + " 0 R ";
+    }
+
+    QByteArray states;
+
+    for (int i = 0 ; i < d->document.alphas.count() ; ++i)
+    {
+        const QByteArray alpha = pdfNumber(d->document.alphas.at(i));
+        states += "/GS" + QByteArray::number(i) + " << /Type /ExtGState /ca " + alpha + " /CA " + alpha + " >> ";
+    }
+
+    // DeviceRGB colors, images and shadings of the page are remapped to the sRGB profile
+    QByteArray colorSpaces;
+    const PLEIccProfile sRGB = PLEIccProfile::sRGB();
+
+    if (result && !sRGB.isNull())
+    {
+        const int id = d->offsets.count() + 1;
+        result       = d->writeObject(file, id, "/N 3 /Alternate /DeviceRGB /Filter /FlateDecode", pdfFlate(sRGB.data()));
+        colorSpaces  = "/DefaultRGB [/ICCBased " + QByteArray::number(id) + " 0 R] ";
+    }
+
+    QByteArray catalog   = "/Type /Catalog /Pages 2 0 R";
+    QByteArray content   = d->document.content;
+    const int components = d->profile.components();
+
+    if (result && !d->profile.isNull() && (components == 1 || components == 3 || components == 4))
+    {
+        const int id = d->offsets.count() + 1;
+        result       = d->writeObject(file, id, "/N " + QByteArray::number(components) + " /Filter /FlateDecode",
+                                      pdfFlate(d->profile.data()));
+        const QByteArray name = pdfText(d->profile.description());
+
+        // A plain PDF/A style intent, the document makes no PDF/X conformance claim
+
+        catalog     += " /OutputIntents [<< /Type /OutputIntent /S /GTS_PDFA1 /OutputConditionIdentifier " + name +
+                       " /Info " + name + " /DestOutputProfile " + QByteArray::number(id) + " 0 R >>]";
+        content.prepend(pdfIntent(d->intent));
+    }
+
+    const QByteArray mediaBox = "[0 0 " + pdfNumber(d->pageSize.width()) + ' ' + pdfNumber(d->pageSize.height()) + ']';
+
+    result = result &&
+             d->writeObject(file, 4, "/Filter /FlateDecode", pdfFlate(content))                                  &&
+             d->writeObject(file, 3, "/Type /Page /Parent 2 0 R /MediaBox " + mediaBox                          +
+                                     " /Resources << /XObject << " + xobjects + ">> /ExtGState << " + states       +
+                                     ">> /Pattern << " + patterns + ">> /ColorSpace << " + colorSpaces            +
+                                     ">> >> /Contents 4 0 R")                                                     &&
+             d->writeObject(file, 2, "/Type /Pages /Kids [3 0 R] /Count 1")                                       &&
+             d->writeObject(file, 1, catalog);
+
+    if (result)
+    {
+        const qint64 xref = file.pos();
+        QByteArray table  = "xref\n0 " + QByteArray::number(d->offsets.count() + 1) + "\n0000000000 65535 f \n";
+
+        foreach (qint64 offset, d->offsets)
+            table += QByteArray::number(offset).rightJustified(10, '0') + " 00000 n \n";
+
+        table += "trailer\n<< /Size " + QByteArray::number(d->offsets.count() + 1) + " /Root 1 0 R >>\nstartxref\n" +
+                 QByteArray::number(xref) + "\n%%EOF\n";
+
+        result = (file.write(table) == table.size());
+    }
+
+    if (!result && d->error.isEmpty())
+        d->error = file.errorString();
+
+    if (result && !file.commit())
+    {
+        d->error = file.errorString();
+        result   = false;
+    }
+
+    if (d->observer)
+        d->observer->progresChanged(1);
+
+    return result;
+}
+
+} // namespace PhotoLayoutsEditor
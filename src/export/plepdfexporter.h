@@ -0,0 +1,87 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef PLE_PDF_EXPORTER_H
+#define PLE_PDF_EXPORTER_H
+
+// Qt includes
+
+#include <QAtomicInt>
+#include <QSizeF>
+#include <QString>
+
+// Local includes
+
+#include "plecolortransform.h"
+
+namespace PhotoLayoutsEditor
+{
+
+class PLEScene;
+class ProgressObserver;
+
+/** Writes scene into single page PDF file without rasterizing it.
+ * Photos are embedded once at their native resolution, unmodified JPEG files are copied
+ * into the document without re-encoding. Crop shapes, borders and texts are written as vector paths.
+ * Scene is recorded by the constructor in the GUI thread, the file may be written from any thread.
+ * Colors are written in sRGB, tagged with its ICC profile.
+ */
+class PLEPdfExporter
+{
+public:
+
+    /// Page size is given in points, scene rect size is used by default
+    explicit PLEPdfExporter(PLEScene* const scene, const QSizeF& pageSize = QSizeF());
+    ~PLEPdfExporter();
+
+    QSizeF pageSize() const;
+
+    void setObserver(ProgressObserver* observer);
+
+    /// Export is stopped as soon as the flag is set, may be set from other threads
+    void setCancelFlag(const QAtomicInt* flag);
+
+    /** Profile of the output device, it's written as the output intent of the document,
+     * so that viewers and printers convert the sRGB colors to it with the rendering intent.
+     */
+    void setColorProfile(const PLEIccProfile& profile,
+                         PLEColorTransform::RenderingIntent intent = PLEColorTransform::Perceptual);
+
+    bool exportTo(const QString& fileName);
+    QString errorString() const;
+
+private:
+
+    PLEPdfExporter(const PLEPdfExporter&) = delete;
+    PLEPdfExporter& operator=(const PLEPdfExporter&) = delete;
+
+    void record(PLEScene* const scene);
+
+    class Private;
+    Private* const d;
+};
+
+} // namespace PhotoLayoutsEditor
+
+#endif // PLE_PDF_EXPORTER_H
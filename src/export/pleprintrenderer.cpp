@@ -0,0 +1,134 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "pleprintrenderer.h"
+
+// Qt includes
+
+#include <QPainter>
+#include <QPrinter>
+#include <QtConcurrent>
+
+// Local includes
+
+#include "plesceneexporter.h"
+
+namespace PhotoLayoutsEditor
+{
+
+static QRect bandRect(const QSize& size, int top, int rows)
+{
+    return QRect(0, top, size.width(), qMin(rows, size.height() - top));
+}
+
+PLEPrintRenderer::PLEPrintRenderer(QPrinter* printer)
+    : m_printer(printer),
+      m_band_height(512),
+      m_intent(PLEColorTransform::Perceptual)
+{
+}
+
+void PLEPrintRenderer::setBandHeight(int rows)
+{
+    m_band_height = qMax(1, rows);
+}
+
+void PLEPrintRenderer::setColorProfile(const PLEIccProfile& profile, PLEColorTransform::RenderingIntent intent)
+{
+    m_profile = profile;
+    m_intent  = intent;
+}
+
+QString PLEPrintRenderer::errorString() const
+{
+    return m_error;
+}
+
+bool PLEPrintRenderer::print(const QList<PLESceneSnapshot>& pages)
+{
+    int first = 1;
+    int last  = pages.count();
+
+    if (m_printer->printRange() == QPrinter::PageRange)
+    {
+        first = qMax(first, m_printer->fromPage());
+        last  = qMin(last,  m_printer->toPage());
+    }
+
+    if (first > last)
+    {
+        m_error = QObject::tr("Nothing to print");
+        return false;
+    }
+
+    const PLEColorTransform transform = PLEColorTransform::transform(PLEIccProfile::sRGB(), m_profile, m_intent);
+    QPainter p;
+
+    if (!p.begin(m_printer))
+    {
+        m_error = QObject::tr("Can't start printing");
+        return false;
+    }
+
+    for (int page = first ; page <= last ; ++page)
+    {
+        if (page > first && !m_printer->newPage())
+        {
+            m_error = QObject::tr("Can't start new page");
+            p.end();
+            return false;
+        }
+
+        const PLESceneSnapshot& snapshot = pages.at(page - 1);
+
+        if (snapshot.isNull())
+            continue;
+
+        // Band is rendered while the previous one is sent to the printer
+        PLESceneExporter exporter(snapshot);
+        const QSize size        = exporter.outputSize();
+        QFuture<QImage> pending = QtConcurrent::run(&exporter, &PLESceneExporter::renderBand, bandRect(size, 0, m_band_height));
+
+        for (int top = 0 ; top < size.height() ; top += m_band_height)
+        {
+            QImage band = pending.result();
+
+            if (top + m_band_height < size.height())
+                pending = QtConcurrent::run(&exporter, &PLESceneExporter::renderBand, bandRect(size, top + m_band_height, m_band_height));
+
+            transform.apply(band);
+            p.drawImage(QPoint(0, top), band);
+        }
+    }
+
+    if (!p.end())
+    {
+        m_error = QObject::tr("Printing failed");
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace PhotoLayoutsEditor
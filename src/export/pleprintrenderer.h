@@ -0,0 +1,79 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef PLE_PRINT_RENDERER_H
+#define PLE_PRINT_RENDERER_H
+
+// Qt includes
+
+#include <QList>
+#include <QString>
+
+// Local includes
+
+#include "plescenesnapshot.h"
+#include "plecolortransform.h"
+
+class QPrinter;
+
+namespace PhotoLayoutsEditor
+{
+
+/** Prints scene snapshots, one snapshot per page.
+ * Pages are sent to the printer as horizontal bands rendered at the printer resolution,
+ * so the spooler never receives a full page image. Photos are scaled to their device size
+ * once, when the snapshot is captured at the printer resolution.
+ */
+class PLEPrintRenderer
+{
+public:
+
+    explicit PLEPrintRenderer(QPrinter* printer);
+
+    /// Height of bands in printer pixels
+    void setBandHeight(int rows);
+
+    /// RGB profile of the printer, bands are converted from sRGB to it before they're sent
+    void setColorProfile(const PLEIccProfile& profile,
+                         PLEColorTransform::RenderingIntent intent = PLEColorTransform::Perceptual);
+
+    /** Prints pages, respecting page range selected for the printer.
+     * Every snapshot is printed at its resolution from the top left corner of the page.
+     */
+    bool print(const QList<PLESceneSnapshot>& pages);
+
+    QString errorString() const;
+
+private:
+
+    QPrinter*                          m_printer;
+    int                                m_band_height;
+    PLEIccProfile                      m_profile;
+    PLEColorTransform::RenderingIntent m_intent;
+    QString                            m_error;
+};
+
+} // namespace PhotoLayoutsEditor
+
+#endif // PLE_PRINT_RENDERER_H
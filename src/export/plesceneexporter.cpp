@@ -0,0 +1,375 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "plesceneexporter.h"
+
+// C++ includes
+
+#include <cmath>
+
+// Qt includes
+
+#include <QDebug>
+#include <QFileInfo>
+#include <QPainter>
+#include <QPageSize>
+#include <QPdfWriter>
+#include <QSaveFile>
+#include <QScopedPointer>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+// Local includes
+
+#include "plebandedwriter.h"
+#include "progressobserver.h"
+
+namespace PhotoLayoutsEditor
+{
+
+class PLESceneExporter::Private
+{
+public:
+
+    explicit Private(const PLESceneSnapshot& scene)
+        : snapshot(scene),
+          size((scene.sceneRect().size() * scene.resolution()).toSize()),
+          bandHeight(256),
+          dpi(72, 72),
+          intent(PLEColorTransform::Perceptual),
+          observer(nullptr),
+          cancelFlag(nullptr)
+    {
+    }
+
+    bool isCancelled() const
+    {
+        return (cancelFlag && cancelFlag->loadAcquire());
+    }
+
+    bool exportPdf(const QString& fileName);
+
+    PLESceneSnapshot                   snapshot;
+    PLESceneSnapshot                   previous;
+    QSize                              size;
+    int                                bandHeight;
+    QSizeF                             dpi;
+    PLEIccProfile                      profile;
+    PLEColorTransform::RenderingIntent intent;
+    ProgressObserver*                  observer;
+    const QAtomicInt*                  cancelFlag;
+    QString                            error;
+};
+
+bool PLESceneExporter::Private::exportPdf(const QString& fileName)
+{
+    // Page has physical size of the output image at its resolution
+    const QSizeF pageSize(size.width()  * 72.0 / dpi.width(),
+                          size.height() * 72.0 / dpi.height());
+
+    QSaveFile file(fileName);
+
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        error = file.errorString();
+        return false;
+    }
+
+    QPdfWriter writer(&file);
+    writer.setCreator(QLatin1String("Photo Layouts Editor"));
+    writer.setResolution(qRound(qMax(dpi.width(), dpi.height())));
+    writer.setPageSize(QPageSize(pageSize, QPageSize::Point));
+    writer.setPageMargins(QMarginsF());
+
+    QPainter p;
+
+    if (!p.begin(&writer))
+    {
+        error = QObject::tr("Can't create PDF file: %1").arg(fileName);
+        return false;
+    }
+
+    p.setRenderHints(QPainter::Antialiasing | QPainter::SmoothPixmapTransform);
+    snapshot.render(&p, QRectF(0, 0, writer.width(), writer.height()));
+
+    if (!p.end() || isCancelled())
+    {
+        error = isCancelled() ? QObject::tr("Export canceled") : QObject::tr("Can't create PDF file: %1").arg(fileName);
+        return false;
+    }
+
+    if (!file.commit())
+    {
+        error = file.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+PLESceneExporter::PLESceneExporter(const PLESceneSnapshot& snapshot)
+    : d(new Private(snapshot))
+{
+}
+
+PLESceneExporter::~PLESceneExporter()
+{
+    delete d;
+}
+
+void PLESceneExporter::setOutputSize(const QSize& size)
+{
+    d->size = size;
+}
+
+QSize PLESceneExporter::outputSize() const
+{
+    return d->size;
+}
+
+void PLESceneExporter::setBandHeight(int rows)
+{
+    d->bandHeight = qMax(1, rows);
+}
+
+void PLESceneExporter::setResolution(const QSizeF& dpi)
+{
+    d->dpi = dpi;
+}
+
+void PLESceneExporter::setColorProfile(const PLEIccProfile& profile, PLEColorTransform::RenderingIntent intent)
+{
+    d->profile = profile;
+    d->intent  = intent;
+}
+
+void PLESceneExporter::setPreviousSnapshot(const PLESceneSnapshot& previous)
+{
+    d->previous = previous;
+}
+
+void PLESceneExporter::setObserver(ProgressObserver* observer)
+{
+    d->observer = observer;
+}
+
+void PLESceneExporter::setCancelFlag(const QAtomicInt* flag)
+{
+    d->cancelFlag = flag;
+}
+
+QString PLESceneExporter::errorString() const
+{
+    return d->error;
+}
+
+QImage PLESceneExporter::renderBand(const QRect& area) const
+{
+    const QRectF sceneRect = d->snapshot.sceneRect();
+    const qreal xScale     = d->size.width()  / sceneRect.width();
+    const qreal yScale     = d->size.height() / sceneRect.height();
+
+    // Scene part visible in this band, only items intersecting it are painted
+    const QRectF source(sceneRect.left() + area.left() / xScale,
+                        sceneRect.top()  + area.top()  / yScale,
+                        area.width()  / xScale,
+                        area.height() / yScale);
+
+    QImage band(area.size(), QImage::Format_ARGB32_Premultiplied);
+    band.fill(Qt::transparent);
+
+    QPainter p(&band);
+    p.setRenderHints(QPainter::Antialiasing | QPainter::SmoothPixmapTransform);
+    d->snapshot.render(&p, QRectF(QPointF(0, 0), QSizeF(area.size())), source);
+    p.end();
+
+    return band;
+}
+
+bool PLESceneExporter::exportTo(const QString& fileName, const QByteArray& format)
+{
+    if (d->snapshot.isNull())
+    {
+        d->error = QObject::tr("Nothing to export");
+        return false;
+    }
+
+    if (format.toLower() == "pdf")
+    {
+        const bool result = d->exportPdf(fileName);
+
+        if (d->observer)
+            d->observer->progresChanged(1);
+
+        return result;
+    }
+
+    if (!d->profile.isNull() && d->profile.components() != 3)
+    {
+        d->error = QObject::tr("Color profile %1 can't be used for RGB images").arg(d->profile.description());
+        return false;
+    }
+
+    QScopedPointer<PLEBandedWriter> writer(PLEBandedWriter::create(format));
+
+    if (!writer)
+    {
+        d->error = QObject::tr("Unsupported image format: %1").arg(QString::fromLatin1(format));
+        return false;
+    }
+
+    writer->setResolution(d->dpi);
+    writer->setIccProfile(d->profile.data());
+
+    bool update = false;
+    int  top    = 0;
+    int  bottom = d->size.height();
+
+    // Rows which weren't changed since the previous export are kept in the file
+    if (!d->previous.isNull() && writer->canUpdate() && QFileInfo::exists(fileName))
+    {
+        if (writer->openForUpdate(fileName, d->size))
+        {
+            const QRectF sceneRect = d->snapshot.sceneRect();
+            const QRectF changed   = d->snapshot.changedRect(d->previous);
+            const qreal  yScale    = d->size.height() / sceneRect.height();
+            const int    rows      = qMax(1, writer->updateRows());
+            update                 = true;
+
+            if (changed.isEmpty())
+            {
+                bottom = 0;
+            }
+            else
+            {
+                // Antialiased edges reach pixels next to the changed area
+                top    = qMax(0, int(std::floor((changed.top() - sceneRect.top()) * yScale)) - 2);
+                bottom = qMin(d->size.height(), int(std::ceil((changed.bottom() - sceneRect.top()) * yScale)) + 2);
+                top    = top / rows * rows;
+                bottom = qMin(d->size.height(), (bottom + rows - 1) / rows * rows);
+            }
+
+            qDebug() << "Updating rows" << top << "-" << bottom << "of" << fileName;
+        }
+        else
+        {
+            qDebug() << "Can't update" << fileName << ":" << writer->errorString() << ", writing it again";
+        }
+    }
+
+    if (!update && (d->size.isEmpty() || !writer->open(fileName, d->size)))
+    {
+        d->error = writer->errorString();
+        return false;
+    }
+
+    bool result = writeBands(writer.data(), top, bottom, update);
+
+    // Cancelled or failed export leaves the file which existed before untouched
+    if      (!result)
+        writer->cancel();
+    else if (!writer->close())
+    {
+        result   = false;
+        d->error = writer->errorString();
+    }
+
+    if (d->observer)
+        d->observer->progresChanged(1);
+
+    return result;
+}
+
+bool PLESceneExporter::writeBands(PLEBandedWriter* const writer, int top, int bottom, bool replace)
+{
+    const PLEColorTransform transform = PLEColorTransform::transform(PLEIccProfile::sRGB(), d->profile, d->intent);
+    const int rows                    = (replace ? qMax(1, writer->updateRows()) : 1);
+    const int bandHeight              = (d->bandHeight + rows - 1) / rows * rows;
+    const int ahead                   = qMax(2, QThreadPool::globalInstance()->maxThreadCount());
+
+    // Bands are rendered in parallel a few ahead of the one being written, and they're written in order.
+    // Each band is encoded while the next one is waited for.
+    QList<QFuture<QImage> > rendered;
+    QFuture<bool> pending;
+    bool hasPending = false;
+    bool result     = true;
+    int  next       = top;
+
+    for (int y = top ; y < bottom ; y += bandHeight)
+    {
+        if (d->isCancelled())
+        {
+            d->error = QObject::tr("Export canceled");
+            result   = false;
+            break;
+        }
+
+        for ( ; next < bottom && rendered.count() < ahead ; next += bandHeight)
+        {
+            const QRect area(0, next, d->size.width(), qMin(bandHeight, bottom - next));
+
+            rendered << QtConcurrent::run([this, area, transform]()
+                {
+                    QImage band = renderBand(area);
+                    transform.apply(band);
+                    return band;
+                }
+            );
+        }
+
+        const QImage band = rendered.takeFirst().result();
+
+        if (hasPending && !pending.result())
+        {
+            hasPending = false;
+            result     = false;
+            d->error   = writer->errorString();
+            break;
+        }
+
+        if (replace)
+            pending = QtConcurrent::run(writer, &PLEBandedWriter::replaceBand, y, band);
+        else
+            pending = QtConcurrent::run(writer, &PLEBandedWriter::writeBand, band);
+
+        hasPending = true;
+
+        if (d->observer)
+            d->observer->progresChanged(double(y - top) / (bottom - top));
+    }
+
+    // Bands rendered ahead use the exporter, so they have to finish before it's deleted
+    foreach (QFuture<QImage> band, rendered)
+        band.waitForFinished();
+
+    if (hasPending && !pending.result())
+    {
+        result   = false;
+        d->error = writer->errorString();
+    }
+
+    return result;
+}
+
+} // namespace PhotoLayoutsEditor
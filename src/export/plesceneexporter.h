@@ -0,0 +1,104 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef PLE_SCENE_EXPORTER_H
+#define PLE_SCENE_EXPORTER_H
+
+// Qt includes
+
+#include <QAtomicInt>
+#include <QImage>
+#include <QString>
+#include <QSize>
+
+// Local includes
+
+#include "plecolortransform.h"
+#include "plescenesnapshot.h"
+
+namespace PhotoLayoutsEditor
+{
+
+class PLEBandedWriter;
+class ProgressObserver;
+
+/** Renders scene snapshot into image file band by band.
+ * A few bands are rendered in parallel and they're encoded in order while the next ones are rendered,
+ * so memory usage depends on the band size instead of the page size for streaming formats.
+ * PDF files are painted as a single page. Exporting doesn't touch the scene, so it may run in any thread.
+ */
+class PLESceneExporter
+{
+public:
+
+    explicit PLESceneExporter(const PLESceneSnapshot& snapshot);
+    ~PLESceneExporter();
+
+    /// Size of the output image in pixels, scene rect size by default
+    void setOutputSize(const QSize& size);
+    QSize outputSize() const;
+
+    /// Height of rendered bands in pixels
+    void setBandHeight(int rows);
+
+    /// Resolution written into the file, in dots per inch
+    void setResolution(const QSizeF& dpi);
+
+    /** RGB color profile of the output image, bands are converted from sRGB and the profile is embedded
+     * into the file. PDF files aren't converted.
+     */
+    void setColorProfile(const PLEIccProfile& profile,
+                         PLEColorTransform::RenderingIntent intent = PLEColorTransform::Perceptual);
+
+    /** Snapshot the existing output file was written from with the same settings. Formats which can be
+     * updated get only the rows changed since that snapshot re-rendered, other ones are written again.
+     */
+    void setPreviousSnapshot(const PLESceneSnapshot& previous);
+
+    void setObserver(ProgressObserver* observer);
+
+    /// Export is stopped as soon as the flag is set, may be set from other threads
+    void setCancelFlag(const QAtomicInt* flag);
+
+    bool exportTo(const QString& fileName, const QByteArray& format);
+    QString errorString() const;
+
+    /// Renders given part of the output image
+    QImage renderBand(const QRect& area) const;
+
+private:
+
+    /// Renders rows from top to bottom and writes or replaces them in the file
+    bool writeBands(PLEBandedWriter* const writer, int top, int bottom, bool replace);
+
+    PLESceneExporter(const PLESceneExporter&) = delete;
+    PLESceneExporter& operator=(const PLESceneExporter&) = delete;
+
+    class Private;
+    Private* const d;
+};
+
+} // namespace PhotoLayoutsEditor
+
+#endif // PLE_SCENE_EXPORTER_H
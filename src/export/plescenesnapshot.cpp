@@ -0,0 +1,947 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "plescenesnapshot.h"
+
+// C++ includes
+
+#include <climits>
+
+// Qt includes
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QFont>
+#include <QHash>
+#include <QImage>
+#include <QMetaProperty>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPaintDevice>
+#include <QPaintEngine>
+#include <QPainter>
+#include <QPainterPath>
+#include <QPen>
+#include <QStyleOptionGraphicsItem>
+#include <QVector>
+#include <QtConcurrent>
+#include <QtMath>
+
+// Local includes
+
+#include "plescene.h"
+#include "plescenebackground.h"
+#include "plesceneborder.h"
+#include "abstractphoto.h"
+#include "photoitem.h"
+#include "photoeffectsgroup.h"
+#include "abstractphotoeffectinterface.h"
+#include "bordersgroup.h"
+
+namespace PhotoLayoutsEditor
+{
+
+/// Clip operation with transformation of the painter it was set with
+struct PLESnapshotClip
+{
+    QTransform          transform;
+    QPainterPath        path;
+    Qt::ClipOperation   operation;
+};
+
+/// Painter state shared by the commands painted with it
+struct PLESnapshotState
+{
+    PLESnapshotState()
+        : opacity(1),
+          compositionMode(QPainter::CompositionMode_SourceOver),
+          clipEnabled(false)
+    {
+    }
+
+    QTransform                  transform;
+    QPen                        pen;
+    QBrush                      brush;
+    QPointF                     brushOrigin;
+    QFont                       font;
+    qreal                       opacity;
+    QPainter::CompositionMode   compositionMode;
+    QPainter::RenderHints       renderHints;
+    bool                        clipEnabled;
+    QVector<PLESnapshotClip>    clip;
+};
+
+struct PLESnapshotCommand
+{
+    enum Type
+    {
+        DrawPath,
+        StrokePath,
+        DrawImage,
+        DrawText,
+        DrawPhoto
+    };
+
+    PLESnapshotCommand()
+        : type(DrawPath),
+          state(0),
+          item(0),
+          flags(Qt::AutoColor),
+          photo(-1)
+    {
+    }
+
+    Type                        type;
+    int                         state;
+    int                         item;
+    QPainterPath                path;
+    QRectF                      rect;
+    QRectF                      sourceRect;
+    QImage                      image;
+    Qt::ImageConversionFlags    flags;
+    QPointF                     point;
+    QString                     text;
+    int                         photo;
+};
+
+class PLESceneSnapshot::Private : public QSharedData
+{
+public:
+
+    Private()
+        : resolution(1)
+    {
+    }
+
+    Private(const Private& other)
+        : QSharedData(other),
+          sceneRect(other.sceneRect),
+          resolution(other.resolution),
+          states(other.states),
+          commands(other.commands),
+          itemRects(other.itemRects),
+          itemHashes(other.itemHashes),
+          items(other.items),
+          hash(other.hash),
+          photos(other.photos)
+    {
+        QMutexLocker locker(&other.photosMutex);
+        photoImages = other.photoImages;
+    }
+
+    /** Renders images of the photos painted in the source rect which weren't rendered yet.
+     * Photos are rendered in parallel, other threads rendering the snapshot meanwhile wait for them.
+     */
+    void renderPhotos(const QRectF& source) const
+    {
+        QMutexLocker locker(&photosMutex);
+        QVector<int> pending;
+
+        foreach (const PLESnapshotCommand& command, commands)
+        {
+            if (command.type == PLESnapshotCommand::DrawPhoto && photoImages.at(command.photo).isNull() &&
+                itemRects.at(command.item).intersects(source))
+            {
+                pending << command.photo;
+            }
+        }
+
+        if (pending.isEmpty())
+            return;
+
+        const PhotoItemFill* const fills = photos.constData();
+        QImage* const images             = photoImages.data();
+
+        QtConcurrent::blockingMap(pending, [fills, images](int index)
+            {
+                images[index] = fills[index].render();
+            }
+        );
+    }
+
+    QRectF                      sceneRect;
+    qreal                       resolution;
+    QVector<PLESnapshotState>   states;
+    QVector<PLESnapshotCommand> commands;
+    QVector<QRectF>             itemRects;
+    QVector<QByteArray>         itemHashes;
+    QList<ItemInfo>             items;
+    QByteArray                  hash;
+
+    // Photos are recorded with their effects and rendered by the first render() which paints them,
+    // so the GUI thread only copies their parameters
+    QVector<PhotoItemFill>      photos;
+    mutable QVector<QImage>     photoImages;
+    mutable QMutex              photosMutex;
+};
+
+// ---------------------------------------------------------------------
+
+/** Paint engine storing painted commands into the snapshot.
+ * Pixmaps are converted to images, so the recorded commands can be replayed outside of the GUI thread.
+ */
+class PLESceneRecorder : public QPaintEngine
+{
+public:
+
+    explicit PLESceneRecorder(PLESceneSnapshot::Private* const data)
+        : QPaintEngine(QPaintEngine::AllFeatures),
+          m_data(data),
+          m_item(0),
+          m_state_changed(true)
+    {
+    }
+
+    using QPaintEngine::drawRects;
+    using QPaintEngine::drawLines;
+    using QPaintEngine::drawEllipse;
+    using QPaintEngine::drawPolygon;
+
+    void setItem(int item)
+    {
+        m_item = item;
+    }
+
+    bool begin(QPaintDevice* /*device*/) override
+    {
+        return true;
+    }
+
+    bool end() override
+    {
+        return true;
+    }
+
+    QPaintEngine::Type type() const override
+    {
+        return QPaintEngine::User;
+    }
+
+    void updateState(const QPaintEngineState& state) override
+    {
+        const QPaintEngine::DirtyFlags flags = state.state();
+
+        // Transformation goes first, clipping is specified in its coordinates
+        if (flags & QPaintEngine::DirtyTransform)
+            m_state.transform = state.transform();
+
+        if (flags & QPaintEngine::DirtyPen)
+        {
+            QPen pen = state.pen();
+            pen.setBrush(threadSafeBrush(pen.brush()));
+            m_state.pen = pen;
+        }
+
+        if (flags & QPaintEngine::DirtyBrush)
+            m_state.brush = threadSafeBrush(state.brush());
+
+        if (flags & QPaintEngine::DirtyBrushOrigin)
+            m_state.brushOrigin = state.brushOrigin();
+
+        if (flags & QPaintEngine::DirtyFont)
+            m_state.font = state.font();
+
+        if (flags & QPaintEngine::DirtyOpacity)
+            m_state.opacity = state.opacity();
+
+        if (flags & QPaintEngine::DirtyCompositionMode)
+            m_state.compositionMode = state.compositionMode();
+
+        if (flags & QPaintEngine::DirtyHints)
+            m_state.renderHints = state.renderHints();
+
+        if (flags & QPaintEngine::DirtyClipEnabled)
+            m_state.clipEnabled = state.isClipEnabled();
+
+        if (flags & QPaintEngine::DirtyClipRegion)
+        {
+            QPainterPath path;
+            path.addRegion(state.clipRegion());
+            addClip(path, state.clipOperation());
+        }
+
+        if (flags & QPaintEngine::DirtyClipPath)
+            addClip(state.clipPath(), state.clipOperation());
+
+        m_state_changed = true;
+    }
+
+    void drawPath(const QPainterPath& path) override
+    {
+        PLESnapshotCommand command = newCommand(PLESnapshotCommand::DrawPath);
+        command.path               = path;
+        m_data->commands << command;
+    }
+
+    void drawRects(const QRectF* rects, int rectCount) override
+    {
+        PLESnapshotCommand command = newCommand(PLESnapshotCommand::DrawPath);
+
+        for (int i = 0 ; i < rectCount ; ++i)
+            command.path.addRect(rects[i]);
+
+        m_data->commands << command;
+    }
+
+    void drawLines(const QLineF* lines, int lineCount) override
+    {
+        PLESnapshotCommand command = newCommand(PLESnapshotCommand::StrokePath);
+
+        for (int i = 0 ; i < lineCount ; ++i)
+        {
+            command.path.moveTo(lines[i].p1());
+            command.path.lineTo(lines[i].p2());
+        }
+
+        m_data->commands << command;
+    }
+
+    void drawEllipse(const QRectF& rect) override
+    {
+        PLESnapshotCommand command = newCommand(PLESnapshotCommand::DrawPath);
+        command.path.addEllipse(rect);
+        m_data->commands << command;
+    }
+
+    void drawPolygon(const QPointF* points, int pointCount, PolygonDrawMode mode) override
+    {
+        if (pointCount < 1)
+            return;
+
+        PLESnapshotCommand command = newCommand(mode == QPaintEngine::PolylineMode ? PLESnapshotCommand::StrokePath
+                                                                                   : PLESnapshotCommand::DrawPath);
+        command.path.moveTo(points[0]);
+
+        for (int i = 1 ; i < pointCount ; ++i)
+            command.path.lineTo(points[i]);
+
+        if (mode != QPaintEngine::PolylineMode)
+        {
+            command.path.closeSubpath();
+            command.path.setFillRule(mode == QPaintEngine::OddEvenMode ? Qt::OddEvenFill : Qt::WindingFill);
+        }
+
+        m_data->commands << command;
+    }
+
+    void drawPixmap(const QRectF& rect, const QPixmap& pixmap, const QRectF& sourceRect) override
+    {
+        drawImage(rect, pixmap.toImage(), sourceRect, Qt::AutoColor);
+    }
+
+    void drawImage(const QRectF& rect, const QImage& image, const QRectF& sourceRect, Qt::ImageConversionFlags flags) override
+    {
+        PLESnapshotCommand command = newCommand(PLESnapshotCommand::DrawImage);
+        command.rect               = rect;
+        command.image              = image;
+        command.sourceRect         = sourceRect;
+        command.flags              = flags;
+        m_data->commands << command;
+    }
+
+    void drawTextItem(const QPointF& point, const QTextItem& textItem) override
+    {
+        PLESnapshotCommand command = newCommand(PLESnapshotCommand::DrawText);
+        command.point              = point;
+        command.text               = textItem.text();
+        m_data->commands << command;
+    }
+
+    /// Image of the photo filled into its area with the current state, it's rendered later by the snapshot
+    void drawPhoto(const PhotoItemFill& fill)
+    {
+        PLESnapshotCommand command = newCommand(PLESnapshotCommand::DrawPhoto);
+        command.path               = fill.area;
+        command.photo              = m_data->photos.count();
+        m_data->photos            << fill;
+        m_data->photoImages       << QImage();
+        m_data->commands          << command;
+    }
+
+private:
+
+    PLESnapshotCommand newCommand(PLESnapshotCommand::Type type)
+    {
+        if (m_state_changed)
+        {
+            m_data->states << m_state;
+            m_state_changed = false;
+        }
+
+        PLESnapshotCommand command;
+        command.type  = type;
+        command.state = m_data->states.count() - 1;
+        command.item  = m_item;
+
+        return command;
+    }
+
+    void addClip(const QPainterPath& path, Qt::ClipOperation operation)
+    {
+        if (operation == Qt::NoClip)
+        {
+            m_state.clip.clear();
+            m_state.clipEnabled = false;
+            return;
+        }
+
+        if (operation == Qt::ReplaceClip)
+            m_state.clip.clear();
+
+        PLESnapshotClip clip;
+        clip.transform      = m_state.transform;
+        clip.path           = path;
+        clip.operation      = operation;
+        m_state.clip       << clip;
+        m_state.clipEnabled = true;
+    }
+
+    /// Pixmap textures can't be used outside of the GUI thread
+    static QBrush threadSafeBrush(const QBrush& brush)
+    {
+        if (brush.style() != Qt::TexturePattern)
+            return brush;
+
+        QBrush result(brush.textureImage());
+        result.setTransform(brush.transform());
+
+        return result;
+    }
+
+private:
+
+    PLESceneSnapshot::Private* m_data;
+    PLESnapshotState           m_state;
+    int                        m_item;
+    bool                       m_state_changed;
+};
+
+// ---------------------------------------------------------------------
+
+class PLESceneRecordingDevice : public QPaintDevice
+{
+public:
+
+    PLESceneRecordingDevice(PLESceneRecorder* const recorder, const QSize& size)
+        : m_engine(recorder),
+          m_size(size)
+    {
+        // Same resolution as the images snapshot is usually rendered on
+        QImage probe(1, 1, QImage::Format_ARGB32_Premultiplied);
+        m_dpi_x = probe.logicalDpiX();
+        m_dpi_y = probe.logicalDpiY();
+    }
+
+    ~PLESceneRecordingDevice() override
+    {
+    }
+
+    QPaintEngine* paintEngine() const override
+    {
+        return m_engine;
+    }
+
+protected:
+
+    int metric(PaintDeviceMetric id) const override
+    {
+        switch (id)
+        {
+            case PdmWidth:
+                return m_size.width();
+
+            case PdmHeight:
+                return m_size.height();
+
+            case PdmWidthMM:
+                return qRound(m_size.width() * 25.4 / m_dpi_x);
+
+            case PdmHeightMM:
+                return qRound(m_size.height() * 25.4 / m_dpi_y);
+
+            case PdmNumColors:
+                return INT_MAX;
+
+            case PdmDepth:
+                return 32;
+
+            case PdmDpiX:
+            case PdmPhysicalDpiX:
+                return m_dpi_x;
+
+            case PdmDpiY:
+            case PdmPhysicalDpiY:
+                return m_dpi_y;
+
+            case PdmDevicePixelRatio:
+                return 1;
+
+            case PdmDevicePixelRatioScaled:
+                return qRound(devicePixelRatioFScale());
+
+            default:
+                return QPaintDevice::metric(id);
+        }
+    }
+
+private:
+
+    PLESceneRecorder* m_engine;
+    QSize             m_size;
+    int               m_dpi_x;
+    int               m_dpi_y;
+};
+
+// ---------------------------------------------------------------------
+
+static PLESceneSnapshot::ItemInfo describeItem(QGraphicsItem* const item)
+{
+    PLESceneSnapshot::ItemInfo info;
+    info.sceneTransform    = item->sceneTransform();
+    info.zValue            = item->zValue();
+    info.opacity           = item->effectiveOpacity();
+    info.sceneBoundingRect = item->sceneBoundingRect();
+    info.shape             = item->shape();
+
+    if (QObject* const object = dynamic_cast<QObject*>(item))
+        info.className = QString::fromLatin1(object->metaObject()->className());
+
+    AbstractPhoto* const photo = dynamic_cast<AbstractPhoto*>(item);
+
+    if (!photo)
+        return info;
+
+    info.name      = photo->name();
+    info.cropShape = photo->cropShape();
+
+    if (PhotoItem* const photoItem = dynamic_cast<PhotoItem*>(photo))
+    {
+        info.image    = photoItem->image();
+        info.imageUrl = photoItem->imageUrl();
+    }
+
+    PhotoEffectsGroup* const effects = photo->effectsGroup();
+
+    if (!effects)
+        return info;
+
+    for (int row = 0 ; row < effects->rowCount() ; ++row)
+    {
+        AbstractPhotoEffectInterface* const effect = qobject_cast<AbstractPhotoEffectInterface*>(effects->item(effects->index(row, 0)));
+
+        if (!effect)
+            continue;
+
+        PLESceneSnapshot::EffectInfo effectInfo;
+        const QMetaObject* const meta = effect->metaObject();
+        effectInfo.className          = QString::fromLatin1(meta->className());
+
+        for (int i = 0 ; i < meta->propertyCount() ; ++i)
+        {
+            QMetaProperty p = meta->property(i);
+            effectInfo.properties.insert(QString::fromLatin1(p.name()), p.read(effect));
+        }
+
+        info.effects << effectInfo;
+    }
+
+    return info;
+}
+
+static void hashBrush(QDataStream& stream, const QBrush& brush)
+{
+    // Streaming texture would encode whole image, its cache key changes with the content as well
+    if (brush.style() == Qt::TexturePattern)
+        stream << int(brush.style()) << brush.transform() << brush.textureImage().cacheKey();
+    else
+        stream << brush;
+}
+
+static void hashState(QDataStream& stream, const PLESnapshotState& state)
+{
+    stream << state.transform
+           << int(state.pen.style()) << state.pen.widthF() << int(state.pen.capStyle())
+           << int(state.pen.joinStyle()) << state.pen.isCosmetic() << state.pen.dashPattern();
+    hashBrush(stream, state.pen.brush());
+    hashBrush(stream, state.brush);
+    stream << state.brushOrigin << state.font << state.opacity << int(state.compositionMode)
+           << int(state.renderHints) << state.clipEnabled;
+
+    foreach (const PLESnapshotClip& clip, state.clip)
+        stream << clip.transform << clip.path << int(clip.operation);
+}
+
+/// Photo is hashed by its parameters, its image isn't rendered yet
+static void hashPhoto(QDataStream& stream, const PhotoItemFill& fill)
+{
+    stream << fill.source.cacheKey() << fill.size << fill.scale << fill.brushTransform;
+
+    foreach (const PhotoEffectsChain::Effect& effect, fill.effects.effects)
+    {
+        stream << effect.className;
+
+        for (int i = 0 ; i < effect.properties.count() ; ++i)
+            stream << effect.properties.at(i).first << effect.properties.at(i).second;
+    }
+}
+
+/// Hashes of the painted items, states are hashed by value so hashes don't depend on other items
+static QVector<QByteArray> hashItems(const QVector<QRectF>& itemRects,
+                                     const QVector<PLESnapshotState>& states,
+                                     const QVector<PLESnapshotCommand>& commands,
+                                     const QVector<PhotoItemFill>& photos)
+{
+    QVector<QByteArray> data(itemRects.count());
+    QVector<int>        lastStates(itemRects.count(), -1);
+
+    for (int i = 0 ; i < itemRects.count() ; ++i)
+    {
+        QDataStream stream(&data[i], QIODevice::WriteOnly);
+        stream << itemRects.at(i);
+    }
+
+    foreach (const PLESnapshotCommand& command, commands)
+    {
+        QDataStream stream(&data[command.item], QIODevice::Append);
+
+        if (lastStates.at(command.item) != command.state)
+        {
+            lastStates[command.item] = command.state;
+            hashState(stream, states.at(command.state));
+        }
+
+        stream << int(command.type) << command.path << command.rect << command.sourceRect
+               << command.image.cacheKey() << int(command.flags) << command.point << command.text;
+
+        if (command.type == PLESnapshotCommand::DrawPhoto)
+            hashPhoto(stream, photos.at(command.photo));
+    }
+
+    for (int i = 0 ; i < data.count() ; ++i)
+        data[i] = QCryptographicHash::hash(data.at(i), QCryptographicHash::Md5);
+
+    return data;
+}
+
+static QByteArray hashSnapshot(const QRectF& sceneRect, const QVector<QByteArray>& itemHashes)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+
+    stream << sceneRect;
+
+    foreach (const QByteArray& hash, itemHashes)
+        data.append(hash);
+
+    return QCryptographicHash::hash(data, QCryptographicHash::Md5);
+}
+
+// ---------------------------------------------------------------------
+
+PLESceneSnapshot::PLESceneSnapshot()
+    : d(new Private)
+{
+}
+
+PLESceneSnapshot::PLESceneSnapshot(const PLESceneSnapshot& other)
+    : d(other.d)
+{
+}
+
+PLESceneSnapshot::~PLESceneSnapshot()
+{
+}
+
+PLESceneSnapshot& PLESceneSnapshot::operator=(const PLESceneSnapshot& other)
+{
+    d = other.d;
+    return *this;
+}
+
+PLESceneSnapshot PLESceneSnapshot::capture(PLEScene* const scene, qreal resolution)
+{
+    PLESceneSnapshot snapshot;
+
+    if (!scene || resolution <= 0)
+        return snapshot;
+
+    Private* const data = snapshot.d.data();
+    data->sceneRect     = scene->sceneRect();
+    data->resolution    = resolution;
+
+    PLESceneRecorder recorder(data);
+    PLESceneRecordingDevice device(&recorder, (data->sceneRect.size() * resolution).toSize());
+    QPainter painter(&device);
+
+    // Items are painted from the bottom one, as QGraphicsScene::render() does
+    const QList<QGraphicsItem*> items = scene->items(Qt::AscendingOrder);
+
+    foreach (QGraphicsItem* const item, items)
+    {
+        if (!item->isVisible())
+            continue;
+
+        if (!dynamic_cast<AbstractPhoto*>(item)       &&
+            !dynamic_cast<PLESceneBackground*>(item)  &&
+            !dynamic_cast<PLESceneBorder*>(item))
+        {
+            continue;
+        }
+
+        recorder.setItem(data->itemRects.count());
+        data->itemRects << item->sceneBoundingRect();
+        data->items     << describeItem(item);
+
+        QStyleOptionGraphicsItem option;
+        option.exposedRect = item->boundingRect();
+        option.rect        = option.exposedRect.toAlignedRect();
+
+        painter.save();
+        painter.setRenderHints(QPainter::Antialiasing | QPainter::SmoothPixmapTransform);
+        painter.setTransform(item->sceneTransform() * QTransform::fromScale(resolution, resolution));
+        painter.setOpacity(item->effectiveOpacity());
+
+        PhotoItem* const photo = dynamic_cast<PhotoItem*>(item);
+
+        // Photo with its effects is rendered with the snapshot, empty photos are only placeholders
+        if (photo && !photo->isEmpty())
+        {
+            recorder.drawPhoto(photo->imageFill(qSqrt(qAbs(painter.worldTransform().determinant()))));
+
+            if (photo->bordersGroup())
+                photo->bordersGroup()->paint(&painter, &option);
+        }
+        else
+        {
+            item->paint(&painter, &option, nullptr);
+        }
+
+        painter.restore();
+    }
+
+    painter.end();
+
+    data->itemHashes = hashItems(data->itemRects, data->states, data->commands, data->photos);
+    data->hash       = hashSnapshot(data->sceneRect, data->itemHashes);
+
+    return snapshot;
+}
+
+bool PLESceneSnapshot::isNull() const
+{
+    return d->sceneRect.isEmpty();
+}
+
+QRectF PLESceneSnapshot::sceneRect() const
+{
+    return d->sceneRect;
+}
+
+qreal PLESceneSnapshot::resolution() const
+{
+    return d->resolution;
+}
+
+QList<PLESceneSnapshot::ItemInfo> PLESceneSnapshot::items() const
+{
+    return d->items;
+}
+
+QByteArray PLESceneSnapshot::contentHash() const
+{
+    return d->hash;
+}
+
+QRectF PLESceneSnapshot::changedRect(const PLESceneSnapshot& previous) const
+{
+    if (d->sceneRect != previous.d->sceneRect || !qFuzzyCompare(d->resolution, previous.d->resolution))
+        return d->sceneRect;
+
+    // Items are matched by their hashes, unmatched ones were added, removed or changed
+    QRectF result;
+    QHash<QByteArray, QRectF> rects;
+    QHash<QByteArray, int>    available;
+
+    for (int i = 0 ; i < previous.d->itemHashes.count() ; ++i)
+        ++available[previous.d->itemHashes.at(i)];
+
+    QList<QByteArray> matched;
+
+    for (int i = 0 ; i < d->itemHashes.count() ; ++i)
+    {
+        const QByteArray& hash = d->itemHashes.at(i);
+        rects.insert(hash, d->itemRects.at(i));
+
+        if (available.value(hash) > 0)
+        {
+            --available[hash];
+            matched << hash;
+        }
+        else
+        {
+            result |= d->itemRects.at(i);
+        }
+    }
+
+    QList<QByteArray> previousMatched;
+
+    for (int i = 0 ; i < previous.d->itemHashes.count() ; ++i)
+    {
+        const QByteArray& hash = previous.d->itemHashes.at(i);
+
+        if (available.value(hash) > 0)
+        {
+            --available[hash];
+            result |= previous.d->itemRects.at(i);
+        }
+        else
+        {
+            previousMatched << hash;
+        }
+    }
+
+    // Unchanged items which changed their stacking order
+    for (int i = 0 ; i < matched.count() ; ++i)
+    {
+        if (matched.at(i) != previousMatched.at(i))
+            result |= rects.value(matched.at(i)) | rects.value(previousMatched.at(i));
+    }
+
+    return result & d->sceneRect;
+}
+
+PLESceneSnapshot PLESceneSnapshot::outline() const
+{
+    PLESceneSnapshot result;
+    result.d->sceneRect  = d->sceneRect;
+    result.d->resolution = d->resolution;
+    result.d->itemRects  = d->itemRects;
+    result.d->itemHashes = d->itemHashes;
+    result.d->hash       = d->hash;
+
+    return result;
+}
+
+void PLESceneSnapshot::render(QPainter* painter, const QRectF& target, const QRectF& source) const
+{
+    if (isNull() || !painter || !painter->device())
+        return;
+
+    const QRectF sourceRect = (source.isNull() ? d->sceneRect : source);
+    const QRectF targetRect = (target.isNull() ? QRectF(0, 0, painter->device()->width(), painter->device()->height())
+                                               : target);
+
+    if (sourceRect.isEmpty() || targetRect.isEmpty())
+        return;
+
+    // Photos are rendered once, by the first render() which paints them
+    d->renderPhotos(sourceRect);
+
+    painter->save();
+
+    // Maps recorded device coordinates into the target rect
+    const QTransform deviceTransform = painter->worldTransform();
+    const QTransform base            = QTransform::fromScale(1.0 / d->resolution, 1.0 / d->resolution)   *
+                                       QTransform::fromTranslate(-sourceRect.left(), -sourceRect.top())   *
+                                       QTransform::fromScale(targetRect.width()  / sourceRect.width(),
+                                                             targetRect.height() / sourceRect.height())  *
+                                       QTransform::fromTranslate(targetRect.left(), targetRect.top())     *
+                                       deviceTransform;
+    const qreal opacity              = painter->opacity();
+    int current                      = -1;
+
+    // Rendering is limited to the target rect and to the clipping the painter already has
+    QPainterPath area;
+    area.addRect(targetRect);
+    area = deviceTransform.map(area);
+
+    if (painter->hasClipping())
+        area = area.intersected(deviceTransform.map(painter->clipPath()));
+
+    foreach (const PLESnapshotCommand& command, d->commands)
+    {
+        if (!d->itemRects.at(command.item).intersects(sourceRect))
+            continue;
+
+        if (command.state != current)
+        {
+            const PLESnapshotState& state = d->states.at(command.state);
+            current                       = command.state;
+
+            // Recorded clip replaces clipping of the painter, so it's always limited to the rendered area
+            painter->setTransform(QTransform());
+            painter->setClipPath(area, Qt::ReplaceClip);
+
+            if (state.clipEnabled)
+            {
+                foreach (const PLESnapshotClip& clip, state.clip)
+                {
+                    painter->setTransform(clip.transform * base);
+                    painter->setClipPath(clip.path, clip.operation == Qt::ReplaceClip ? Qt::IntersectClip : clip.operation);
+                }
+            }
+
+            painter->setTransform(state.transform * base);
+            painter->setPen(state.pen);
+            painter->setBrush(state.brush);
+            painter->setBrushOrigin(state.brushOrigin);
+            painter->setFont(state.font);
+            painter->setOpacity(opacity * state.opacity);
+            painter->setCompositionMode(state.compositionMode);
+            painter->setRenderHints(painter->renderHints(), false);
+            painter->setRenderHints(state.renderHints);
+        }
+
+        switch (command.type)
+        {
+            case PLESnapshotCommand::DrawPath:
+                painter->drawPath(command.path);
+                break;
+
+            case PLESnapshotCommand::StrokePath:
+                painter->strokePath(command.path, painter->pen());
+                break;
+
+            case PLESnapshotCommand::DrawImage:
+                painter->drawImage(command.rect, command.image, command.sourceRect, command.flags);
+                break;
+
+            case PLESnapshotCommand::DrawText:
+                painter->drawText(command.point, command.text);
+                break;
+
+            case PLESnapshotCommand::DrawPhoto:
+            {
+                QBrush brush(d->photoImages.at(command.photo));
+                brush.setTransform(d->photos.at(command.photo).brushTransform);
+                painter->fillPath(command.path, brush);
+                break;
+            }
+        }
+    }
+
+    painter->restore();
+}
+
+} // namespace PhotoLayoutsEditor
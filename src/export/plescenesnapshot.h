@@ -0,0 +1,136 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef PLE_SCENE_SNAPSHOT_H
+#define PLE_SCENE_SNAPSHOT_H
+
+// Qt includes
+
+#include <QByteArray>
+#include <QImage>
+#include <QList>
+#include <QPainterPath>
+#include <QRectF>
+#include <QSharedDataPointer>
+#include <QString>
+#include <QTransform>
+#include <QUrl>
+#include <QVariantMap>
+
+class QPainter;
+
+namespace PhotoLayoutsEditor
+{
+
+class PLEScene;
+
+/** Immutable copy of the scene content.
+ * Items are recorded on the GUI thread as a list of painting commands which refer to
+ * implicitly shared images, so capturing doesn't copy pixels and the snapshot can be
+ * rendered from any thread while the scene is being edited. Effects of the photos are
+ * applied by the first render() which paints them, not on the GUI thread.
+ * Copies of the snapshot share the recorded data.
+ */
+class PLESceneSnapshot
+{
+public:
+
+    /// Effect of the photo, stored by its class name and values of its properties
+    struct EffectInfo
+    {
+        QString     className;
+        QVariantMap properties;
+    };
+
+    /** Description of the captured item.
+     * Image is the original (not scaled and without effects) image of the photo item and shares
+     * its pixels with the item, so it's valid also when the item is edited or removed later.
+     */
+    struct ItemInfo
+    {
+        ItemInfo()
+            : zValue(0),
+              opacity(1)
+        {
+        }
+
+        QString             className;
+        QString             name;
+        QTransform          sceneTransform;
+        qreal               zValue;
+        qreal               opacity;
+        QRectF              sceneBoundingRect;
+        QPainterPath        shape;
+        QPainterPath        cropShape;
+        QImage              image;
+        QUrl                imageUrl;
+        QList<EffectInfo>   effects;
+    };
+
+    PLESceneSnapshot();
+    PLESceneSnapshot(const PLESceneSnapshot& other);
+    ~PLESceneSnapshot();
+
+    PLESceneSnapshot& operator=(const PLESceneSnapshot& other);
+
+    /** Records content of the scene, editing widgets, grid and selection aren't captured.
+     * Resolution is the number of output pixels per scene unit the snapshot will be rendered at,
+     * items use it to choose resolution of recorded images.
+     */
+    static PLESceneSnapshot capture(PLEScene* const scene, qreal resolution = 1.0);
+
+    bool isNull() const;
+    QRectF sceneRect() const;
+    qreal resolution() const;
+
+    /// Captured items from the bottom one
+    QList<ItemInfo> items() const;
+
+    /// Hash of the recorded content, equal for snapshots of the same unchanged scene
+    QByteArray contentHash() const;
+
+    /** Returns bounding rect of the scene parts which are painted differently than in the previous
+     * snapshot of the same scene, whole scene rect if the snapshots differ in their rect or resolution.
+     */
+    QRectF changedRect(const PLESceneSnapshot& previous) const;
+
+    /** Copy keeping only what changedRect() and contentHash() compare, so it's small enough
+     * to be kept for every written file. It can't be rendered, it paints nothing.
+     */
+    PLESceneSnapshot outline() const;
+
+    /// Paints source part of the scene into target rect of the painter, may be called from several threads at once
+    void render(QPainter* painter, const QRectF& target = QRectF(), const QRectF& source = QRectF()) const;
+
+private:
+
+    class Private;
+    QSharedDataPointer<Private> d;
+
+    friend class PLESceneRecorder;
+};
+
+} // namespace PhotoLayoutsEditor
+
+#endif // PLE_SCENE_SNAPSHOT_H
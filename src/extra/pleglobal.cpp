@@ -55,9 +55,41 @@ QString templateUri()
 
 void PLE_PostUndoCommand(QUndoCommand* const command)
 {
+    // Without the editor window (e.g. in batch rendering) there is no undo stack
+    if (!PLEWindow::hasInstance())
+    {
+        command->redo();
+        delete command;
+        return;
+    }
+
     PLEWindow::instance()->addUndoCommand(command);
 }
 
+void PLE_BeginUndoCommandGroup(const QString& name)
+{
+    if (PLEWindow::hasInstance())
+        PLEWindow::instance()->beginUndoCommandGroup(name);
+}
+
+void PLE_EndUndoCommandGroup()
+{
+    if (PLEWindow::hasInstance())
+        PLEWindow::instance()->endUndoCommandGroup();
+}
+
+void PLE_PostProgressEvent(QEvent* const event)
+{
+    // Progress is shown by the editor window only, it must not be created by threads posting the events
+    if (!PLEWindow::hasInstance())
+    {
+        delete event;
+        return;
+    }
+
+    QCoreApplication::postEvent(PLEWindow::instance(), event);
+}
+
 QDomDocument pathToSvg(const QPainterPath& path)
 {
     QDomDocument document;
@@ -229,4 +261,35 @@ QPainterPath pathFromSvg(const QDomElement& element)
     return result;
 }
 
+bool pathIsRect(const QPainterPath& path, QRectF* rect)
+{
+    // Rectangle is a closed polygon of four axis-aligned edges joining corners of its bounding rect
+    const int count = path.elementCount();
+
+    if (count != 4 && count != 5)
+        return false;
+
+    const QRectF bounds = path.boundingRect();
+
+    for (int i = 0 ; i < count ; ++i)
+    {
+        const QPainterPath::Element e    = path.elementAt(i);
+        const QPainterPath::Element next = path.elementAt((i + 1) % count);
+
+        if ((i == 0) ? !e.isMoveTo() : !e.isLineTo())
+            return false;
+
+        if ((e.x != bounds.left() && e.x != bounds.right()) || (e.y != bounds.top() && e.y != bounds.bottom()))
+            return false;
+
+        if (e.x != next.x && e.y != next.y)
+            return false;
+    }
+
+    if (rect)
+        *rect = bounds;
+
+    return true;
+}
+
 } // namespace PhotoLayoutsEditor
@@ -34,6 +34,8 @@
 #include <QDomDocument>
 #include <QPainterPath>
 
+class QEvent;
+
 namespace PhotoLayoutsEditor
 {
 
@@ -41,9 +43,15 @@ extern QString name();
 extern QString uri();
 extern QString templateUri();
 extern void PLE_PostUndoCommand(QUndoCommand* const command);
+extern void PLE_BeginUndoCommandGroup(const QString& name);
+extern void PLE_EndUndoCommandGroup();
+extern void PLE_PostProgressEvent(QEvent* const event);
 extern QDomDocument pathToSvg(const QPainterPath& path);
 extern QPainterPath pathFromSvg(const QDomElement& element);
 
+/// Returns true if the path is a single axis-aligned rectangle, the rectangle is written to rect
+extern bool pathIsRect(const QPainterPath& path, QRectF* rect);
+
 } // namespace PhotoLayoutsEditor
 
 #endif // PLE_GLOBAL_H
@@ -0,0 +1,228 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "plesvgimagestore.h"
+
+// Qt includes
+
+#include <QBuffer>
+#include <QByteArray>
+#include <QDomNamedNodeMap>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+
+// Local includes
+
+#include "progressobserver.h"
+
+namespace PhotoLayoutsEditor
+{
+
+// Each thread serializing a scene has its own active store
+static thread_local PLESvgImageStore* s_active_store = nullptr;
+
+// Shared stores are read by loading threads
+static QList<const PLESvgImageStore*> s_shared_stores;
+static QMutex                         s_shared_mutex;
+
+static QString placeholderPrefix()
+{
+    return QLatin1String("ple-image:");
+}
+
+PLESvgImageStore::PLESvgImageStore()
+    : m_internal(false)
+{
+}
+
+PLESvgImageStore::~PLESvgImageStore()
+{
+    end();
+    unshare();
+}
+
+void PLESvgImageStore::begin()
+{
+    s_active_store = this;
+}
+
+void PLESvgImageStore::end()
+{
+    if (s_active_store == this)
+        s_active_store = nullptr;
+}
+
+QString PLESvgImageStore::svgImageData(const QImage& image)
+{
+    if (!s_active_store || image.isNull())
+        return encode(image);
+
+    const QString key = placeholderPrefix() + QString::number(image.cacheKey());
+
+    // Store may be shared with loading threads already
+    QMutexLocker locker(&s_shared_mutex);
+    s_active_store->m_images.insert(key, image);
+
+    return key;
+}
+
+void PLESvgImageStore::setInternalCopy(bool internal)
+{
+    m_internal = internal;
+}
+
+bool PLESvgImageStore::isInternalCopy()
+{
+    return (s_active_store && s_active_store->m_internal);
+}
+
+void PLESvgImageStore::share()
+{
+    QMutexLocker locker(&s_shared_mutex);
+
+    if (!s_shared_stores.contains(this))
+        s_shared_stores << this;
+}
+
+void PLESvgImageStore::unshare()
+{
+    QMutexLocker locker(&s_shared_mutex);
+    s_shared_stores.removeAll(this);
+}
+
+QImage PLESvgImageStore::svgImage(const QString& data)
+{
+    const QString key = data.trimmed();
+
+    if (!key.startsWith(placeholderPrefix()))
+        return QImage::fromData(QByteArray::fromBase64(key.toLatin1()));
+
+    QMutexLocker locker(&s_shared_mutex);
+
+    foreach (const PLESvgImageStore* const store, s_shared_stores)
+    {
+        QMap<QString, QImage>::const_iterator it = store->m_images.constFind(key);
+
+        if (it != store->m_images.constEnd())
+            return it.value();
+    }
+
+    return QImage();
+}
+
+bool PLESvgImageStore::isPlaceholder(const QString& data)
+{
+    return data.trimmed().startsWith(placeholderPrefix());
+}
+
+QStringList PLESvgImageStore::keys() const
+{
+    QMutexLocker locker(&s_shared_mutex);
+
+    return m_images.keys();
+}
+
+void PLESvgImageStore::insert(const PLESvgImageStore& other)
+{
+    QMutexLocker locker(&s_shared_mutex);
+
+    for (QMap<QString, QImage>::const_iterator it = other.m_images.constBegin() ; it != other.m_images.constEnd() ; ++it)
+        m_images.insert(it.key(), it.value());
+}
+
+void PLESvgImageStore::retain(const QSet<QString>& keys)
+{
+    QMutexLocker locker(&s_shared_mutex);
+
+    for (QMap<QString, QImage>::iterator it = m_images.begin() ; it != m_images.end() ; )
+    {
+        if (keys.contains(it.key()))
+            ++it;
+        else
+            it = m_images.erase(it);
+    }
+}
+
+void PLESvgImageStore::resolve(QDomDocument& document, ProgressObserver* observer) const
+{
+    QMap<QString, QString> data;
+    int i = 0;
+
+    for (QMap<QString, QImage>::const_iterator it = m_images.constBegin() ; it != m_images.constEnd() ; ++it, ++i)
+    {
+        if (observer)
+            observer->progresChanged(double(i) / m_images.count());
+
+        data.insert(it.key(), encode(it.value()));
+    }
+
+    if (!data.isEmpty())
+        resolveNode(document, data);
+
+    if (observer)
+        observer->progresChanged(1);
+}
+
+QString PLESvgImageStore::encode(const QImage& image)
+{
+    QByteArray byteArray;
+    QBuffer buffer(&byteArray);
+    image.save(&buffer, "PNG");
+
+    return QString::fromUtf8(byteArray.toBase64());
+}
+
+void PLESvgImageStore::resolveNode(QDomNode node, const QMap<QString, QString>& data)
+{
+    if (node.isText())
+    {
+        QDomText text = node.toText();
+
+        if (text.data().startsWith(placeholderPrefix()))
+            text.setData(data.value(text.data()));
+
+        return;
+    }
+
+    if (node.isElement())
+    {
+        // Images are referenced by 'xlink:href' attributes with data URI prefix
+        QDomNamedNodeMap attributes = node.attributes();
+
+        for (int i = 0 ; i < attributes.count() ; ++i)
+        {
+            QDomAttr attribute = attributes.item(i).toAttr();
+            const int index    = attribute.value().indexOf(placeholderPrefix());
+
+            if (index >= 0)
+                attribute.setValue(attribute.value().left(index) + data.value(attribute.value().mid(index)));
+        }
+    }
+
+    for (QDomNode child = node.firstChild() ; !child.isNull() ; child = child.nextSibling())
+        resolveNode(child, data);
+}
+
+} // namespace PhotoLayoutsEditor
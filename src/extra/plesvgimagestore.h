@@ -0,0 +1,103 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef PLE_SVG_IMAGE_STORE_H
+#define PLE_SVG_IMAGE_STORE_H
+
+// Qt includes
+
+#include <QDomDocument>
+#include <QImage>
+#include <QMap>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+namespace PhotoLayoutsEditor
+{
+
+class ProgressObserver;
+
+/** Defers PNG encoding of images embedded into SVG documents.
+ * While the store is active, svgImageData() only references images by a placeholder, so the scene
+ * document can be quickly built on the GUI thread. Images are encoded by resolve(), which may be
+ * called from any thread since the stored images are implicitly shared copies.
+ */
+class PLESvgImageStore
+{
+public:
+
+    PLESvgImageStore();
+    ~PLESvgImageStore();
+
+    /// Activates the store for svgImageData() calls of the current thread, end() has to be called by the same thread
+    void begin();
+    void end();
+
+    /// Replaces placeholders of the stored images in the document with their encoded data
+    void resolve(QDomDocument& document, ProgressObserver* observer = nullptr) const;
+
+    /// Returns base64 encoded PNG data of the image or a placeholder if a store is active
+    static QString svgImageData(const QImage& image);
+
+    /** Marks documents built while the store is active as internal copies of the scene, which are
+     * never written to files: all images are embedded without asking and previews for other SVG
+     * viewers are skipped.
+     */
+    void setInternalCopy(bool internal);
+    static bool isInternalCopy();
+
+    /// Makes stored images available to svgImage() in all threads until unshare() is called
+    void share();
+    void unshare();
+
+    /// Returns image of SVG data, which is either base64 encoded image or a placeholder of a shared store
+    static QImage svgImage(const QString& data);
+
+    /// Returns if SVG data is a placeholder of a stored image
+    static bool isPlaceholder(const QString& data);
+
+    /// Placeholders of stored images
+    QStringList keys() const;
+
+    /// Adds images of the other store, images are implicitly shared
+    void insert(const PLESvgImageStore& other);
+
+    /// Removes images not referenced by given placeholders
+    void retain(const QSet<QString>& keys);
+
+private:
+
+    static QString encode(const QImage& image);
+    static void resolveNode(QDomNode node, const QMap<QString, QString>& data);
+
+private:
+
+    QMap<QString, QImage> m_images;
+    bool                  m_internal;
+};
+
+} // namespace PhotoLayoutsEditor
+
+#endif // PLE_SVG_IMAGE_STORE_H
@@ -44,7 +44,7 @@
 // Local includes
 
 #include "progressevent.h"
-#include "plewindow.h"
+#include "pleglobal.h"
 
 using namespace Digikam;
 
@@ -95,7 +95,7 @@ protected:
     {
         ProgressEvent* event = new ProgressEvent(m_thread);
         event->setData(ProgressEvent::ProgressUpdate, value * m_max_progress / 0.4);
-        QCoreApplication::postEvent(PLEWindow::instance(), event);
+        PLE_PostProgressEvent(event);
         QCoreApplication::processEvents();
     }
 };
@@ -145,7 +145,7 @@ void ImageLoadingThread::run()
     {
         ProgressEvent* startEvent = new ProgressEvent(this);
         startEvent->setData(ProgressEvent::Init, 0);
-        QCoreApplication::postEvent(PLEWindow::instance(), startEvent);
+        PLE_PostProgressEvent(startEvent);
         QCoreApplication::processEvents();
 
         if (DRawDecoder::isRawFile(url))
@@ -155,7 +155,7 @@ void ImageLoadingThread::run()
 
         ProgressEvent* finishEvent = new ProgressEvent(this);
         finishEvent->setData(ProgressEvent::Finish, 1);
-        QCoreApplication::postEvent(PLEWindow::instance(), finishEvent);
+        PLE_PostProgressEvent(finishEvent);
         QCoreApplication::processEvents();
     }
 
@@ -190,7 +190,7 @@ void ImageLoadingThread::loadRaw(const QUrl& url)
 {
     ProgressEvent* loadingImageActionEvent = new ProgressEvent(this);
     loadingImageActionEvent->setData(ProgressEvent::ActionUpdate, QVariant( QObject::tr("Loading ").append(url.fileName()) ));
-    QCoreApplication::postEvent(PLEWindow::instance(), loadingImageActionEvent);
+    PLE_PostProgressEvent(loadingImageActionEvent);
     QCoreApplication::processEvents();
 
     RAWLoader* loader = new RAWLoader(this);
@@ -208,7 +208,7 @@ void ImageLoadingThread::loadRaw(const QUrl& url)
     {
         ProgressEvent* buildImageEvent = new ProgressEvent(this);
         buildImageEvent->setData(ProgressEvent::ActionUpdate, QVariant( QObject::tr("Decoding image") ));
-        QCoreApplication::postEvent(PLEWindow::instance(), buildImageEvent);
+        PLE_PostProgressEvent(buildImageEvent);
         QCoreApplication::processEvents();
 
         uchar* image = new uchar[width*height*4];
@@ -222,7 +222,7 @@ void ImageLoadingThread::loadRaw(const QUrl& url)
             {
                 ProgressEvent* event = new ProgressEvent(this);
                 event->setData(ProgressEvent::ProgressUpdate, d->m_max_progress * (0.7 + 0.3 * (((float)h)/((float)height))) );
-                QCoreApplication::postEvent(PLEWindow::instance(), event);
+                PLE_PostProgressEvent(event);
                 QCoreApplication::processEvents();
 
                 for (int w = 0; w < width; ++w)
@@ -260,7 +260,7 @@ void ImageLoadingThread::loadRaw(const QUrl& url)
 
         ProgressEvent* emitEvent = new ProgressEvent(this);
         emitEvent->setData(ProgressEvent::ActionUpdate, QVariant( QObject::tr("Finishing...") ));
-        QCoreApplication::postEvent(PLEWindow::instance(), emitEvent);
+        PLE_PostProgressEvent(emitEvent);
         QCoreApplication::processEvents();
 
         delete [] image;
@@ -274,7 +274,7 @@ void ImageLoadingThread::loadImage(const QUrl& url)
 {
     ProgressEvent* loadingImageActionEvent = new ProgressEvent(this);
     loadingImageActionEvent->setData(ProgressEvent::ActionUpdate, QVariant( QObject::tr("Loading ").append(url.fileName()) ));
-    QCoreApplication::postEvent(PLEWindow::instance(), loadingImageActionEvent);
+    PLE_PostProgressEvent(loadingImageActionEvent);
     QCoreApplication::processEvents();
 
     QFile f(url.path());
@@ -294,7 +294,7 @@ void ImageLoadingThread::loadImage(const QUrl& url)
         this->yieldCurrentThread();
         ProgressEvent* event = new ProgressEvent(this);
         event->setData(ProgressEvent::ProgressUpdate, (d->m_loaded_bytes * d->m_max_progress) / (d->m_size * 1.4));
-        QCoreApplication::postEvent(PLEWindow::instance(), event);
+        PLE_PostProgressEvent(event);
         QCoreApplication::processEvents();
     }
     while (temp.size() == s);
@@ -304,14 +304,14 @@ void ImageLoadingThread::loadImage(const QUrl& url)
 
     ProgressEvent* buildImageEvent = new ProgressEvent(this);
     buildImageEvent->setData(ProgressEvent::ActionUpdate, QVariant( QObject::tr("Decoding image") ));
-    QCoreApplication::postEvent(PLEWindow::instance(), buildImageEvent);
+    PLE_PostProgressEvent(buildImageEvent);
     QCoreApplication::processEvents();
 
     QImage img = QImage::fromData(ba);
 
     ProgressEvent* emitEvent = new ProgressEvent(this);
     emitEvent->setData(ProgressEvent::ActionUpdate, QVariant( QObject::tr("Finishing...") ));
-    QCoreApplication::postEvent(PLEWindow::instance(), emitEvent);
+    PLE_PostProgressEvent(emitEvent);
     QCoreApplication::processEvents();
 
     Q_EMIT imageLoaded(url, img);
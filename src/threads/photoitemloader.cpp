@@ -27,6 +27,7 @@
 // Qt includes
 
 #include <QBuffer>
+#include <QImageReader>
 #include <QDebug>
 
 // Local includes
@@ -35,6 +36,7 @@
 #include "imageloadingthread.h"
 #include "progressobserver.h"
 #include "pleglobal.h"
+#include "plesvgimagestore.h"
 
 namespace PhotoLayoutsEditor
 {
@@ -129,14 +131,36 @@ void PhotoItemLoader::run()
     if      (!(imageAttribute = imageElement.text()).isEmpty())
     {
         // Fullsize image is embedded in SVG file!
-        item->d->m_image = QImage::fromData( QByteArray::fromBase64(imageAttribute.toLatin1()) );
+        // Embedded data is kept as the record of the image, it's decoded when the photo is near the views
+        QByteArray imageData;
+
+        if (!PLESvgImageStore::isPlaceholder(imageAttribute))
+            imageData = QByteArray::fromBase64(imageAttribute.trimmed().toLatin1());
+
+        QBuffer buffer(&imageData);
+        const QSize imageSize = QImageReader(&buffer).size();
+
+        if (!imageData.isEmpty() && imageSize.isValid())
+        {
+            item->d->m_image_data     = imageData;
+            item->d->m_released_size  = imageSize;
+            item->d->m_image_released = true;
+        }
+        else
+        {
+            item->d->m_image = PLESvgImageStore::svgImage(imageAttribute);
+        }
+
         //if (item->d->m_image.isNull())
         //    this->exit(1);
     }
     else if (!(imageAttribute = PhotoItem::PhotoItemPrivate::locateFile( imageElement.attribute(QLatin1String("xlink:href")) )).isEmpty())
     {
         // Try to find file from path attribute
+        // Image is set by the loading thread while this one waits for it
         ImageLoadingThread* loader = new ImageLoadingThread(this);
+        connect(loader, SIGNAL(imageLoaded(QUrl,QImage)),
+                this, SLOT(imageLoaded(QUrl,QImage)), Qt::DirectConnection);
         loader->setImageUrl(QUrl(imageAttribute));
         loader->start();
         loader->wait();
@@ -155,13 +179,15 @@ void PhotoItemLoader::run()
     this->exit(0);
 }
 
-void PhotoItemLoader::imageLoaded(const QUrl& /*url*/, const QImage& image)
+void PhotoItemLoader::imageLoaded(const QUrl& url, const QImage& image)
 {
     if (image.isNull())
-        this->exit(1);
+        return;
 
     PhotoItem* const item = dynamic_cast<PhotoItem*>(this->item());
-    item->d->m_image = image;
+    item->d->m_image           = image;
+    item->d->m_image_from_file = true;
+    item->d->setFileUrl(url);
 }
 
 } // namespace PhotoLayoutsEditor
@@ -41,7 +41,7 @@
 #include "textitem.h"
 #include "plescenebackground.h"
 #include "plesceneborder.h"
-#include "plewindow.h"
+#include "pleglobal.h"
 
 namespace PhotoLayoutsEditor
 {
@@ -78,7 +78,7 @@ void PLECanvasLoadingThread::progresChanged(double progress)
 {
     ProgressEvent* progressUpdateEvent = new ProgressEvent(this);
     progressUpdateEvent->setData(ProgressEvent::ProgressUpdate, ((double)d->i+1)/((double)d->data.count()+1) + (progress / (double)d->data.count()+1) );
-    QCoreApplication::postEvent(PLEWindow::instance(), progressUpdateEvent);
+    PLE_PostProgressEvent(progressUpdateEvent);
     QCoreApplication::processEvents();
 }
 
@@ -86,7 +86,7 @@ void PLECanvasLoadingThread::progresName(const QString& name)
 {
     ProgressEvent* actionUpdateEvent = new ProgressEvent(this);
     actionUpdateEvent->setData(ProgressEvent::ActionUpdate, name);
-    QCoreApplication::postEvent(PLEWindow::instance(), actionUpdateEvent);
+    PLE_PostProgressEvent(actionUpdateEvent);
     QCoreApplication::processEvents();
 }
 
@@ -120,14 +120,14 @@ void PLECanvasLoadingThread::run()
 {
     ProgressEvent* startEvent = new ProgressEvent(this);
     startEvent->setData(ProgressEvent::Init, 0);
-    QCoreApplication::postEvent(PLEWindow::instance(), startEvent);
+    PLE_PostProgressEvent(startEvent);
     QCoreApplication::processEvents();
 
     // Background
     {
         ProgressEvent* actionUpdateEvent = new ProgressEvent(this);
         actionUpdateEvent->setData(ProgressEvent::ActionUpdate, QObject::tr("Loading background...") );
-        QCoreApplication::postEvent(PLEWindow::instance(), actionUpdateEvent);
+        PLE_PostProgressEvent(actionUpdateEvent);
         QCoreApplication::processEvents();
 
         if (d->background.first)
@@ -139,7 +139,7 @@ void PLECanvasLoadingThread::run()
 
         ProgressEvent* progressUpdateEvent = new ProgressEvent(this);
         progressUpdateEvent->setData(ProgressEvent::ProgressUpdate, 1/((double)d->data.count()+2) );
-        QCoreApplication::postEvent(PLEWindow::instance(), progressUpdateEvent);
+        PLE_PostProgressEvent(progressUpdateEvent);
         QCoreApplication::processEvents();
     }
 
@@ -152,7 +152,7 @@ void PLECanvasLoadingThread::run()
     {
         ProgressEvent* actionUpdateEvent = new ProgressEvent(this);
         actionUpdateEvent->setData(ProgressEvent::ActionUpdate, QObject::tr("Loading item no. %1...").arg(QString::number(d->i)));
-        QCoreApplication::postEvent(PLEWindow::instance(), actionUpdateEvent);
+        PLE_PostProgressEvent(actionUpdateEvent);
         QCoreApplication::processEvents();
 
         QDomElement e = it.value();
@@ -174,7 +174,7 @@ void PLECanvasLoadingThread::run()
 
         ProgressEvent* progressUpdateEvent = new ProgressEvent(this);
         progressUpdateEvent->setData(ProgressEvent::ProgressUpdate, ((double)d->i+1)/((double)count+2) );
-        QCoreApplication::postEvent(PLEWindow::instance(), progressUpdateEvent);
+        PLE_PostProgressEvent(progressUpdateEvent);
         QCoreApplication::processEvents();
     }
 
@@ -183,7 +183,7 @@ void PLECanvasLoadingThread::run()
     {
         ProgressEvent* actionUpdateEvent = new ProgressEvent(this);
         actionUpdateEvent->setData(ProgressEvent::ActionUpdate, QObject::tr("Loading border...") );
-        QCoreApplication::postEvent(PLEWindow::instance(), actionUpdateEvent);
+        PLE_PostProgressEvent(actionUpdateEvent);
         QCoreApplication::processEvents();
 
         if (d->border.first)
@@ -195,13 +195,13 @@ void PLECanvasLoadingThread::run()
 
         ProgressEvent* progressUpdateEvent = new ProgressEvent(this);
         progressUpdateEvent->setData(ProgressEvent::ProgressUpdate, 1/((double)d->data.count()+2) );
-        QCoreApplication::postEvent(PLEWindow::instance(), progressUpdateEvent);
+        PLE_PostProgressEvent(progressUpdateEvent);
         QCoreApplication::processEvents();
     }
 
     ProgressEvent* finishEvent = new ProgressEvent(this);
     finishEvent->setData(ProgressEvent::Finish, 0);
-    QCoreApplication::postEvent(PLEWindow::instance(), finishEvent);
+    PLE_PostProgressEvent(finishEvent);
     QCoreApplication::processEvents();
 }
 
@@ -35,6 +35,7 @@
 
 #include "plecanvas_p.h"
 #include "plescene.h"
+#include "plephotobook.h"
 #include "progressevent.h"
 #include "plewindow.h"
 
@@ -43,24 +44,38 @@ namespace PhotoLayoutsEditor
 
 PLECanvasSavingThread::PLECanvasSavingThread(QObject* parent)
     : QThread(parent),
-      m_canvas(nullptr),
-      m_template(false)
+      m_template(false),
+      m_receiver(nullptr)
 {
+    connect(this, SIGNAL(finished()),
+            this, SLOT(deleteLater()));
+}
+
+PLECanvasSavingThread::~PLECanvasSavingThread()
+{
+    wait();
 }
 
 void PLECanvasSavingThread::save(PLECanvas* canvas, const QUrl& url)
 {
-    m_canvas = canvas;
-    m_url    = url;
-    this->start();
+    m_url      = url;
+    m_template = false;
+
+    if (capture(canvas))
+        this->start();
+    else
+        this->deleteLater();
 }
 
 void PLECanvasSavingThread::saveAsTemplate(PLECanvas* canvas, const QUrl& url)
 {
-    m_canvas   = canvas;
     m_url      = url;
     m_template = true;
-    this->start();
+
+    if (capture(canvas))
+        this->start();
+    else
+        this->deleteLater();
 }
 
 void PLECanvasSavingThread::progresChanged(double progress)
@@ -73,24 +88,23 @@ void PLECanvasSavingThread::progresName(const QString& name)
     this->sendActionUpdate(name);
 }
 
-void PLECanvasSavingThread::run()
+bool PLECanvasSavingThread::capture(PLECanvas* canvas)
 {
-    if (!m_canvas || !m_url.isValid())
-        return;
+    if (!canvas || !m_url.isValid())
+        return false;
 
-    //---------------------------------------------------------------------------
+    PLEScene* const scene = dynamic_cast<PLEScene*>(canvas->scene());
 
-    ProgressEvent* startEvent = new ProgressEvent(this);
-    startEvent->setData(ProgressEvent::Init, 0);
-    QCoreApplication::postEvent(PLEWindow::instance(), startEvent);
-    QCoreApplication::processEvents();
+    if (!scene)
+        return false;
 
-    this->sendActionUpdate( QObject::tr("Creating canvas...") );
+    // Progress events are sent to the window captured here, it can't be created from the thread
+    m_receiver = PLEWindow::instance();
 
-    QRect sceneRect = m_canvas->sceneRect().toRect();
-    QDomDocument document(QLatin1String(" svg PUBLIC \"-//W3C//DTD SVG 1.1//EN\" \"http://www.w3.org/Graphics/SVG/1.1/DTD/svg11.dtd\""));
-    QDomElement svg = document.createElement(QLatin1String("svg"));
-    document.appendChild(svg);
+    QRect sceneRect = canvas->sceneRect().toRect();
+    m_document      = QDomDocument(QLatin1String(" svg PUBLIC \"-//W3C//DTD SVG 1.1//EN\" \"http://www.w3.org/Graphics/SVG/1.1/DTD/svg11.dtd\""));
+    QDomElement svg = m_document.createElement(QLatin1String("svg"));
+    m_document.appendChild(svg);
 
     svg.setAttribute(QLatin1String("xmlns"), QLatin1String("http://www.w3.org/2000/svg"));
     svg.setAttribute(QLatin1String("viewBox"), QString::number(sceneRect.x()) + QLatin1Char(' ') +
@@ -102,7 +116,7 @@ void PLECanvasSavingThread::run()
     svg.setAttribute(QLatin1String("baseProfile"), QLatin1String("tiny"));
     QString j1;
 
-    switch (m_canvas->d->m_size.sizeUnit())
+    switch (canvas->d->m_size.sizeUnit())
     {
         case PLECanvasSize::Centimeters:
             j1 = QLatin1String("cm");
@@ -134,37 +148,77 @@ void PLECanvasSavingThread::run()
             break;
     }
 
-    svg.setAttribute(QLatin1String("width"), QString::number(m_canvas->d->m_size.size().width()) + j1);
-    svg.setAttribute(QLatin1String("height"), QString::number(m_canvas->d->m_size.size().height()) + j1);
-    QDomElement resolution = document.createElementNS(m_template ? PhotoLayoutsEditor::templateUri() : PhotoLayoutsEditor::uri(), QLatin1String("page"));
-    resolution.setAttribute(QLatin1String("width"), QString::number(m_canvas->d->m_size.resolution().width()));
-    resolution.setAttribute(QLatin1String("height"), QString::number(m_canvas->d->m_size.resolution().height()));
-    resolution.setAttribute(QLatin1String("unit"), PLECanvasSize::resolutionUnitName(m_canvas->d->m_size.resolutionUnit()));
+    svg.setAttribute(QLatin1String("width"), QString::number(canvas->d->m_size.size().width()) + j1);
+    svg.setAttribute(QLatin1String("height"), QString::number(canvas->d->m_size.size().height()) + j1);
+    QDomElement resolution = m_document.createElementNS(m_template ? PhotoLayoutsEditor::templateUri() : PhotoLayoutsEditor::uri(), QLatin1String("page"));
+    resolution.setAttribute(QLatin1String("width"), QString::number(canvas->d->m_size.resolution().width()));
+    resolution.setAttribute(QLatin1String("height"), QString::number(canvas->d->m_size.resolution().height()));
+    resolution.setAttribute(QLatin1String("unit"), PLECanvasSize::resolutionUnitName(canvas->d->m_size.resolutionUnit()));
     svg.appendChild(resolution);
 
-    this->sendProgressUpdate( 0.05 );
-    this->sendActionUpdate( QObject::tr("Saving scene...") );
-
     //---------------------------------------------------------------------------
 
-    PLEScene* const scene = dynamic_cast<PLEScene*>(m_canvas->scene());
+    // Scenes are converted without observer, progress events would be processed while the scenes are read
+    m_images.begin();
+    bool result = true;
 
-    if (!scene)
+    // Template is the layout of the current page
+    if (m_template)
     {
-        this->exit(1);
-        return;
+        QDomElement sceneElement = scene->toTemplateSvg(nullptr).documentElement();
+        result                   = !sceneElement.isNull();
+
+        if (result)
+            svg.appendChild(sceneElement);
     }
+    else
+    {
+        PLEPhotobook* const photobook = canvas->photobook();
+
+        for (int i = 0 ; i < photobook->count() ; ++i)
+        {
+            QDomElement sceneElement = photobook->pageSvg(i).documentElement();
+
+            if (sceneElement.isNull())
+            {
+                result = false;
+                break;
+            }
+
+            // Other SVG viewers show the first page only
+            if (i)
+            {
+                sceneElement.setAttribute(QLatin1String("id"), QLatin1String("PLEScene-") + QString::number(i + 1));
+                sceneElement.setAttribute(QLatin1String("visibility"), QLatin1String("hidden"));
+            }
+
+            svg.appendChild(sceneElement);
+        }
+    }
+
+    m_images.end();
+
+    return result;
+}
+
+void PLECanvasSavingThread::run()
+{
+    if (m_document.isNull() || !m_url.isValid())
+        return;
 
-    QDomDocument sceneDocument = m_template ? scene->toTemplateSvg(this) : scene->toSvg(this);
-    QDomElement sceneElement = sceneDocument.documentElement();
+    //---------------------------------------------------------------------------
 
-    if (sceneElement.isNull())
-        this->exit(1);
+    ProgressEvent* startEvent = new ProgressEvent(this);
+    startEvent->setData(ProgressEvent::Init, 0);
+    QCoreApplication::postEvent(m_receiver, startEvent);
 
-    svg.appendChild(sceneElement);
+    this->sendProgressUpdate( 0.05 );
+    this->sendActionUpdate( QObject::tr("Saving scene...") );
 
     //---------------------------------------------------------------------------
 
+    m_images.resolve(m_document, this);
+
     this->sendProgressUpdate( 0.8 );
     this->sendActionUpdate( QObject::tr("Encoding data...") );
 
@@ -172,7 +226,7 @@ void PLECanvasSavingThread::run()
 
     if (file.open(QFile::WriteOnly | QFile::Text))
     {
-        QByteArray result = document.toByteArray();
+        QByteArray result = m_document.toByteArray();
         const char* data = result.data();
         int i = 0;
         const int limit = result.size();
@@ -194,8 +248,7 @@ void PLECanvasSavingThread::run()
 
     ProgressEvent* const finishEvent = new ProgressEvent(this);
     finishEvent->setData(ProgressEvent::Finish, 0);
-    QCoreApplication::postEvent(PLEWindow::instance(), finishEvent);
-    QCoreApplication::processEvents();
+    QCoreApplication::postEvent(m_receiver, finishEvent);
 
     this->exit(0);
 }
@@ -209,16 +262,14 @@ void PLECanvasSavingThread::sendProgressUpdate(double v)
 {
     ProgressEvent* event = new ProgressEvent(this);
     event->setData(ProgressEvent::ProgressUpdate, v);
-    QCoreApplication::postEvent(PLEWindow::instance(), event);
-    QCoreApplication::processEvents();
+    QCoreApplication::postEvent(m_receiver, event);
 }
 
 void PLECanvasSavingThread::sendActionUpdate(const QString& str)
 {
     ProgressEvent* event = new ProgressEvent(this);
     event->setData(ProgressEvent::ActionUpdate, str);
-    QCoreApplication::postEvent(PLEWindow::instance(), event);
-    QCoreApplication::processEvents();
+    QCoreApplication::postEvent(m_receiver, event);
 }
 
 } // namespace PhotoLayoutsEditor
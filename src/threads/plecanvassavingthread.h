@@ -29,16 +29,22 @@
 
 #include <QThread>
 #include <QUrl>
+#include <QDomDocument>
 
 // Local includes
 
 #include "progressobserver.h"
+#include "plesvgimagestore.h"
 
 namespace PhotoLayoutsEditor
 {
 
     class PLECanvas;
 
+/** Saves canvas document in the background.
+ * Documents of the pages are captured on the GUI thread when saving starts, images they embed are
+ * only referenced and encoded by the thread, so the canvas can be edited while it's being saved.
+ */
 class PLECanvasSavingThread : public QThread, public ProgressObserver
 {
     Q_OBJECT
@@ -46,6 +52,7 @@ class PLECanvasSavingThread : public QThread, public ProgressObserver
 public:
 
     explicit PLECanvasSavingThread(QObject* parent = nullptr);
+    ~PLECanvasSavingThread() override;
 
     void save(PLECanvas* canvas, const QUrl& url);
     void saveAsTemplate(PLECanvas* canvas, const QUrl& url);
@@ -67,14 +74,17 @@ private Q_SLOTS:
 
 private:
 
+    bool capture(PLECanvas* canvas);
     void sendProgressUpdate(double v);
     void sendActionUpdate(const QString& str);
 
 private:
 
-    PLECanvas* m_canvas;
-    QUrl       m_url;
-    bool       m_template;
+    QUrl             m_url;
+    bool             m_template;
+    QDomDocument     m_document;
+    PLESvgImageStore m_images;
+    QObject*         m_receiver;
 };
 
 } // namespace PhotoLayoutsEditor
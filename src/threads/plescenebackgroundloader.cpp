@@ -31,6 +31,7 @@
 // Local includes
 
 #include "plescenebackground.h"
+#include "plesvgimagestore.h"
 
 namespace PhotoLayoutsEditor
 {
@@ -134,7 +135,7 @@ void PLESceneBackgroundLoader::run()
 
         m_background->m_image_size.setWidth(image.attribute(QLatin1String("width")).remove(QLatin1String("px")).toInt());
         m_background->m_image_size.setHeight(image.attribute(QLatin1String("height")).remove(QLatin1String("px")).toInt());
-        m_background->m_image = QImage::fromData( QByteArray::fromBase64(image.attributeNS(QLatin1String("http://www.w3.org/1999/xlink"), QLatin1String("href")).remove(QLatin1String("data:image/png;base64,")).toLatin1()) );
+        m_background->m_image = PLESvgImageStore::svgImage(image.attributeNS(QLatin1String("http://www.w3.org/1999/xlink"), QLatin1String("href")).remove(QLatin1String("data:image/png;base64,")));
         m_background->m_first_brush.setTextureImage(m_background->m_image.scaled(m_background->m_image_size, m_background->m_image_aspect_ratio));
 
         QDomElement bColor = defs.firstChildElement(QLatin1String("background_color"));
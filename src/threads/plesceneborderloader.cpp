@@ -31,6 +31,7 @@
 // Local includes
 
 #include "plesceneborder.h"
+#include "plesvgimagestore.h"
 
 namespace PhotoLayoutsEditor
 {
@@ -75,8 +76,8 @@ void PLESceneBorderLoader::run()
     if (image.isNull())
         this->exit(1);
 
-    m_border->m_image = QImage::fromData(QByteArray::fromBase64(image.attributeNS(QLatin1String("http://www.w3.org/1999/xlink"),
-                                                                QLatin1String("href")).remove(QLatin1String("data:image/png;base64,")).toLatin1()));
+    m_border->m_image = PLESvgImageStore::svgImage(image.attributeNS(QLatin1String("http://www.w3.org/1999/xlink"),
+                                                                     QLatin1String("href")).remove(QLatin1String("data:image/png;base64,")));
 
     this->exit(0);
 }
@@ -87,6 +87,7 @@ private:
     void writeOnPolygon(const QPointF& value, QPolygonF& polygon, uint corner);
 
     friend class CropWidgetItemPrivate;
+    friend class PLEScene;
 };
 
 } // namespace PhotoLayoutsEditor
@@ -38,6 +38,10 @@
 // Local includes
 
 #include "plescene.h"
+#include "plephotobook.h"
+#include "plescenebackground.h"
+#include "plesceneborder.h"
+#include "photoitem.h"
 #include "layersmodel.h"
 #include "layersmodelitem.h"
 #include "layersselectionmodel.h"
@@ -49,6 +53,7 @@
 #include "plecanvasloadingthread.h"
 #include "plecanvassavingthread.h"
 #include "plestatusbar.h"
+#include "pleprintrenderer.h"
 
 #define MAX_SCALE_LIMIT 4
 #define MIN_SCALE_LIMIT 0.5
@@ -60,18 +65,23 @@ PLECanvas::PLECanvas(const PLECanvasSize& size, QWidget* parent)
     : QGraphicsView(parent),
       d(new PLECanvasPrivate)
 {
-    d->m_size = size;
-    m_scene   = new PLEScene(QRectF(QPointF(0, 0), d->m_size.size(PLECanvasSize::Pixels)), this);
+    d->m_size   = size;
+    m_photobook = new PLEPhotobook(size, this);
+    m_photobook->appendPage();
+    m_photobook->setCurrentPage(0);
+    m_scene     = m_photobook->scene(0);
     this->init();
 }
 
-PLECanvas::PLECanvas(PLEScene* scene, QWidget* parent)
+PLECanvas::PLECanvas(PLEPhotobook* photobook, QWidget* parent)
     : QGraphicsView(parent),
       d(new PLECanvasPrivate)
 {
-    Q_ASSERT(scene != nullptr);
-    m_scene = scene;
-    m_scene->setParent(this);
+    Q_ASSERT(photobook != nullptr);
+    m_photobook = photobook;
+    m_photobook->setParent(this);
+    m_scene     = m_photobook->scene(m_photobook->currentPage());
+    Q_ASSERT(m_scene != nullptr);
     this->setScene(m_scene);
 
     this->init();
@@ -84,10 +94,32 @@ PLECanvas::~PLECanvas()
 
 void PLECanvas::init()
 {
-    m_is_saved       = true;
-    m_saved_on_index = 0;
-    m_undo_stack     = new QUndoStack(this);
-    m_scale_factor   = 1;
+    m_is_saved        = true;
+    m_saved_on_index  = 0;
+    m_saving_on_index = 0;
+    m_undo_stack      = m_photobook->undoStack();
+    m_scale_factor    = 1;
+
+    d->m_zoom_timer = new QTimer(this);
+    d->m_zoom_timer->setSingleShot(true);
+    d->m_zoom_timer->setInterval(16);
+
+    d->m_zoom_settle_timer = new QTimer(this);
+    d->m_zoom_settle_timer->setSingleShot(true);
+    d->m_zoom_settle_timer->setInterval(200);
+
+    connect(d->m_zoom_timer, SIGNAL(timeout()),
+            this, SLOT(applyZoom()));
+
+    connect(d->m_zoom_settle_timer, SIGNAL(timeout()),
+            this, SLOT(finishZoom()));
+
+    d->m_detail_timer = new QTimer(this);
+    d->m_detail_timer->setSingleShot(true);
+    d->m_detail_timer->setInterval(200);
+
+    connect(d->m_detail_timer, SIGNAL(timeout()),
+            this, SLOT(updateLevelsOfDetail()));
 
     this->setupGUI();
     this->enableViewingMode();
@@ -105,6 +137,7 @@ void PLECanvas::setupGUI()
     QSettings config(QLatin1String("PhotoLayoutEditor"));
     config.beginGroup(QLatin1String("View"));
     this->setAntialiasing(config.value(QLatin1String("Antialiasing"), false).toBool());
+    this->setStaticLayerCaching(config.value(QLatin1String("StaticLayerCache"), true).toBool());
     config.endGroup();
 
     // Transparent scene background
@@ -126,10 +159,30 @@ void PLECanvas::setupGUI()
 }
 
 void PLECanvas::prepareSignalsConnection()
+{
+    this->prepareSceneConnection();
+
+    connect(m_photobook, SIGNAL(currentPageChanged(int)),
+            this, SLOT(showPage(int)));
+
+    connect(m_undo_stack, SIGNAL(indexChanged(int)),
+            this, SLOT(isSavedChanged(int)));
+
+    connect(m_undo_stack, SIGNAL(cleanChanged(bool)),
+            this, SLOT(isSavedChanged(bool)));
+}
+
+void PLECanvas::prepareSceneConnection()
 {
     connect(m_scene, SIGNAL(selectionChanged()),
             this, SLOT(selectionChanged()));
 
+    connect(m_scene, SIGNAL(interactionStarted()),
+            this, SLOT(beginStaticLayer()));
+
+    connect(m_scene, SIGNAL(interactionFinished()),
+            this, SLOT(endStaticLayer()));
+
     connect(m_scene, SIGNAL(itemAboutToBeRemoved(AbstractPhoto*)),
             this, SLOT(removeItem(AbstractPhoto*)));
 
@@ -138,12 +191,42 @@ void PLECanvas::prepareSignalsConnection()
 
     connect(m_scene->selectionModel(), SIGNAL(selectionChanged(QItemSelection,QItemSelection)),
             this, SLOT(selectionChanged(QItemSelection,QItemSelection)));
+}
 
-    connect(m_undo_stack, SIGNAL(indexChanged(int)),
-            this, SLOT(isSavedChanged(int)));
+void PLECanvas::showPage(int index)
+{
+    PLEScene* const scene = m_photobook->scene(index);
 
-    connect(m_undo_stack, SIGNAL(cleanChanged(bool)),
-            this, SLOT(isSavedChanged(bool)));
+    if (!scene || scene == m_scene)
+        return;
+
+    // Composites and selection belong to the previous page
+    this->endStaticLayer();
+    m_scene->clearSelection();
+
+    // Grid is set up for the canvas, not for each page
+    scene->setGrid(m_scene->gridHorizontalDistance(), m_scene->gridVerticalDistance());
+    scene->setGridVisible(m_scene->isGridVisible());
+
+    // View moves its own connections to the new scene, the remaining ones are made by the canvas
+    PLEScene* const previous = m_scene;
+    m_scene                  = scene;
+    this->setScene(m_scene);
+    previous->disconnect(this);
+    previous->selectionModel()->disconnect(this);
+    this->prepareSceneConnection();
+    this->updateLevelsOfDetail();
+
+    // Photos of the page which isn't shown anymore release their images
+    foreach (QGraphicsItem* const item, previous->items())
+    {
+        PhotoItem* const photo = dynamic_cast<PhotoItem*>(item);
+
+        if (photo)
+            photo->updateLevelOfDetail();
+    }
+
+    Q_EMIT pageChanged(index);
 }
 
 void PLECanvas::setSelectionMode(SelectionMode mode)
@@ -205,7 +288,7 @@ void PLECanvas::setPLECanvasSize(const PLECanvasSize& size)
         return;
 
     d->m_size = size;
-    m_scene->setSceneRect(QRectF(QPointF(0,0), size.size(PLECanvasSize::Pixels)));
+    m_photobook->setPageSize(size);
 }
 
 void PLECanvas::preparePrinter(QPrinter* printer)
@@ -317,11 +400,216 @@ void PLECanvas::addNewItem(AbstractPhoto* item)
 
 void PLECanvas::setAntialiasing(bool antialiasing)
 {
+    d->m_antialiasing = antialiasing;
+
+    // Quality hints are restored when zoom gesture finishes
+    if (d->m_zooming)
+        return;
+
     this->setRenderHint(QPainter::Antialiasing, antialiasing);                            /// It causes worst quality!
     this->setOptimizationFlag(QGraphicsView::DontAdjustForAntialiasing, antialiasing);    /// It causes worst quality!
+    this->setRenderHint(QPainter::SmoothPixmapTransform, antialiasing);                   /// Photos are painted with trilinear filtering
     this->update();
 }
 
+void PLECanvas::setStaticLayerCaching(bool enabled)
+{
+    d->m_static_layer_enabled = enabled;
+
+    if (!enabled)
+        this->endStaticLayer();
+}
+
+/// Background, border and unselected photos can be flattened, editing widgets and dragged items paint themselves
+static bool isStaticItem(QGraphicsItem* const item, PLEScene* const scene)
+{
+    AbstractPhoto* const photo = dynamic_cast<AbstractPhoto*>(item);
+
+    if (photo)
+        return !photo->isSelected();
+
+    return (item == scene->background() || item == scene->border());
+}
+
+void PLECanvas::beginStaticLayer()
+{
+    if (!d->m_static_layer_enabled || d->m_static_layer_active || !m_scene)
+        return;
+
+    QList<QGraphicsItem*> items;
+
+    foreach (QGraphicsItem* const item, m_scene->items())
+    {
+        if (!item->parentItem() && !(item->flags() & QGraphicsItem::ItemHasNoContents))
+            items << item;
+    }
+
+    // Items are listed from the top one. Static items above and below all the others are flattened,
+    // the ones stacked between the painting items stay live, so the stacking order is kept.
+    QList<QGraphicsItem*> upperItems;
+    QList<QGraphicsItem*> lowerItems;
+    int top = 0;
+
+    while (top < items.count() && isStaticItem(items.at(top), m_scene))
+        upperItems << items.at(top++);
+
+    if (top == items.count())
+        upperItems.swap(lowerItems);
+
+    for (int i = items.count() - 1 ; i >= top && isStaticItem(items.at(i), m_scene) ; --i)
+        lowerItems.prepend(items.at(i));
+
+    // Each composite is rendered only with its items, the scene foreground isn't rendered
+
+    QList<QGraphicsItem*> hiddenItems = items;
+
+    foreach (QGraphicsItem* const item, lowerItems)
+        hiddenItems.removeOne(item);
+
+    d->m_static_layer = renderStaticLayer(hiddenItems, false);
+
+    if (!upperItems.isEmpty())
+    {
+        hiddenItems = items;
+
+        foreach (QGraphicsItem* const item, upperItems)
+            hiddenItems.removeOne(item);
+
+        d->m_upper_static_layer = renderStaticLayer(hiddenItems, true);
+    }
+
+    // Flattened items stop painting themselves, any change of them drops the composites
+
+    foreach (QGraphicsItem* const item, lowerItems + upperItems)
+    {
+        QObject* const object = dynamic_cast<QObject*>(item);
+
+        if (!object)
+            continue;
+
+        item->setFlag(QGraphicsItem::ItemHasNoContents, true);
+        d->m_static_items << QPointer<QObject>(object);
+
+        connect(object, SIGNAL(changed()),
+                this, SLOT(endStaticLayer()));
+    }
+
+    d->m_static_layer_active = true;
+    this->viewport()->update();
+}
+
+QImage PLECanvas::renderStaticLayer(const QList<QGraphicsItem*>& hiddenItems, bool upper)
+{
+    const qreal ratio = this->viewport()->devicePixelRatioF();
+    QImage layer(this->viewport()->size() * ratio, QImage::Format_ARGB32_Premultiplied);
+    layer.setDevicePixelRatio(ratio);
+    layer.fill(Qt::transparent);
+
+    foreach (QGraphicsItem* const item, hiddenItems)
+        item->setFlag(QGraphicsItem::ItemHasNoContents, true);
+
+    {
+        QPainter p(&layer);
+        p.setRenderHints(this->renderHints());
+        d->m_rendering_static_layer = true;
+        d->m_rendering_upper_layer  = upper;
+        this->render(&p, QRectF(QPointF(0, 0), QSizeF(this->viewport()->size())), this->viewport()->rect());
+        d->m_rendering_static_layer = false;
+        d->m_rendering_upper_layer  = false;
+    }
+
+    foreach (QGraphicsItem* const item, hiddenItems)
+        item->setFlag(QGraphicsItem::ItemHasNoContents, false);
+
+    return layer;
+}
+
+void PLECanvas::endStaticLayer()
+{
+    if (!d->m_static_layer_active)
+        return;
+
+    foreach (const QPointer<QObject>& object, d->m_static_items)
+    {
+        if (!object)
+            continue;
+
+        disconnect(object, SIGNAL(changed()),
+                   this, SLOT(endStaticLayer()));
+
+        QGraphicsItem* const item = dynamic_cast<QGraphicsItem*>(object.data());
+
+        if (item)
+            item->setFlag(QGraphicsItem::ItemHasNoContents, false);
+    }
+
+    d->m_static_items.clear();
+    d->m_static_layer        = QImage();
+    d->m_upper_static_layer  = QImage();
+    d->m_static_layer_active = false;
+    this->viewport()->update();
+}
+
+/// Copies exposed part of the composite in viewport coordinates
+static void drawStaticLayer(QPainter* painter, const QRectF& rect, const QImage& layer, const QRect& viewport)
+{
+    const qreal ratio  = layer.devicePixelRatio();
+    const QRect target = painter->worldTransform().mapRect(rect).toAlignedRect() & viewport;
+
+    painter->save();
+    painter->resetTransform();
+    painter->drawImage(QRectF(target), layer,
+                       QRectF(QPointF(target.topLeft()) * ratio, QSizeF(target.size()) * ratio));
+    painter->restore();
+}
+
+void PLECanvas::drawBackground(QPainter* painter, const QRectF& rect)
+{
+    // Upper composite is painted over the lower one, it has no background
+    if (d->m_rendering_upper_layer)
+        return;
+
+    if (!d->m_static_layer_active)
+    {
+        QGraphicsView::drawBackground(painter, rect);
+        return;
+    }
+
+    drawStaticLayer(painter, rect, d->m_static_layer, this->viewport()->rect());
+}
+
+void PLECanvas::drawForeground(QPainter* painter, const QRectF& rect)
+{
+    // Grid and selection outlines follow the interaction, they aren't flattened
+    if (d->m_rendering_static_layer)
+        return;
+
+    // Items stacked above the selection cover the dragged items
+    if (d->m_static_layer_active && !d->m_upper_static_layer.isNull())
+        drawStaticLayer(painter, rect, d->m_upper_static_layer, this->viewport()->rect());
+
+    QGraphicsView::drawForeground(painter, rect);
+}
+
+void PLECanvas::scrollContentsBy(int dx, int dy)
+{
+    this->endStaticLayer();
+    QGraphicsView::scrollContentsBy(dx, dy);
+
+    // View scrolls while the scene is set up, before the canvas is initialized
+    if (d->m_detail_timer)
+        d->m_detail_timer->start();
+}
+
+void PLECanvas::resizeEvent(QResizeEvent* event)
+{
+    this->endStaticLayer();
+    QGraphicsView::resizeEvent(event);
+
+    if (d->m_detail_timer)
+        d->m_detail_timer->start();
+}
+
 void PLECanvas::imageLoaded(const QUrl& url, const QImage& image)
 {
     if (!image.isNull())
@@ -345,7 +633,7 @@ void PLECanvas::moveRowsCommand(const QModelIndex& startIndex, int count, const
         return;
 
     UndoMoveRowsCommand* undo = new UndoMoveRowsCommand(startIndex.row(), count, parentIndex, destination, destinationParent, model());
-    m_undo_stack->push(undo);
+    m_photobook->push(undo);
 }
 
 void PLECanvas::moveSelectedRowsUp()
@@ -672,7 +960,7 @@ void PLECanvas::refreshWidgetConnections(bool isVisible)
 
 void PLECanvas::newUndoCommand(QUndoCommand* command)
 {
-    m_undo_stack->push(command);
+    m_photobook->push(command);
 }
 
 void PLECanvas::progressEvent(ProgressEvent* event)
@@ -743,10 +1031,51 @@ void PLECanvas::progressEvent(ProgressEvent* event)
 
 void PLECanvas::wheelEvent(QWheelEvent* event)
 {
-    int steps = event->delta() / 120;
-    double scaleFactor;
-    scaleFactor = (m_scale_factor + steps * 0.1) / m_scale_factor;
-    scale(scaleFactor, event->pos());
+    // Wheel events are accumulated and applied once per frame, the first one immediately
+    d->m_zoom_delta  += event->angleDelta().y();
+    d->m_zoom_center  = event->pos();
+
+    if (!d->m_zooming)
+    {
+        d->m_zooming = true;
+        this->setRenderHint(QPainter::Antialiasing, false);
+        this->setRenderHint(QPainter::SmoothPixmapTransform, false);
+    }
+
+    if (!d->m_zoom_timer->isActive())
+    {
+        this->applyZoom();
+        d->m_zoom_timer->start();
+    }
+
+    // Full quality repaint is done once the wheel stops
+    d->m_zoom_settle_timer->start();
+    event->accept();
+}
+
+void PLECanvas::applyZoom()
+{
+    if (!d->m_zoom_delta)
+        return;
+
+    const double steps = d->m_zoom_delta / 120.0;
+    d->m_zoom_delta    = 0;
+    scale((m_scale_factor + steps * 0.1) / m_scale_factor, d->m_zoom_center);
+}
+
+void PLECanvas::finishZoom()
+{
+    d->m_zoom_timer->stop();
+    this->applyZoom();
+
+    d->m_zooming = false;
+    this->setAntialiasing(d->m_antialiasing);
+    this->updateLevelsOfDetail();
+}
+
+bool PLECanvas::isZooming() const
+{
+    return d->m_zooming;
 }
 
 QDomDocument PLECanvas::toSvg() const
@@ -846,26 +1175,39 @@ PLECanvas* PLECanvas::fromSvg(QDomDocument& document)
 
                 if (dimension.isValid())
                 {
-                    QDomElement sceneElement = element.firstChildElement(QLatin1String("g"));
+                    PLEPhotobook* const photobook = new PLEPhotobook(size);
 
-                    while (!sceneElement.isNull() && sceneElement.attribute(QLatin1String("id")) != QLatin1String("PLEScene"))
-                        sceneElement = sceneElement.nextSiblingElement(QLatin1String("g"));
+                    // Each page has its scene element, see PLECanvasSavingThread
+                    for (QDomElement sceneElement = element.firstChildElement(QLatin1String("g")) ; !sceneElement.isNull() ;
+                         sceneElement = sceneElement.nextSiblingElement(QLatin1String("g")))
+                    {
+                        if (sceneElement.attribute(QLatin1String("id")).startsWith(QLatin1String("PLEScene")))
+                            photobook->appendPage(sceneElement);
+                    }
 
-                    PLEScene* scene = PLEScene::fromSvg(sceneElement);
+                    photobook->setCurrentPage(0);
 
-                    if (scene)
+                    if (photobook->currentPage() == 0)
                     {
-                        result = new PLECanvas(scene);
+                        result = new PLECanvas(photobook);
                         result->setEnabled(false);
                         result->d->m_size = size;
                         result->d->m_template = (pageElement.namespaceURI() == PhotoLayoutsEditor::templateUri());
                     }
+                    else
+                    {
+                        delete photobook;
+                    }
                 }
             }
-            else
+            else if (PLEWindow::hasInstance())
             {
                 QMessageBox::critical(qApp->activeWindow(), QObject::tr("Error"), QObject::tr("Invalid image size!"));
             }
+            else
+            {
+                qDebug() << "Invalid image size:" << width << height;
+            }
         }
     }
 
@@ -878,6 +1220,9 @@ void PLECanvas::scale(qreal factor, const QPoint& center)
     if (factor <= 0 || !scene() || ((m_scale_factor*factor <= 0.1 && factor < 1) || (m_scale_factor*factor > 7)))
         return;
 
+    // Composite was rendered for the previous zoom
+    this->endStaticLayer();
+
     QGraphicsView::scale(factor, factor);
 
     if (center.isNull())
@@ -886,6 +1231,22 @@ void PLECanvas::scale(qreal factor, const QPoint& center)
         centerOn( mapToScene(center) );
 
     m_scale_factor *= factor;
+
+    // Previews for intermediate zoom steps of the gesture aren't rendered
+    if (!d->m_zooming)
+        this->updateLevelsOfDetail();
+}
+
+void PLECanvas::updateLevelsOfDetail()
+{
+    // Effects previews are rendered at view resolution, photos far from the visible area release their images
+    foreach (QGraphicsItem* const item, m_scene->items())
+    {
+        PhotoItem* const photo = dynamic_cast<PhotoItem*>(item);
+
+        if (photo)
+            photo->updateLevelOfDetail();
+    }
 }
 
 void PLECanvas::scale(const QRect& rect)
@@ -942,6 +1303,9 @@ void PLECanvas::save(const QUrl& fileUrl, bool setAsDefault)
     if (setAsDefault)
        m_file = tempFile;
 
+    // Canvas can be edited while it's being saved, the saved state is the one from now
+    m_saving_on_index = m_undo_stack->index();
+
     PLECanvasSavingThread* thread = new PLECanvasSavingThread(this);
 
     connect(thread, SIGNAL(saved()),
@@ -960,6 +1324,9 @@ void PLECanvas::saveTemplate(const QUrl& fileUrl)
         return;
     }
 
+    // Canvas can be edited while it's being saved, the saved state is the one from now
+    m_saving_on_index = m_undo_stack->index();
+
     PLECanvasSavingThread* thread = new PLECanvasSavingThread(this);
 
     connect(thread, SIGNAL(saved()),
@@ -997,21 +1364,17 @@ bool PLECanvas::isTemplate() const
 
 void PLECanvas::savingFinished()
 {
-    m_is_saved       = true;
-    m_saved_on_index = m_undo_stack->index();
+    m_saved_on_index = m_saving_on_index;
+    m_is_saved       = (m_saved_on_index == m_undo_stack->index());
 
     Q_EMIT savedStateChanged();
 }
 
 void PLECanvas::renderPLECanvas(QPaintDevice* device)
 {
+    // Scene is rendered from its snapshot, which doesn't contain grid and selection
     if (scene())
     {
-        scene()->setSelectionVisible(false);
-        bool isGridVisible = scene()->isGridVisible();
-        scene()->setGridVisible(false);
-
-        scene()->setSelectionVisible(false);
         QPainter p(device);
 
         if (d->m_size.sizeUnit() != PLECanvasSize::Pixels &&
@@ -1024,15 +1387,44 @@ void PLECanvas::renderPLECanvas(QPaintDevice* device)
 
         scene()->render(&p, scene()->sceneRect(), scene()->sceneRect());
         p.end();
-
-        scene()->setSelectionVisible(true);
-        scene()->setGridVisible(isGridVisible);
     }
 }
 
 void PLECanvas::renderPLECanvas(QPrinter* device)
 {
-    renderPLECanvas(static_cast<QPaintDevice*>(device));
+    if (!scene())
+        return;
+
+    // Canvas is printed in its physical size, so photos are captured at the printer resolution
+    qreal resolution = 1.0;
+
+    if (d->m_size.sizeUnit() != PLECanvasSize::Pixels &&
+        d->m_size.sizeUnit() != PLECanvasSize::UnknownSizeUnit)
+    {
+        resolution = device->resolution() / d->m_size.resolution(PLECanvasSize::PixelsPerInch).width();
+    }
+
+    PLEPrintRenderer renderer(device);
+
+    // Printer ICC profile, pages are printed in sRGB without it
+    QSettings config(QLatin1String("PhotoLayoutEditor"));
+    config.beginGroup(QLatin1String("Print"));
+    const QString profilePath = config.value(QLatin1String("ColorProfile"), QString()).toString();
+    const int intent          = config.value(QLatin1String("RenderingIntent"), int(PLEColorTransform::Perceptual)).toInt();
+    config.endGroup();
+
+    if (!profilePath.isEmpty())
+    {
+        const PLEIccProfile profile = PLEIccProfile::fromFile(profilePath);
+
+        if (profile.isNull())
+            qDebug() << "Can't use color profile" << profilePath << ":" << profile.errorString();
+        else
+            renderer.setColorProfile(profile, PLEColorTransform::RenderingIntent(qBound(0, intent, 3)));
+    }
+
+    if (!renderer.print(QList<PLESceneSnapshot>() << PLESceneSnapshot::capture(scene(), resolution)))
+        qDebug() << "Printing failed:" << renderer.errorString();
 }
 
 void PLECanvas::beginRowsRemoving()
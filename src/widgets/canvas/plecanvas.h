@@ -51,6 +51,7 @@ namespace PhotoLayoutsEditor
 class PLECanvasPrivate;
 class PLECanvasSavingThread;
 class PLEScene;
+class PLEPhotobook;
 class LayersModel;
 class LayersSelectionModel;
 class AbstractPhoto;
@@ -83,6 +84,9 @@ public:
     void scale(qreal factor, const QPoint& center = QPoint());
     void scale(const QRect& rect);
 
+    /// Returns true during wheel zoom gesture, items are painted with fast sampling meanwhile
+    bool isZooming() const;
+
     /// Hold URL to the file connected with this canvas.
     Q_PROPERTY(QUrl m_file READ file WRITE setFile)
     QUrl file() const;
@@ -103,11 +107,18 @@ public:
     /// Set selection mode
     void setSelectionMode(SelectionMode mode);
 
+    /// Scene of the current page
     PLEScene* scene() const
     {
         return m_scene;
     }
 
+    /// Pages of the canvas, they share its undo stack
+    PLEPhotobook* photobook() const
+    {
+        return m_photobook;
+    }
+
     LayersModel* model() const;
 
     LayersSelectionModel* selectionModel() const;
@@ -146,6 +157,9 @@ public Q_SLOTS:
 
     void setAntialiasing(bool antialiasing);
 
+    /// Enables painting of not moved items from one cached image while the selection is dragged
+    void setStaticLayerCaching(bool enabled);
+
     void enable()
     {
         this->setEnabled(true);
@@ -190,7 +204,7 @@ public Q_SLOTS:
     /// Draws whole canvas onto the QPaintDevice
     void renderPLECanvas(QPaintDevice* device);
 
-    /// Draws whole canvas content onto the printer
+    /// Prints whole canvas content in bands rendered at the printer resolution
     void renderPLECanvas(QPrinter* device);
 
     /// Groups operations into one undo operation
@@ -242,31 +256,53 @@ Q_SIGNALS:
     void setInitialValues(qreal width, Qt::PenJoinStyle cornersStyle, const QColor& color);
     void savedStateChanged();
 
+    /// Emitted when the canvas has switched to the scene of another page
+    void pageChanged(int index);
+
 protected Q_SLOTS:
 
     /// Used when new item has been created and needs to be added to the scene and to the model
     void addNewItem(AbstractPhoto* item);
     void imageLoaded(const QUrl& url, const QImage& image);
 
+protected:
+
+    void drawBackground(QPainter* painter, const QRectF& rect) override;
+    void drawForeground(QPainter* painter, const QRectF& rect) override;
+    void scrollContentsBy(int dx, int dy) override;
+    void resizeEvent(QResizeEvent* event) override;
+
 private Q_SLOTS:
 
     void savingFinished();
+    void showPage(int index);
+    void beginStaticLayer();
+    void endStaticLayer();
+    void applyZoom();
+    void updateLevelsOfDetail();
+    void finishZoom();
 
 private:
 
-    explicit PLECanvas(PLEScene* scene, QWidget* parent = nullptr);
+    explicit PLECanvas(PLEPhotobook* photobook, QWidget* parent = nullptr);
 
     void init();
     void setupGUI();
     void prepareSignalsConnection();
+    void prepareSceneConnection();
+
+    /// Renders the view without the hidden items, the upper layer has no background
+    QImage renderStaticLayer(const QList<QGraphicsItem*>& hiddenItems, bool upper);
 
 private:
 
     QUrl          m_file;
     bool          m_is_saved;
     int           m_saved_on_index;
+    int           m_saving_on_index;
 
-    PLEScene*        m_scene;
+    PLEPhotobook* m_photobook;
+    PLEScene*     m_scene;
     QUndoStack*   m_undo_stack;
     double        m_scale_factor;
 
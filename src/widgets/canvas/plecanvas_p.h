@@ -30,6 +30,10 @@
 // Qt includes
 
 #include <QMap>
+#include <QList>
+#include <QImage>
+#include <QPointer>
+#include <QTimer>
 #include <QProgressBar>
 
 // Local includes
@@ -46,7 +50,17 @@ class PLECanvasPrivate
 public:
 
     PLECanvasPrivate()
-        : m_template(false)
+        : m_template(false),
+          m_static_layer_enabled(true),
+          m_static_layer_active(false),
+          m_rendering_static_layer(false),
+          m_rendering_upper_layer(false),
+          m_antialiasing(false),
+          m_zooming(false),
+          m_zoom_delta(0),
+          m_zoom_timer(nullptr),
+          m_zoom_settle_timer(nullptr),
+          m_detail_timer(nullptr)
     {
     }
 
@@ -54,6 +68,28 @@ public:
     bool                          m_template;
     QMap<QObject*, QProgressBar*> progressMap;
 
+    // Background, border and unselected items stacked below and above the painting items are flattened into
+    // two images while the selection is dragged. Items stacked between the dragged ones paint themselves.
+    // Flattened items don't paint themselves until the drag ends or any of them changes.
+    bool                          m_static_layer_enabled;
+    bool                          m_static_layer_active;
+    bool                          m_rendering_static_layer;
+    bool                          m_rendering_upper_layer;
+    QImage                        m_static_layer;
+    QImage                        m_upper_static_layer;
+    QList<QPointer<QObject> >     m_static_items;
+
+    // Wheel zoom is applied once per frame and painted with fast sampling until the gesture settles
+    bool                          m_antialiasing;
+    bool                          m_zooming;
+    int                           m_zoom_delta;
+    QPoint                        m_zoom_center;
+    QTimer*                       m_zoom_timer;
+    QTimer*                       m_zoom_settle_timer;
+
+    // Photos entering and leaving the visible area are updated once scrolling stops
+    QTimer*                       m_detail_timer;
+
 public:
 
     friend class PLECanvas;
@@ -0,0 +1,746 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2020-06-12
+ * Description : multi-page photobook document.
+ *
+ * Copyright (C) 2020      by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+
+
+#include "plephotobook.h"
+
+// Qt includes
+
+#include <QDir>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QHash>
+#include <QMap>
+#include <QPainter>
+#include <QQueue>
+#include <QSet>
+#include <QSharedPointer>
+#include <QThread>
+#include <QUndoStack>
+#include <QDebug>
+
+// Local includes
+
+#include "plescene.h"
+#include "plesvgimagestore.h"
+#include "plescenesnapshot.h"
+#include "pleexportjob.h"
+#include "plepdfexporter.h"
+
+#define THUMBNAIL_SIZE 256
+
+namespace PhotoLayoutsEditor
+{
+
+/// Command of the page pushed onto the shared stack, it counts commands of pages present in the stack
+class PLEPageCommand : public QUndoCommand
+{
+    QUndoCommand*    m_command;
+    PLEPhotobook*    m_photobook;
+    int              m_page;
+    QHash<int, int>* m_counts;
+
+public:
+
+    PLEPageCommand(QUndoCommand* command, PLEPhotobook* photobook, int page, QHash<int, int>* counts)
+        : QUndoCommand(command->text()),
+          m_command(command),
+          m_photobook(photobook),
+          m_page(page),
+          m_counts(counts)
+    {
+        ++(*m_counts)[m_page];
+    }
+
+    ~PLEPageCommand() override
+    {
+        if (--(*m_counts)[m_page] <= 0)
+            m_counts->remove(m_page);
+
+        delete m_command;
+    }
+
+    void redo() override
+    {
+        m_photobook->showPage(m_page);
+        m_command->redo();
+    }
+
+    void undo() override
+    {
+        m_photobook->showPage(m_page);
+        m_command->undo();
+    }
+
+    int id() const override
+    {
+        return m_command->id();
+    }
+
+    bool mergeWith(const QUndoCommand* other) override
+    {
+        // Commands with the same id are always page commands
+        const PLEPageCommand* const command = static_cast<const PLEPageCommand*>(other);
+
+        if (command->m_page != m_page || !m_command->mergeWith(command->m_command))
+            return false;
+
+        setText(m_command->text());
+
+        return true;
+    }
+};
+
+/// Inserts or removes the page, the photobook keeps the removed page as long as the command can restore it
+class PLEPageInsertCommand : public QUndoCommand
+{
+    PLEPhotobook* m_photobook;
+    int           m_page;
+    int           m_index;
+    bool          m_insert;
+
+public:
+
+    PLEPageInsertCommand(PLEPhotobook* photobook, int page, int index, bool insert)
+        : QUndoCommand(insert ? QObject::tr("Insert page") : QObject::tr("Remove page")),
+          m_photobook(photobook),
+          m_page(page),
+          m_index(index),
+          m_insert(insert)
+    {
+    }
+
+    ~PLEPageInsertCommand() override
+    {
+        // Page is dropped only if the command holds it
+        m_photobook->dropPage(m_page);
+    }
+
+    void redo() override
+    {
+        if (m_insert)
+            m_photobook->attachPage(m_page, m_index);
+        else
+            m_photobook->detachPage(m_page);
+    }
+
+    void undo() override
+    {
+        if (m_insert)
+            m_photobook->detachPage(m_page);
+        else
+            m_photobook->attachPage(m_page, m_index);
+    }
+};
+
+class PLEPhotobook::Private
+{
+public:
+
+    /// Page is either loaded as a live scene or kept in its compact form
+    struct Page
+    {
+        Page()
+            : id(0),
+              scene(nullptr),
+              thumbnailValid(false)
+        {
+        }
+
+        int         id;
+        QByteArray  data;           ///< Compressed scene element, images are placeholders of the shared cache
+        QStringList images;         ///< Images of the shared cache used by data
+        PLEScene*   scene;
+        QImage      thumbnail;
+        bool        thumbnailValid;
+    };
+
+public:
+
+    explicit Private(const PLECanvasSize& pageSize)
+        : size(pageSize),
+          current(-1),
+          neighbours(1),
+          nextId(1),
+          undoStack(nullptr),
+          loop(nullptr),
+          starting(false),
+          exportDpi(0)
+    {
+    }
+
+    int indexOf(const PLEScene* scene) const
+    {
+        for (int i = 0 ; i < pages.count() ; ++i)
+        {
+            if (pages.at(i).scene == scene)
+                return i;
+        }
+
+        return -1;
+    }
+
+    int indexOf(int id) const
+    {
+        for (int i = 0 ; i < pages.count() ; ++i)
+        {
+            if (pages.at(i).id == id)
+                return i;
+        }
+
+        return -1;
+    }
+
+    bool hasCommands(int id) const
+    {
+        return commandCounts.contains(id);
+    }
+
+    /// Drops images of the cache which aren't used by any page
+    void pruneImages()
+    {
+        QSet<QString> used;
+
+        foreach (const Page& page, pages + detached.values())
+        {
+            foreach (const QString& key, page.images)
+                used.insert(key);
+        }
+
+        images.retain(used);
+    }
+
+    void renderThumbnail(Page& page)
+    {
+        const QRectF sceneRect = page.scene->sceneRect();
+        const QSize size       = sceneRect.size().scaled(THUMBNAIL_SIZE, THUMBNAIL_SIZE, Qt::KeepAspectRatio).toSize();
+
+        if (size.isEmpty())
+            return;
+
+        page.thumbnail = QImage(size, QImage::Format_ARGB32_Premultiplied);
+        page.thumbnail.fill(Qt::white);
+
+        QPainter p(&page.thumbnail);
+        p.setRenderHint(QPainter::SmoothPixmapTransform);
+        page.scene->render(&p, QRectF(QPointF(0, 0), QSizeF(size)), sceneRect);
+        p.end();
+
+        page.thumbnailValid = true;
+    }
+
+    static void waitForLoading(PLEScene* const scene)
+    {
+        if (!scene->isLoading())
+            return;
+
+        QEventLoop loop;
+        QObject::connect(scene, SIGNAL(loadingFinished()), &loop, SLOT(quit()));
+        loop.exec();
+    }
+
+public:
+
+    PLECanvasSize                     size;
+    QList<Page>                       pages;
+    int                               current;
+    int                               neighbours;
+    int                               nextId;
+
+    /// Pages removed by commands of the undo stack, by their ids
+    QMap<int, Page>                   detached;
+
+    QUndoStack*                       undoStack;
+
+    /// Number of commands of pages (by their ids) present in the undo stack
+    QHash<int, int>                   commandCounts;
+
+    /// Image cache shared by compact forms of all pages
+    PLESvgImageStore                  images;
+
+    QQueue<int>                       exportQueue;
+    QList<PLEExportJob*>              running;
+    QStringList                       errors;
+    QEventLoop*                       loop;
+    bool                              starting;
+    QString                           exportFile;
+    QByteArray                        exportFormat;
+    qreal                             exportDpi;
+};
+
+PLEPhotobook::PLEPhotobook(const PLECanvasSize& size, QObject* parent)
+    : QObject(parent),
+      d(new Private(size))
+{
+    d->undoStack = new QUndoStack(this);
+    d->images.share();
+}
+
+PLEPhotobook::~PLEPhotobook()
+{
+    // Job's destructor waits until it's finished
+    foreach (PLEExportJob* const job, d->running)
+    {
+        job->cancel();
+        delete job;
+    }
+
+    // Commands refer to items of the scenes, removed pages are dropped with their commands
+    d->undoStack->clear();
+
+    foreach (const Private::Page& page, d->pages + d->detached.values())
+        delete page.scene;
+
+    delete d;
+}
+
+PLECanvasSize PLEPhotobook::pageSize() const
+{
+    return d->size;
+}
+
+void PLEPhotobook::setPageSize(const PLECanvasSize& size)
+{
+    if (!size.isValid())
+        return;
+
+    d->size = size;
+
+    // Unloaded pages get the size when they're loaded
+    const QRectF sceneRect(QPointF(0, 0), d->size.size(PLECanvasSize::Pixels));
+
+    foreach (const Private::Page& page, d->pages + d->detached.values())
+    {
+        if (page.scene)
+            page.scene->setSceneRect(sceneRect);
+    }
+}
+
+int PLEPhotobook::count() const
+{
+    return d->pages.count();
+}
+
+void PLEPhotobook::appendPage(const QDomElement& sceneElement)
+{
+    Private::Page page;
+    page.id = d->nextId++;
+
+    if (!sceneElement.isNull())
+    {
+        QDomDocument document;
+        QDomElement element = document.importNode(sceneElement, true).toElement();
+
+        // Pages after the first one are stored under their own ids and hidden for other SVG viewers
+        element.setAttribute(QLatin1String("id"), QLatin1String("PLEScene"));
+        element.removeAttribute(QLatin1String("visibility"));
+        document.appendChild(element);
+
+        page.data = qCompress(document.toByteArray(-1));
+    }
+
+    d->pages << page;
+
+    Q_EMIT pageInserted(d->pages.count() - 1);
+}
+
+void PLEPhotobook::insertPage(int index)
+{
+    Private::Page page;
+    page.id = d->nextId++;
+    d->detached.insert(page.id, page);
+
+    d->undoStack->push(new PLEPageInsertCommand(this, page.id, qBound(0, index, d->pages.count()), true));
+}
+
+void PLEPhotobook::removePage(int index)
+{
+    if (index < 0 || index >= d->pages.count() || d->pages.count() < 2)
+        return;
+
+    d->undoStack->push(new PLEPageInsertCommand(this, d->pages.at(index).id, index, false));
+}
+
+void PLEPhotobook::attachPage(int id, int index)
+{
+    if (!d->detached.contains(id))
+        return;
+
+    index = qBound(0, index, d->pages.count());
+    d->pages.insert(index, d->detached.take(id));
+
+    if (d->current >= index)
+        ++d->current;
+
+    Q_EMIT pageInserted(index);
+
+    setCurrentPage(index);
+}
+
+void PLEPhotobook::detachPage(int id)
+{
+    const int index = d->indexOf(id);
+
+    if (index < 0 || d->pages.count() < 2)
+        return;
+
+    // Views leave the page before it's removed
+    if (index == d->current)
+        setCurrentPage(index + 1 < d->pages.count() ? index + 1 : index - 1);
+
+    if (index == d->current)
+        return;
+
+    d->detached.insert(id, d->pages.takeAt(index));
+
+    if (d->current > index)
+        --d->current;
+
+    Q_EMIT pageRemoved(index);
+}
+
+void PLEPhotobook::dropPage(int id)
+{
+    if (!d->detached.contains(id))
+        return;
+
+    delete d->detached.take(id).scene;
+    d->pruneImages();
+}
+
+void PLEPhotobook::showPage(int id)
+{
+    const int index = d->indexOf(id);
+
+    if (index >= 0)
+        setCurrentPage(index);
+}
+
+int PLEPhotobook::currentPage() const
+{
+    return d->current;
+}
+
+void PLEPhotobook::setLoadedNeighbours(int count)
+{
+    d->neighbours = qMax(0, count);
+    unloadDistantPages();
+}
+
+int PLEPhotobook::loadedNeighbours() const
+{
+    return d->neighbours;
+}
+
+void PLEPhotobook::setCurrentPage(int index)
+{
+    if (index < 0 || index >= d->pages.count() || index == d->current || !scene(index))
+        return;
+
+    d->current = index;
+
+    Q_EMIT currentPageChanged(index);
+
+    // Neighbours are loaded in advance, so turning the page doesn't wait for loading
+    for (int i = qMax(0, index - d->neighbours) ; i <= qMin(d->pages.count() - 1, index + d->neighbours) ; ++i)
+        scene(i);
+
+    unloadDistantPages();
+}
+
+PLEScene* PLEPhotobook::scene(int index)
+{
+    if (index < 0 || index >= d->pages.count())
+        return nullptr;
+
+    Private::Page& page = d->pages[index];
+
+    if (page.scene)
+        return page.scene;
+
+    const QRectF sceneRect(QPointF(0, 0), d->size.size(PLECanvasSize::Pixels));
+
+    if (page.data.isEmpty())
+    {
+        page.scene = new PLEScene(sceneRect, this);
+    }
+    else
+    {
+        QDomDocument document;
+
+        if (!document.setContent(qUncompress(page.data), true))
+        {
+            qDebug() << "Can't read page" << index;
+            return nullptr;
+        }
+
+        QDomElement sceneElement = document.documentElement();
+        page.scene               = PLEScene::fromSvg(sceneElement);
+
+        if (!page.scene)
+            return nullptr;
+
+        page.scene->setParent(this);
+
+        // Page size could be changed while the page was unloaded
+        page.scene->setSceneRect(sceneRect);
+
+        connect(page.scene, SIGNAL(loadingFinished()),
+                this, SLOT(sceneLoaded()));
+    }
+
+    connect(page.scene, SIGNAL(changed(QList<QRectF>)),
+            this, SLOT(sceneChanged()));
+
+    return page.scene;
+}
+
+bool PLEPhotobook::isLoaded(int index) const
+{
+    return (index >= 0 && index < d->pages.count() && d->pages.at(index).scene);
+}
+
+QImage PLEPhotobook::thumbnail(int index)
+{
+    if (index < 0 || index >= d->pages.count())
+        return QImage();
+
+    Private::Page& page = d->pages[index];
+
+    if (page.scene && !page.thumbnailValid && !page.scene->isLoading())
+        d->renderThumbnail(page);
+
+    return page.thumbnail;
+}
+
+QUndoStack* PLEPhotobook::undoStack() const
+{
+    return d->undoStack;
+}
+
+void PLEPhotobook::push(QUndoCommand* command)
+{
+    if (d->current < 0)
+    {
+        d->undoStack->push(command);
+        return;
+    }
+
+    d->undoStack->push(new PLEPageCommand(command, this, d->pages.at(d->current).id, &d->commandCounts));
+}
+
+QDomDocument PLEPhotobook::pageSvg(int index)
+{
+    if (index < 0 || index >= d->pages.count())
+        return QDomDocument();
+
+    const Private::Page& page = d->pages.at(index);
+
+    // Items of a page still being loaded aren't complete, its compact form is
+    if (page.scene && (!page.scene->isLoading() || page.data.isEmpty()))
+        return page.scene->toSvg(nullptr);
+
+    QDomDocument document;
+
+    if (!document.setContent(qUncompress(page.data), true))
+        return QDomDocument();
+
+    // Placeholders of the shared cache are the ones of the active store, as both use the image cache keys
+    foreach (const QString& key, page.images)
+        PLESvgImageStore::svgImageData(PLESvgImageStore::svgImage(key));
+
+    return document;
+}
+
+bool PLEPhotobook::unload(int index)
+{
+    Private::Page& page = d->pages[index];
+
+    if (!page.scene || page.scene->isLoading() || index == d->current || d->hasCommands(page.id))
+        return false;
+
+    if (!page.thumbnailValid)
+        d->renderThumbnail(page);
+
+    // Images are kept in the shared cache, so the page is stored without encoding them
+    PLESvgImageStore pageImages;
+    pageImages.setInternalCopy(true);
+    pageImages.begin();
+    const QDomDocument document = page.scene->toSvg(nullptr);
+    pageImages.end();
+
+    d->images.insert(pageImages);
+    page.images = pageImages.keys();
+    page.data   = qCompress(document.toByteArray(-1));
+
+    delete page.scene;
+    page.scene = nullptr;
+    d->pruneImages();
+
+    return true;
+}
+
+void PLEPhotobook::unloadDistantPages()
+{
+    if (d->current < 0)
+        return;
+
+    for (int i = 0 ; i < d->pages.count() ; ++i)
+    {
+        if (qAbs(i - d->current) > d->neighbours)
+            unload(i);
+    }
+}
+
+void PLEPhotobook::sceneChanged()
+{
+    const int index = d->indexOf(qobject_cast<PLEScene*>(sender()));
+
+    if (index < 0 || !d->pages.at(index).thumbnailValid)
+        return;
+
+    d->pages[index].thumbnailValid = false;
+
+    Q_EMIT thumbnailChanged(index);
+}
+
+void PLEPhotobook::sceneLoaded()
+{
+    const int index = d->indexOf(qobject_cast<PLEScene*>(sender()));
+
+    if (index < 0)
+        return;
+
+    // Thumbnail of the page is rendered from its items now
+    d->pages[index].thumbnailValid = false;
+
+    Q_EMIT thumbnailChanged(index);
+}
+
+QString PLEPhotobook::pageFileName(const QString& fileName, int index) const
+{
+    const QFileInfo file(fileName);
+    const int digits     = QString::number(d->pages.count()).length();
+    const QString number = QString::fromLatin1("%1").arg(index + 1, digits, 10, QLatin1Char('0'));
+
+    return file.dir().filePath(file.completeBaseName() + QLatin1Char('-') + number + QLatin1Char('.') + file.suffix());
+}
+
+bool PLEPhotobook::exportPages(const QString& fileName, const QByteArray& format, qreal dpi)
+{
+    if (d->loop)
+        return false;
+
+    d->errors.clear();
+    d->exportQueue.clear();
+
+    for (int i = 0 ; i < d->pages.count() ; ++i)
+        d->exportQueue.enqueue(i);
+
+    d->exportFile   = fileName;
+    d->exportFormat = format.toLower();
+    d->exportDpi    = dpi;
+
+    QEventLoop loop;
+    d->loop = &loop;
+
+    startExportJobs();
+
+    if (!d->running.isEmpty())
+        loop.exec();
+
+    d->loop = nullptr;
+
+    return d->errors.isEmpty();
+}
+
+QStringList PLEPhotobook::errors() const
+{
+    return d->errors;
+}
+
+void PLEPhotobook::startExportJobs()
+{
+    // Loading of a page runs an event loop, which delivers finished jobs
+    if (d->starting)
+        return;
+
+    d->starting = true;
+
+    while (d->running.count() < qMax(1, QThread::idealThreadCount()) && !d->exportQueue.isEmpty())
+    {
+        const int index       = d->exportQueue.dequeue();
+        const bool loaded     = isLoaded(index);
+        PLEScene* const scene = this->scene(index);
+
+        if (!scene)
+        {
+            d->errors << QObject::tr("Can't load page %1").arg(index + 1);
+            continue;
+        }
+
+        Private::waitForLoading(scene);
+
+        // Pages have physical size of the book at the requested resolution
+        const qreal pageDpi    = d->size.resolution(PLECanvasSize::PixelsPerInch).width();
+        const qreal dpi        = (d->exportDpi > 0 ? d->exportDpi : pageDpi);
+        const QSize outputSize = (d->size.size(PLECanvasSize::Inches) * dpi).toSize();
+
+        PLEExportJob* const job = new PLEExportJob(PLESceneSnapshot::capture(scene, outputSize.width() / scene->sceneRect().width()), this);
+        job->setOutputSize(outputSize);
+        job->setResolution(QSizeF(dpi, dpi));
+        job->addOutput(pageFileName(d->exportFile, index), d->exportFormat);
+
+        if (d->exportFormat == "pdf")
+            job->setPdfExporter(QSharedPointer<PLEPdfExporter>(new PLEPdfExporter(scene, d->size.size(PLECanvasSize::Points))));
+
+        // Job has its own copy of the content
+        if (!loaded)
+            unload(index);
+
+        d->running << job;
+        connect(job, SIGNAL(finished()), this, SLOT(jobFinished()));
+        job->start(QThread::LowPriority);
+    }
+
+    d->starting = false;
+
+    if (d->running.isEmpty() && d->loop)
+        d->loop->quit();
+}
+
+void PLEPhotobook::jobFinished()
+{
+    PLEExportJob* const job = qobject_cast<PLEExportJob*>(sender());
+
+    if (!job || !d->running.removeOne(job))
+        return;
+
+    d->errors << job->errors();
+    job->deleteLater();
+
+    startExportJobs();
+}
+
+} // namespace PhotoLayoutsEditor
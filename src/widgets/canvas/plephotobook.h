@@ -0,0 +1,164 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2020-06-12
+ * Description : multi-page photobook document.
+ *
+ * Copyright (C) 2020      by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+
+#ifndef PLE_PHOTOBOOK_H
+#define PLE_PHOTOBOOK_H
+
+// Qt includes
+
+#include <QObject>
+#include <QImage>
+#include <QStringList>
+#include <QByteArray>
+#include <QDomDocument>
+#include <QDomElement>
+
+// Local includes
+
+#include "plecanvassize.h"
+
+class QUndoCommand;
+class QUndoStack;
+
+namespace PhotoLayoutsEditor
+{
+
+class PLEScene;
+class PLEPageCommand;
+class PLEPageInsertCommand;
+
+/** Document of several pages of the same size sharing one undo stack and one image cache.
+ * Only the current page and its neighbours are kept as live scenes. Other pages are stored
+ * as compressed SVG referencing images of the shared cache, together with their thumbnails,
+ * and they are loaded again when needed. Pages with commands in the undo stack stay loaded,
+ * since the commands refer to their items.
+ */
+class PLEPhotobook : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    explicit PLEPhotobook(const PLECanvasSize& size, QObject* parent = nullptr);
+    ~PLEPhotobook() override;
+
+    PLECanvasSize pageSize() const;
+
+    /// Changes size of all pages
+    void setPageSize(const PLECanvasSize& size);
+
+    int count() const;
+
+    /// Appends page read from the scene element of a layout file or an empty page, it isn't undoable
+    void appendPage(const QDomElement& sceneElement = QDomElement());
+
+    /// Inserts new empty page, the insertion is pushed onto the undo stack
+    void insertPage(int index);
+
+    /// Removes the page, the removal is pushed onto the undo stack. The only page isn't removed.
+    void removePage(int index);
+
+    int currentPage() const;
+
+    /// Number of pages before and after the current one kept loaded
+    void setLoadedNeighbours(int count);
+    int loadedNeighbours() const;
+
+    /// Returns live scene of the page, the page is loaded if it's needed
+    PLEScene* scene(int index);
+    bool isLoaded(int index) const;
+
+    /// Preview of the page, it's null for pages which weren't loaded yet
+    QImage thumbnail(int index);
+
+    QUndoStack* undoStack() const;
+
+    /// Pushes the command onto the shared undo stack as a command of the current page
+    void push(QUndoCommand* command);
+
+    /** Returns document with the scene element of the page, which is read by PLEScene::fromSvg().
+     * It's called while a PLESvgImageStore is active: loaded pages are converted by the scene and
+     * unloaded pages are returned in their compact form, images of both go to the active store.
+     */
+    QDomDocument pageSvg(int index);
+
+    /** Writes every page into a separate file named after the given one with the page number appended.
+     * Pages are captured one by one and written by export jobs running in parallel. Resolution of the
+     * pages is used if dpi isn't positive.
+     */
+    bool exportPages(const QString& fileName, const QByteArray& format, qreal dpi = 0);
+
+    /// Errors of the last export
+    QStringList errors() const;
+
+    /// Returns file name of the page written by exportPages()
+    QString pageFileName(const QString& fileName, int index) const;
+
+public Q_SLOTS:
+
+    /// Makes the page current, pages far from it are unloaded
+    void setCurrentPage(int index);
+
+Q_SIGNALS:
+
+    /// Emitted before pages far from the new current page are unloaded
+    void currentPageChanged(int index);
+    void pageInserted(int index);
+    void pageRemoved(int index);
+
+    /// Emitted when the thumbnail of the page becomes outdated
+    void thumbnailChanged(int index);
+
+private Q_SLOTS:
+
+    void sceneChanged();
+    void sceneLoaded();
+    void jobFinished();
+
+private:
+
+    /// Page insertion and removal commands move the page between the document and the detached pages
+    void attachPage(int id, int index);
+    void detachPage(int id);
+    void dropPage(int id);
+
+    /// Page commands make their page current when they're undone or redone
+    void showPage(int id);
+
+    bool unload(int index);
+    void unloadDistantPages();
+    void startExportJobs();
+
+private:
+
+    class Private;
+    Private* const d;
+
+    friend class PLEPageCommand;
+    friend class PLEPageInsertCommand;
+};
+
+} // namespace PhotoLayoutsEditor
+
+#endif // PLE_PHOTOBOOK_H
@@ -42,6 +42,7 @@
 #include <QGraphicsSceneDragDropEvent>
 #include <QStyleOptionGraphicsItem>
 #include <QMap>
+#include <QHash>
 #include <QGraphicsWidget>
 #include <qmath.h>
 #include <QUndoCommand>
@@ -53,10 +54,14 @@
 #include <QMimeData>
 #include <QTemporaryFile>
 #include <QSettings>
+#include <QTimer>
 
 // Local includes
 
 #include "pleglobal.h"
+#include "plesvgimagestore.h"
+#include "plescenesnapshot.h"
+#include "plesnapengine.h"
 #include "rotationwidgetitem.h"
 #include "scalingwidgetitem.h"
 #include "cropwidgetitem.h"
@@ -69,11 +74,15 @@
 #include "plecanvasloadingthread.h"
 #include "photoitem.h"
 #include "plesceneborder.h"
+#include "plescenegrid.h"
 #include "imagedialog.h"
 #include "layersmodel.h"
 #include "layersmodelitem.h"
 #include "layersselectionmodel.h"
 
+// Distance in screen pixels at which moved items snap
+#define SNAP_DISTANCE 6.0
+
 using namespace Digikam;
 
 namespace PhotoLayoutsEditor
@@ -97,12 +106,18 @@ class PLEScenePrivate
 //        m_blend_active(false),
         m_readPLESceneMousePress_listener(nullptr),
         m_readPLESceneMousePress_enabled(false),
-        m_hovered_photo(nullptr)
+        m_hovered_photo(nullptr),
+        m_loading(false),
+        m_dragging(false),
+        m_drag_timer(nullptr)
     {
         // Background of the scene
         m_background = new PLESceneBackground(m_scene);
         // Border of the scene
         m_border = new PLESceneBorder(m_scene);
+        // Grid, hidden until it's enabled
+        m_grid = new PLESceneGrid(m_scene);
+        m_grid->setVisible(false);
     }
 
     QList<QGraphicsItem*> itemsAtPosition(const QPointF& scenePos, QWidget* widget)
@@ -129,6 +144,19 @@ class PLEScenePrivate
         return items.count() ? dynamic_cast<AbstractItemInterface*>(items.first()) : nullptr;
     }
 
+    /// Scale of the view the widget belongs to
+    qreal viewScale(QWidget* widget) const
+    {
+        QGraphicsView* view = widget ? qobject_cast<QGraphicsView*>(widget->parentWidget()) : nullptr;
+
+        if (!view)
+            return 1;
+
+        const QTransform transform = view->viewportTransform();
+
+        return qSqrt(qAbs(transform.determinant()));
+    }
+
     QList<AbstractItemInterface*> itemsAt(const QPointF& scenePos, QWidget* widget)
     {
         QList<QGraphicsItem*> items = itemsAtPosition(scenePos, widget);
@@ -200,6 +228,8 @@ class PLEScenePrivate
     // Used for selecting items
     void deselectSelected()
     {
+        endDrag();
+
         m_selected_items_all_movable = true;
 
         foreach (AbstractItemInterface* const photo, m_selected_items.keys())
@@ -211,7 +241,8 @@ class PLEScenePrivate
         }
 
         m_selected_items.clear();
-        m_selected_items_path = QPainterPath();
+        m_selection_outlines.clear();
+        m_selected_items_rect = QRectF();
     }
 
     bool selectPressed()
@@ -223,7 +254,7 @@ class PLEScenePrivate
             if (!m_pressed_item->isSelected())
             {
                 m_selected_items.insert(m_pressed_item, m_pressed_item->pos());
-                m_selected_items_path        = m_selected_items_path.united(m_pressed_item->mapToScene(m_pressed_item->shape()));
+                m_selected_items_rect       |= selectionOutline(m_pressed_item).boundingRect();
                 m_selected_items_all_movable = ((m_pressed_item->flags() & QGraphicsItem::ItemIsMovable) != 0) && m_selected_items_all_movable;
                 m_pressed_item->setSelected(true);
                 setSelectionInitialPosition();
@@ -256,7 +287,98 @@ class PLEScenePrivate
             ++it;
         }
 
-        m_selected_items_path_initial_pos = m_selected_items_path.boundingRect().topLeft();
+        m_selected_items_path_initial_pos = m_selected_items_rect.topLeft();
+    }
+
+    /** Returns scene outline of the selected item.
+     * Outlines are cached until the item's shape changes, moved items get their outline translated.
+     */
+    const QPainterPath& selectionOutline(AbstractPhoto* const item)
+    {
+        SelectionOutline& outline  = m_selection_outlines[item];
+        const QTransform transform = item->sceneTransform();
+        const int revision         = item->geometryRevision();
+
+        if (outline.revision == revision && outline.transform == transform)
+            return outline.path;
+
+        if (outline.revision == revision                      &&
+            outline.transform.m11() == transform.m11()        &&
+            outline.transform.m12() == transform.m12()        &&
+            outline.transform.m21() == transform.m21()        &&
+            outline.transform.m22() == transform.m22()        &&
+            !transform.isProjective() && !outline.transform.isProjective())
+        {
+            outline.path.translate(transform.dx() - outline.transform.dx(),
+                                   transform.dy() - outline.transform.dy());
+        }
+        else
+        {
+            outline.path = item->mapToScene(item->shape());
+        }
+
+        outline.transform = transform;
+        outline.revision  = revision;
+
+        return outline.path;
+    }
+
+    bool selectionContains(const QPointF& point)
+    {
+        if (!m_selected_items_rect.contains(point))
+            return false;
+
+        foreach (AbstractPhoto* const item, m_selected_items.keys())
+        {
+            if (selectionOutline(item).contains(point))
+                return true;
+        }
+
+        return false;
+    }
+
+    /** Starts moving of the selected items as one transaction.
+     * Items don't report their position changes until \fn endDrag(), so the layers model
+     * and editing widgets are updated once per drag instead of once per mouse event.
+     */
+    void beginDrag()
+    {
+        if (m_dragging)
+            return;
+
+        m_dragging = true;
+
+        foreach (AbstractPhoto* const item, m_selected_items.keys())
+            item->beginMove();
+
+        // Moved items can't snap to themselves
+        m_snap_engine.setExcluded(m_selected_items.keys());
+
+        Q_EMIT static_cast<PLEScene*>(m_scene)->interactionStarted();
+    }
+
+    /// Applies the move still waiting for the timer, then lets items report their new positions
+    void endDrag()
+    {
+        if (!m_dragging)
+            return;
+
+        m_drag_timer->stop();
+        static_cast<PLEScene*>(m_scene)->applyDragMove();
+        m_dragging = false;
+
+        foreach (AbstractPhoto* const item, m_selected_items.keys())
+            item->endMove();
+
+        m_snap_engine.setExcluded(QList<AbstractPhoto*>());
+
+        if (m_snap.snappedX || m_snap.snappedY)
+        {
+            m_snap = PLESnapEngine::SnapResult();
+            m_scene->update();
+        }
+
+        Q_EMIT static_cast<PLEScene*>(m_scene)->interactionFinished();
     }
 
     bool wasMoved()
@@ -273,6 +395,19 @@ class PLEScenePrivate
         return false;
     }
 
+    // Selection outline of the item, with item's scene transform and geometry revision it was mapped with
+    struct SelectionOutline
+    {
+        SelectionOutline()
+            : revision(-1)
+        {
+        }
+
+        QPainterPath path;
+        QTransform   transform;
+        int          revision;
+    };
+
     // Parent scene
     QGraphicsScene*              m_scene;
     // PLEScene's model
@@ -282,11 +417,14 @@ class PLEScenePrivate
     PLESceneBackground*          m_background;
     // Border item
     PLESceneBorder*              m_border;
+    // Grid item
+    PLESceneGrid*                m_grid;
 
     QMap<AbstractPhoto*,QPointF> m_selected_items;
     AbstractItemInterface*       m_pressed_object;
     AbstractPhoto*               m_pressed_item;
-    QPainterPath                 m_selected_items_path;
+    QHash<AbstractPhoto*, SelectionOutline> m_selection_outlines;
+    QRectF                       m_selected_items_rect;
     QPointF                      m_selected_items_path_initial_pos;
     bool                         m_selected_items_all_movable;
     bool                         m_selection_visible;
@@ -310,6 +448,18 @@ class PLEScenePrivate
     // Used for drag&drop images
     PhotoItem*                   m_hovered_photo;
 
+    // Items are being loaded by the loading thread
+    bool                         m_loading;
+
+    // Used for dragging selected items, moves are applied at most once per frame
+    bool                         m_dragging;
+    QPointF                      m_drag_target;
+    QTimer*                      m_drag_timer;
+
+    // Used for snapping moved items to other items and to the page
+    PLESnapEngine                m_snap_engine;
+    PLESnapEngine::SnapResult    m_snap;
+
 private:
 
     PLEScenePrivate(const PLEScenePrivate&) = delete;
@@ -603,8 +753,7 @@ PLEScene::PLEScene(const QRectF& dimension, QObject* const parent)
       d(new PLEScenePrivate(this)),
       x_grid(0),
       y_grid(0),
-      grid_item(nullptr),
-      grid_changed(true)
+      grid_visible(false)
 {
     if (!OUTSIDE_SCENE_COLOR.isValid())
     {
@@ -623,16 +772,24 @@ PLEScene::PLEScene(const QRectF& dimension, QObject* const parent)
     QSettings config(QLatin1String("PhotoLayoutEditor"));
     config.beginGroup(QLatin1String("View"));
     setGrid(config.value(QLatin1String("XGrid"), 25.0).toDouble(), config.value(QLatin1String("YGrid"), 25.0).toDouble());
-    grid_visible = !config.value(QLatin1String("ShowGrid"), false).toBool();
-    setGridVisible(config.value(QLatin1String("ShowGrid"), false).toBool());
+    grid_visible = config.value(QLatin1String("ShowGrid"), false).toBool();
+    d->m_grid->setVisible(grid_visible);
+    d->m_snap_engine.setTargets(config.value(QLatin1String("SnapTargets"), (int)PLESnapEngine::AllTargets).toInt());
     config.endGroup();
 
     // Indexing method
     this->setItemIndexMethod(QGraphicsScene::NoIndex);
 
+    // Dragged items are moved at most once per frame
+    d->m_drag_timer = new QTimer(this);
+    d->m_drag_timer->setSingleShot(true);
+    d->m_drag_timer->setInterval(16);
+
     // Signal connections
     connect(this, SIGNAL(selectionChanged()),
             this, SLOT(updateSelection()));
+    connect(d->m_drag_timer, SIGNAL(timeout()),
+            this, SLOT(applyDragMove()));
 }
 
 PLEScene::~PLEScene()
@@ -874,6 +1031,9 @@ void PLEScene::mousePressEvent(QGraphicsSceneMouseEvent* event)
         // If moving enabled
         if (m_interaction_mode & Selecting)
         {
+            // Finish drag which didn't receive its release event
+            d->endDrag();
+
             this->calcSelectionBoundingRect();
 
             // Get initial selection position
@@ -926,7 +1086,7 @@ void PLEScene::mousePressEvent(QGraphicsSceneMouseEvent* event)
 
             // If event pos is not in current selection shape...
 
-            if (!d->m_selected_items_path.contains(event->scenePos()) || !d->m_selected_items.contains(dynamic_cast<AbstractPhoto*>(d->m_pressed_item)))
+            if (!d->selectionContains(event->scenePos()) || !d->m_selected_items.contains(dynamic_cast<AbstractPhoto*>(d->m_pressed_item)))
             {
                 // Clear focus from focused items
                 if (this->focusItem())
@@ -1005,20 +1165,61 @@ void PLEScene::mouseMoveEvent(QGraphicsSceneMouseEvent* event)
                     distance.setX(x_grid*round(distance.rx()/x_grid));
                     distance.setY(y_grid*round(distance.ry()/y_grid));
                 }
+                else
+                {
+                    // Snap selection bounding rect to other items and to the page
+                    d->m_snap_engine.setPageRect(this->sceneRect());
+                    const PLESnapEngine::SnapResult snap = d->m_snap_engine.snap(QRectF(distance, d->m_selected_items_rect.size()),
+                                                                                 SNAP_DISTANCE / d->viewScale(event->widget()));
+                    distance += snap.offset;
+
+                    if (snap.snappedX != d->m_snap.snappedX || snap.snappedY != d->m_snap.snappedY ||
+                        snap.x != d->m_snap.x || snap.y != d->m_snap.y)
+                    {
+                        d->m_snap = snap;
+                        this->update();
+                    }
+                }
 
-                QPointF difference = d->m_selected_items_path.boundingRect().topLeft();
-                d->m_selected_items_path.translate(distance);
-                d->m_selected_items_path.translate(-difference);
-                difference = distance - difference;
-                d->m_selected_items_path.translate(difference);
+                // Mouse events are coalesced, items are moved to the latest position once per frame
 
-                foreach (AbstractItemInterface* const item, d->m_selected_items.keys())
-                    item->moveBy(difference.x(), difference.y());
+                d->beginDrag();
+                d->m_drag_target = distance;
+
+                if (!d->m_drag_timer->isActive())
+                {
+                    this->applyDragMove();
+                    d->m_drag_timer->start();
+                }
             }
         }
     }
 }
 
+void PLEScene::applyDragMove()
+{
+    if (!d->m_dragging)
+        return;
+
+    // Outlines follow the items, they are translated when drawn
+    const QPointF difference = d->m_drag_target - d->m_selected_items_rect.topLeft();
+
+    if (difference.isNull())
+        return;
+
+    d->m_selected_items_rect.translate(difference);
+
+    foreach (AbstractItemInterface* const item, d->m_selected_items.keys())
+        item->moveBy(difference.x(), difference.y());
+
+    // Editing widgets don't get items' changes during the drag
+    if (d->m_scale_item)
+        d->m_scale_item->updateShapes();
+
+    if (d->m_crop_item)
+        d->m_crop_item->updateShapes();
+}
+
 
 void PLEScene::mouseReleaseEvent(QGraphicsSceneMouseEvent* event)
 {
@@ -1045,6 +1246,10 @@ void PLEScene::mouseReleaseEvent(QGraphicsSceneMouseEvent* event)
             if (d->m_pressed_object)
                 d->sendReleaseEventToItem(d->m_pressed_object, event);
 
+            // Apply pending move and let items report their new positions
+
+            d->endDrag();
+
             // Post move command to QUndoStack
 
             if ((m_interaction_mode & Moving) && d->wasMoved())
@@ -1105,6 +1310,27 @@ void PLEScene::drawForeground(QPainter* painter, const QRectF& rect)
 {
     QGraphicsScene::drawForeground(painter, rect.intersected(this->sceneRect()));
 
+    // Lines the dragged items snapped to
+
+    if (d->m_dragging && (d->m_snap.snappedX || d->m_snap.snappedY))
+    {
+        const QRectF scene = this->sceneRect();
+        QPen pen(Qt::magenta);
+        pen.setCosmetic(true);
+        pen.setStyle(Qt::DashLine);
+
+        painter->save();
+        painter->setPen(pen);
+
+        if (d->m_snap.snappedX)
+            painter->drawLine(QLineF(d->m_snap.x, scene.top(), d->m_snap.x, scene.bottom()));
+
+        if (d->m_snap.snappedY)
+            painter->drawLine(QLineF(scene.left(), d->m_snap.y, scene.right(), d->m_snap.y));
+
+        painter->restore();
+    }
+
     // Draw selected items shape
 
     if (isSelectionVisible())
@@ -1113,7 +1339,16 @@ void PLEScene::drawForeground(QPainter* painter, const QRectF& rect)
         painter->save();
         painter->setPen(Qt::red);
         painter->setCompositionMode(QPainter::RasterOp_NotSourceAndNotDestination);
-        painter->drawPath(d->m_selected_items_path);
+
+        // Each outline is drawn separately, uniting them costs more than drawing overlaps
+        foreach (AbstractPhoto* const item, d->m_selected_items.keys())
+        {
+            const QPainterPath& outline = d->selectionOutline(item);
+
+            if (outline.controlPointRect().intersects(rect))
+                painter->drawPath(outline);
+        }
+
         painter->restore();
     }
 }
@@ -1250,77 +1485,7 @@ void PLEScene::setGrid(double x, double y)
     this->x_grid = x;
     this->y_grid = y;
 
-    if (!grid_visible)
-    {
-        return;
-    }
-
-    qDebug() << "Check to create new grid";
-
-    if (!grid_item)
-    {
-        QList<QGraphicsItem*> items;
-        grid_item = createItemGroup(items);
-        grid_item->setZValue(0);
-        grid_item->setVisible(true);
-        QGraphicsOpacityEffect* effect = new QGraphicsOpacityEffect(this);
-        effect->setOpacity(0.5);
-        grid_item->setGraphicsEffect(effect);
-    }
-
-    qreal width                        = sceneRect().width();
-    qreal height                       = sceneRect().height();
-    QList<QGraphicsItem*> children     = grid_item->childItems();
-    QList<QGraphicsItem*>::iterator it = children.begin();
-    QGraphicsLineItem* temp1           = nullptr;
-
-    qDebug() << "Apply horizontal grid";
-
-    for (qreal i = x; i < width; i+=x)
-    {
-        if (it != children.end())
-        {
-            temp1 = dynamic_cast<QGraphicsLineItem*>(*it);
-            temp1->setLine(i, 0, i, height);
-            ++it;
-        }
-        else
-        {
-            temp1 = new QGraphicsLineItem(i, 0, i, height, nullptr);
-            grid_item->addToGroup(temp1);
-        }
-    }
-
-    qDebug() << "Apply Vertical grid";
-
-    for (qreal i = y; i < height; i+=y)
-    {
-        if (it != children.end())
-        {
-            temp1 = dynamic_cast<QGraphicsLineItem*>(*it);
-            temp1->setLine(0, i, width, i);
-            ++it;
-        }
-        else
-        {
-            temp1 = new QGraphicsLineItem(0, i, width, i, nullptr);
-            grid_item->addToGroup(temp1);
-        }
-    }
-
-    QList<QGraphicsItem*> toRemove;
-
-    while (it != children.end())
-    {
-        toRemove.append(*(it++));
-    }
-
-    while (toRemove.count())
-    {
-        QGraphicsItem* const temp2 = toRemove.takeAt(0);
-        grid_item->removeFromGroup(temp2);
-        delete temp2;
-    }
+    d->m_grid->setDistance(x, y);
 }
 
 void PLEScene::setHorizontalGrid(double x)
@@ -1339,16 +1504,7 @@ void PLEScene::setGridVisible(bool visible)
         return;
 
     grid_visible = visible;
-
-    if (visible)
-    {
-        this->setGrid(x_grid, y_grid);
-    }
-    else
-    {
-        delete grid_item;
-        grid_item = nullptr;
-    }
+    d->m_grid->setVisible(visible);
 }
 
 bool PLEScene::isGridVisible()
@@ -1497,6 +1653,26 @@ qreal PLEScene::gridVerticalDistance() const
     return this->y_grid;
 }
 
+void PLEScene::setSnapTargets(int targets)
+{
+    d->m_snap_engine.setTargets(targets);
+}
+
+int PLEScene::snapTargets() const
+{
+    return d->m_snap_engine.targets();
+}
+
+void PLEScene::updateSnapIndex(AbstractPhoto* item)
+{
+    d->m_snap_engine.updateItem(item);
+}
+
+void PLEScene::removeFromSnapIndex(AbstractPhoto* item)
+{
+    d->m_snap_engine.removeItem(item);
+}
+
 QDomDocument PLEScene::toSvg(ProgressObserver* observer)
 {
     return toSvg(observer, false);
@@ -1531,8 +1707,6 @@ QDomDocument PLEScene::toSvg(ProgressObserver* observer, bool asTemplate)
         else
             imgw = qRound(sceneSize.width() * imgh / sceneSize.height());
 
-        QByteArray byteArray;
-        QBuffer buffer(&byteArray);
         QImage img(QSize((int)imgw, (int)imgh), QImage::Format_ARGB32_Premultiplied);
         img.fill(Qt::white);
         QPainter p(&img);
@@ -1543,10 +1717,9 @@ QDomDocument PLEScene::toSvg(ProgressObserver* observer, bool asTemplate)
         if (temp.open())
         {
             img.save(temp.fileName());
-            img.save(&buffer, "PNG");
         }
 
-        image.appendChild( document.createTextNode( QString::fromUtf8(byteArray.toBase64()) ) );
+        image.appendChild( document.createTextNode( PLESvgImageStore::svgImageData(img) ) );
         image.setAttribute(QLatin1String("width"),QString::number((int)imgw));
         image.setAttribute(QLatin1String("height"),QString::number((int)imgh));
 
@@ -1623,6 +1796,10 @@ PLEScene* PLEScene::fromSvg(QDomElement& sceneElement)
 
     // Loading thread
     PLECanvasLoadingThread * thread = new PLECanvasLoadingThread(result);
+    result->d->m_loading            = true;
+
+    connect(thread, SIGNAL(finished()),
+            result, SLOT(loadingThreadFinished()));
 
     // Create elements
     int errorsCount = 0;
@@ -1691,23 +1868,46 @@ PLEScene* PLEScene::fromSvg(QDomElement& sceneElement)
 
 void PLEScene::render(QPainter* painter, const QRectF& target, const QRectF& source, Qt::AspectRatioMode aspectRatioMode)
 {
-    if (d->m_rot_item)
-        d->m_rot_item->hide();
+    if (!painter || !painter->device())
+        return;
 
-    if (d->m_scale_item)
-        d->m_scale_item->hide();
+    const QRectF sourceRect = (source.isNull() ? this->sceneRect() : source);
+    const QRectF targetRect = (target.isNull() ? QRectF(0, 0, painter->device()->width(), painter->device()->height())
+                                               : target);
 
-    d->m_selection_visible = false;
+    if (sourceRect.isEmpty() || targetRect.isEmpty())
+        return;
 
-    QGraphicsScene::render(painter, target, source, aspectRatioMode);
+    // Source is fitted into the target the same way as QGraphicsScene::render() does
+    QRectF fittedRect = targetRect;
 
-    d->m_selection_visible = true;
+    if (aspectRatioMode != Qt::IgnoreAspectRatio)
+    {
+        fittedRect.setSize(sourceRect.size().scaled(targetRect.size(), aspectRatioMode));
+        fittedRect.moveCenter(targetRect.center());
+    }
 
-    if (d->m_rot_item)
-        d->m_rot_item->show();
+    // Editing widgets and selection aren't recorded into the snapshot, so they don't have to be hidden
+    // while rendering and the scene can be captured at the resolution of the painter's device
+    const QTransform& world = painter->worldTransform();
+    const qreal resolution  = fittedRect.width() / sourceRect.width() * qSqrt(qAbs(world.determinant()));
 
-    if (d->m_scale_item)
-        d->m_scale_item->show();
+    painter->save();
+    painter->setClipRect(targetRect, Qt::IntersectClip);
+    PLESceneSnapshot::capture(this, (resolution > 0 ? resolution : 1.0)).render(painter, fittedRect, sourceRect);
+    painter->restore();
+}
+
+bool PLEScene::isLoading() const
+{
+    return d->m_loading;
+}
+
+void PLEScene::loadingThreadFinished()
+{
+    // Results of the item loaders are delivered before this slot is called
+    d->m_loading = false;
+    Q_EMIT loadingFinished();
 }
 
 void PLEScene::readPLESceneMousePress(MousePressListener * mouseListsner)
@@ -1733,11 +1933,14 @@ QList<AbstractPhoto*> PLEScene::selectedItems() const
 
 void PLEScene::updateSelection()
 {
+    // Selection changed during the drag, finish it for previously selected items
+
+    d->endDrag();
+
     foreach (AbstractPhoto* const item, d->m_selected_items.keys())
         if (!item->isSelected())
             d->m_selected_items.remove(item);
 
-    d->m_selected_items_path = QPainterPath();
     QList<AbstractPhoto*> itemsList = this->selectedItems();
 
     foreach (AbstractPhoto* const item, itemsList)
@@ -1751,10 +1954,10 @@ void PLEScene::updateSelection()
 
         if (!d->m_selected_items.contains(item))
             d->m_selected_items.insert(item, item->pos());
-
-        d->m_selected_items_path = d->m_selected_items_path.united(item->mapToScene(item->shape()));
     }
 
+    this->calcSelectionBoundingRect();
+
     if (d->m_selected_items.count() == 1 && d->m_selected_items.begin().key()->flags() & QGraphicsItem::ItemIsFocusable)
         d->m_selected_items.begin().key()->setFocus(Qt::OtherFocusReason);
 
@@ -1784,10 +1987,21 @@ void PLEScene::imageLoaded(const QUrl& url, const QImage& image)
 
 void PLEScene::calcSelectionBoundingRect()
 {
-    d->m_selected_items_path = QPainterPath();
+    // Outlines of deselected items are dropped, the rest is reused
+    QHash<AbstractPhoto*, PLEScenePrivate::SelectionOutline>::iterator it = d->m_selection_outlines.begin();
 
-    foreach (AbstractItemInterface* const item, d->m_selected_items.keys())
-        d->m_selected_items_path = d->m_selected_items_path.united(item->mapToScene(item->shape()));
+    while (it != d->m_selection_outlines.end())
+    {
+        if (d->m_selected_items.contains(it.key()))
+            ++it;
+        else
+            it = d->m_selection_outlines.erase(it);
+    }
+
+    d->m_selected_items_rect = QRectF();
+
+    foreach (AbstractPhoto* const item, d->m_selected_items.keys())
+        d->m_selected_items_rect |= d->selectionOutline(item).boundingRect();
 }
 
 bool PLEScene::askAboutRemoving(int count)
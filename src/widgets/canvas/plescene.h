@@ -109,6 +109,9 @@ public:
     QDomDocument toTemplateSvg(ProgressObserver* observer);
     QDomDocument toSvg(ProgressObserver* observer, bool asTemplate);
     static PLEScene* fromSvg(QDomElement& svgImage);
+
+    /// Returns true while items of the scene created by fromSvg() are being loaded
+    bool isLoading() const;
     void addSelectingFilter(const QMetaObject & classMeta);
     void clearSelectingFilters();
     void setRotationWidgetVisible(bool isVisible);
@@ -117,6 +120,10 @@ public:
     qreal gridHorizontalDistance() const;
     qreal gridVerticalDistance() const;
 
+    /// Targets moved items snap to, combination of PLESnapEngine::SnapTarget flags
+    void setSnapTargets(int targets);
+    int snapTargets() const;
+
     const QGraphicsScene* toGraphicsPLEScene() const
     {
         return this;
@@ -137,6 +144,11 @@ Q_SIGNALS:
     void itemAboutToBeRemoved(AbstractPhoto* item);
     void itemsAboutToBeRemoved(const QList<AbstractPhoto*>& items);
     void mousePressedPoint(const QPointF& point);
+    void loadingFinished();
+
+    /// Emitted when dragging of selected items starts and ends
+    void interactionStarted();
+    void interactionFinished();
 
 public Q_SLOTS:
 
@@ -171,12 +183,16 @@ private Q_SLOTS:
 
     void imageLoaded(const QUrl& url, const QImage& image);
     void calcSelectionBoundingRect();
+    void loadingThreadFinished();
+    void applyDragMove();
 
 private:
 
     PLEScene(const PLEScene&);
     PLEScene& operator=(const PLEScene&);
 
+    void updateSnapIndex(AbstractPhoto* item);
+    void removeFromSnapIndex(AbstractPhoto* item);
     bool askAboutRemoving(int count);
     bool canDecode(const QMimeData* mimeData);
 
@@ -193,8 +209,6 @@ private:
     qreal                      x_grid;
     qreal                      y_grid;
     bool                       grid_visible;
-    QGraphicsItemGroup*        grid_item;
-    bool                       grid_changed;
 
     static const SelectionMode DEFAULT_SELECTING_MODE = MultiSelection;
     static const int           DEFAULT_EDITING_MODE   = Moving & Selecting;
@@ -32,6 +32,8 @@
 
 #include <QPainter>
 #include <QGraphicsScene>
+#include <QWidget>
+#include <QtMath>
 #include <QUndoCommand>
 #include <QStyleOptionGraphicsItem>
 #include <QDebug>
@@ -41,6 +43,7 @@
 // Local includes
 
 #include "pleglobal.h"
+#include "plesvgimagestore.h"
 
 namespace PhotoLayoutsEditor
 {
@@ -189,7 +192,8 @@ public:
 PLESceneBackground::PLESceneBackground(QGraphicsScene* scene)
     : QGraphicsItem(nullptr),
       m_first_brush(Qt::transparent),
-      m_second_brush(Qt::transparent)
+      m_second_brush(Qt::transparent),
+      m_preview_factor(1)
 {
     scene->addItem(this);
     setZValue(-std::numeric_limits<double>::infinity());
@@ -382,16 +386,39 @@ QDomElement PLESceneBackground::toSvg(QDomDocument& document) const
     }
     else if (this->isPattern())
     {
-        QDomElement pattern = document.createElement(QLatin1String("image"));
-        pattern.setAttribute(QLatin1String("width"),  m_image.rect().width());
-        pattern.setAttribute(QLatin1String("height"), m_image.rect().height());
+        // Only the pattern tile is stored, SVG viewers repeat it over the scene
+        const QImage tile   = m_pattern_brush.textureImage();
+        QDomElement pattern = document.createElement(QLatin1String("pattern"));
+        pattern.setAttribute(QLatin1String("id"), QLatin1String("background_pattern"));
         pattern.setAttribute(QLatin1String("x"), 0);
         pattern.setAttribute(QLatin1String("y"), 0);
-        QByteArray byteArray;
-        QBuffer buffer(&byteArray);
-        m_temp_image.save(&buffer, "PNG");
-        pattern.setAttribute(QLatin1String("xlink:href"), QLatin1String("data:image/png;base64,") + QString::fromUtf8(byteArray.toBase64()));
-        result.appendChild(pattern);
+        pattern.setAttribute(QLatin1String("width"),  tile.width());
+        pattern.setAttribute(QLatin1String("height"), tile.height());
+        pattern.setAttribute(QLatin1String("patternUnits"), QLatin1String("userSpaceOnUse"));
+        defs.appendChild(pattern);
+
+        QDomElement image = document.createElement(QLatin1String("image"));
+        image.setAttribute(QLatin1String("width"),  tile.width());
+        image.setAttribute(QLatin1String("height"), tile.height());
+        image.setAttribute(QLatin1String("xlink:href"), QLatin1String("data:image/png;base64,") + PLESvgImageStore::svgImageData(tile));
+        pattern.appendChild(image);
+
+        QDomElement bckColor = document.createElement(QLatin1String("rect"));
+        bckColor.setAttribute(QLatin1String("x"), 0);
+        bckColor.setAttribute(QLatin1String("y"), 0);
+        bckColor.setAttribute(QLatin1String("width"),  m_rect.width());
+        bckColor.setAttribute(QLatin1String("height"), m_rect.height());
+        bckColor.setAttribute(QLatin1String("fill"), m_second_brush.color().name());
+        bckColor.setAttribute(QLatin1String("opacity"), QString::number(m_second_brush.color().alphaF()));
+        result.appendChild(bckColor);
+
+        QDomElement bckg = document.createElement(QLatin1String("rect"));
+        bckg.setAttribute(QLatin1String("x"), 0);
+        bckg.setAttribute(QLatin1String("y"), 0);
+        bckg.setAttribute(QLatin1String("width"),  m_rect.width());
+        bckg.setAttribute(QLatin1String("height"), m_rect.height());
+        bckg.setAttribute(QLatin1String("fill"), QLatin1String("url(#background_pattern)"));
+        result.appendChild(bckg);
 
         type.appendChild( document.createTextNode(QLatin1String("pattern")));
         QDomElement bs = document.createElement(QLatin1String("brush_style"));
@@ -410,7 +437,7 @@ QDomElement PLESceneBackground::toSvg(QDomDocument& document) const
     {
         type.appendChild( document.createTextNode(QLatin1String("image")));
 
-        QSize s = m_first_brush.textureImage().size();
+        QSize s = m_image_size;
         QDomElement pattern = document.createElement(QLatin1String("pattern"));
         pattern.setAttribute(QLatin1String("x"), QString::number(m_first_brush.transform().m31()));
         pattern.setAttribute(QLatin1String("y"), QString::number(m_first_brush.transform().m32()));
@@ -420,13 +447,10 @@ QDomElement PLESceneBackground::toSvg(QDomDocument& document) const
         defs.appendChild(pattern);
 
         QDomElement image = document.createElement(QLatin1String("image"));
-        QByteArray byteArray;
-        QBuffer buffer(&byteArray);
-        m_image.save(&buffer, "PNG");
         image.setAttribute(QLatin1String("width"), QString::number(s.width())+QLatin1String("px"));
         image.setAttribute(QLatin1String("height"),QString::number(s.height())+QLatin1String("px"));
-        image.setAttribute(QLatin1String("xlink:href"),QLatin1String("data:image/png;base64,") + QString::fromUtf8(byteArray.toBase64()));
-        pattern.setAttribute(QLatin1String("id"), QString::number(qChecksum(byteArray.constData(), byteArray.length())).append(QLatin1String("bkg")));
+        image.setAttribute(QLatin1String("xlink:href"),QLatin1String("data:image/png;base64,") + PLESvgImageStore::svgImageData(m_image));
+        pattern.setAttribute(QLatin1String("id"), QString::number(m_image.cacheKey()).append(QLatin1String("bkg")));
         pattern.appendChild(image);
 
         QDomElement align = document.createElement(QLatin1String("align"));
@@ -577,7 +601,7 @@ bool PLESceneBackground::fromSvg(QDomElement& element)
         m_image_size.setWidth(image.attribute(QLatin1String("width")).remove(QLatin1String("px")).toInt());
         m_image_size.setHeight(image.attribute(QLatin1String("height")).remove(QLatin1String("px")).toInt());
         m_image = QImage::fromData( QByteArray::fromBase64(image.attributeNS(QLatin1String("http://www.w3.org/1999/xlink"), QLatin1String("href")).remove(QLatin1String("data:image/png;base64,")).toLatin1()) );
-        m_first_brush.setTextureImage(m_image.scaled(m_image_size, m_image_aspect_ratio));
+        m_first_brush.setTextureImage(m_image);
 
         QDomElement bColor = defs.firstChildElement(QLatin1String("background_color"));
         QColor backgroundColor(bColor.text());
@@ -659,31 +683,74 @@ QVariant PLESceneBackground::itemChange(GraphicsItemChange change, const QVarian
     return QGraphicsItem::itemChange(change, value);
 }
 
-void PLESceneBackground::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* /*widget*/)
+void PLESceneBackground::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
 {
     if (!m_rect.isValid())
         return;
 
+    // Brushes are filled through the painter instead of a scene sized buffer, so only the
+    // exposed region is rasterized, at the resolution of the view or of the export device.
+    QRectF exposed = option->exposedRect & m_rect;
     painter->setRenderHint(QPainter::SmoothPixmapTransform);
-    painter->drawImage(QPoint(0,0), m_temp_image, option->exposedRect);
+    painter->fillRect(exposed, m_second_brush);
+
+    if (this->isPattern())
+    {
+        painter->fillRect(exposed, m_pattern_brush);
+    }
+    else if (this->isImage() && widget && !m_image.isNull())
+    {
+        // Views get the image halved down to the nearest size finer than their zoom,
+        // export and print devices get the full image
+        const qreal scale = qSqrt(qAbs(painter->worldTransform().determinant())) * widget->devicePixelRatioF() *
+                            m_image_size.width() / m_image.width();
+        qreal factor      = 1;
+
+        while (factor > 1.0 / 64 && factor / 2 >= scale)
+            factor /= 2;
+
+        if (factor < 1)
+        {
+            if (m_preview.isNull() || !qFuzzyCompare(m_preview_factor, factor))
+            {
+                m_preview        = m_image.scaled((QSizeF(m_image.size()) * factor).toSize().expandedTo(QSize(1, 1)),
+                                                  Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+                m_preview_factor = factor;
+            }
+
+            QBrush preview(m_preview);
+            preview.setTransform(QTransform::fromScale(qreal(m_image.width())  / m_preview.width(),
+                                                       qreal(m_image.height()) / m_preview.height()) *
+                                 m_first_brush.transform());
+            painter->fillRect(exposed & m_fill_rect, preview);
+        }
+        else
+        {
+            painter->fillRect(exposed & m_fill_rect, m_first_brush);
+        }
+    }
+    else
+    {
+        painter->fillRect(exposed & m_fill_rect, m_first_brush);
+    }
 }
 
-void PLESceneBackground::render(QPainter* painter, const QRect& rect)
+void PLESceneBackground::updateFillRect(const QRect& rect)
 {
     if (!rect.isValid())
         return;
 
-    QRect r = rect;
-    painter->fillRect(r, m_second_brush);
+    QRectF r = rect;
+    m_preview = QImage();
 
-    if (this->isImage())
+    if (this->isImage() && !m_image.isNull())
     {
+        // Texture keeps the pixels of the image, the brush transform scales it to its size in the scene
         QSize scaleSize = (m_image_aspect_ratio == Qt::IgnoreAspectRatio ? m_image_size : rect.size());
-        m_first_brush.setTextureImage( m_image.scaled(scaleSize, m_image_aspect_ratio, Qt::SmoothTransformation) );
-        m_image_size = m_first_brush.textureImage().size();
+        m_image_size    = m_image.size().scaled(scaleSize, m_image_aspect_ratio);
+        m_first_brush.setTextureImage(m_image);
         QSize bgSize = rect.size();
-        QSize imSize = m_first_brush.textureImage().size();
-        QTransform tr;
+        QSize imSize = m_image_size;
         qreal x = 0;
 
         if (m_image_align & Qt::AlignHCenter)
@@ -698,22 +765,30 @@ void PLESceneBackground::render(QPainter* painter, const QRect& rect)
         else if (m_image_align & Qt::AlignBottom)
             y = bgSize.height() - imSize.height();
 
-        tr.translate(x,y);
-        m_first_brush.setTransform(tr);
+        m_first_brush.setTransform(QTransform::fromScale(qreal(imSize.width())  / m_image.width(),
+                                                         qreal(imSize.height()) / m_image.height()) *
+                                   QTransform::fromTranslate(x, y));
 
         if (!this->m_image_repeat)
-            r = m_first_brush.transform().mapRect(QRect(0, 0, m_image_size.width(), m_image_size.height()));
+            r = QRectF(x, y, imSize.width(), imSize.height());
+    }
+    else if (this->isPattern())
+    {
+        QImage tile(8, 8, QImage::Format_ARGB32_Premultiplied);
+        tile.fill(Qt::transparent);
+        QPainter p(&tile);
+        p.fillRect(tile.rect(), m_first_brush);
+        p.end();
+        m_pattern_brush = QBrush(tile);
     }
 
-    painter->fillRect(r, m_first_brush);
+    m_fill_rect = r;
 }
 
 void PLESceneBackground::render()
 {
-    this->m_temp_image.fill(Qt::transparent);
-    QPainter p(&this->m_temp_image);
-    this->render(&p, this->m_temp_image.rect());
-    p.end();
+    this->updateFillRect(m_rect.toRect());
+    this->update();
 
     Q_EMIT changed();
 }
@@ -735,15 +810,15 @@ void PLESceneBackground::sceneRectChanged(const QRectF& sceneRect)
 {
     if (sceneRect.isValid())
     {
-        m_rect       = sceneRect;
-        m_temp_image = QImage(m_rect.size().toSize(), QImage::Format_ARGB32);
-        m_temp_image.fill(Qt::transparent);
-        QPainter p(&m_temp_image);
-        render(&p, m_rect.toRect());
+        prepareGeometryChange();
+        m_rect = sceneRect;
+        updateFillRect(m_rect.toRect());
     }
     else
     {
-        m_rect = QRectF();
+        prepareGeometryChange();
+        m_rect      = QRectF();
+        m_fill_rect = QRectF();
     }
 }
 
@@ -53,8 +53,15 @@ class PLESceneBackground : public QObject,
     QSize m_image_size;
     bool m_image_repeat;
 
-    // For painting/rendering purpose
-    QImage m_temp_image;
+    // Area covered by the first brush, painted straight into the exposed region
+    QRectF m_fill_rect;
+
+    // Qt patterns are drawn in device pixels, so they're painted from a tile of one pixel per scene unit
+    QBrush m_pattern_brush;
+
+    // Image background is painted in views from the image scaled down by m_preview_factor
+    QImage m_preview;
+    qreal m_preview_factor;
 
     class BackgroundImageChangedCommand;
     class BackgroundFirstBrushChangeCommand;
@@ -96,7 +103,7 @@ protected:
 
     QVariant itemChange(GraphicsItemChange change, const QVariant& value) override;
     void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
-    void render(QPainter* painter, const QRect& rect);
+    void updateFillRect(const QRect& rect);
 
 protected Q_SLOTS:
 
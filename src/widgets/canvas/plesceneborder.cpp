@@ -41,6 +41,7 @@
 // Local includes
 
 #include "pleglobal.h"
+#include "plesvgimagestore.h"
 
 namespace PhotoLayoutsEditor
 {
@@ -124,13 +125,10 @@ QDomElement PLESceneBorder::toSvg(QDomDocument& document) const
     defs.appendChild(pattern);
 
     QDomElement image = document.createElement(QLatin1String("image"));
-    QByteArray byteArray;
-    QBuffer buffer(&byteArray);
-    m_image.save(&buffer, "PNG");
     image.setAttribute(QLatin1String("width"), QString::number(s.width())+QLatin1String("px"));
     image.setAttribute(QLatin1String("height"),QString::number(s.height())+QLatin1String("px"));
-    image.setAttribute(QLatin1String("xlink:href"), QLatin1String("data:image/png;base64,") + QString::fromUtf8(byteArray.toBase64()));
-    pattern.setAttribute(QLatin1String("id"), QString::number(qChecksum(byteArray.constData(), byteArray.length())).append(QLatin1String("bkg")));
+    image.setAttribute(QLatin1String("xlink:href"), QLatin1String("data:image/png;base64,") + PLESvgImageStore::svgImageData(m_image));
+    pattern.setAttribute(QLatin1String("id"), QString::number(m_image.cacheKey()).append(QLatin1String("bkg")));
     pattern.appendChild(image);
 
     QDomElement bckg = document.createElement(QLatin1String("rect"));
@@ -292,30 +290,37 @@ QVariant PLESceneBorder::itemChange(GraphicsItemChange change, const QVariant& v
 
 void PLESceneBorder::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* /*widget*/)
 {
-    if (m_temp_image.isNull() || !m_rect.isValid())
+    if (m_image.isNull() || !m_rect.isValid())
         return;
 
+    // The border image is stretched over the scene by the painter, so only the exposed
+    // part is resampled, at the resolution of the view or of the export device.
+    QRectF exposed = option->exposedRect & m_rect;
+
+    if (exposed.isEmpty())
+        return;
+
+    QTransform toImage = QTransform::fromTranslate(-m_rect.x(), -m_rect.y()) *
+                         QTransform::fromScale(m_image.width()  / m_rect.width(),
+                                               m_image.height() / m_rect.height());
+
     painter->setRenderHint(QPainter::SmoothPixmapTransform);
-    painter->drawImage(QPoint(0,0), m_temp_image, option->exposedRect);
+    painter->drawImage(exposed, m_image, toImage.mapRect(exposed));
 }
 
 void PLESceneBorder::render(QPainter* painter, const QRect& rect)
 {
-    if (rect.isValid())
+    if (rect.isValid() && !m_image.isNull())
     {
-        painter->drawImage(rect, m_temp_image, m_rect);
+        painter->setRenderHint(QPainter::SmoothPixmapTransform);
+        painter->drawImage(rect, m_image);
     }
 }
 
 void PLESceneBorder::render()
 {
     if (m_rect.isValid())
-    {
-        if (m_image.isNull())
-            return;
-
-        m_temp_image = m_image.scaled(m_rect.size().toSize(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
-    }
+        update();
 }
 
 void PLESceneBorder::sceneChanged()
@@ -335,15 +340,12 @@ void PLESceneBorder::sceneRectChanged(const QRectF& sceneRect)
 {
     if (sceneRect.isValid())
     {
+        prepareGeometryChange();
         m_rect = sceneRect;
-
-        if (m_image.isNull())
-            return;
-
-        render();
     }
     else
     {
+        prepareGeometryChange();
         m_rect = QRectF();
     }
 }
@@ -46,9 +46,6 @@ class PLESceneBorder : public QObject, public QGraphicsItem
     // Image border specific data
     QImage m_image;
 
-    // For painting/rendering purpose
-    QImage m_temp_image;
-
     class BorderImageChangedCommand;
     class BorderFirstBrushChangeCommand;
     class BorderSecondBrushChangeCommand;
@@ -0,0 +1,166 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "plescenegrid.h"
+
+// Qt includes
+
+#include <QGraphicsScene>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <QVector>
+#include <QtMath>
+
+// Lines closer than this number of device pixels are skipped
+#define MIN_LINE_DISTANCE 4.0
+
+namespace PhotoLayoutsEditor
+{
+
+PLESceneGrid::PLESceneGrid(QGraphicsScene* scene)
+    : QGraphicsItem(nullptr),
+      m_x(0),
+      m_y(0)
+{
+    // Same z value the grid had as a group of line items, items are stacked from 1
+    setZValue(0);
+    setFlags(QGraphicsItem::ItemUsesExtendedStyleOption);
+    setAcceptedMouseButtons(Qt::NoButton);
+
+    if (scene)
+        scene->addItem(this);
+
+    sceneChanged();
+}
+
+QRectF PLESceneGrid::boundingRect() const
+{
+    return m_rect;
+}
+
+QPainterPath PLESceneGrid::shape() const
+{
+    return QPainterPath();
+}
+
+void PLESceneGrid::setDistance(qreal x, qreal y)
+{
+    if (x <= 0 || y <= 0)
+        return;
+
+    m_x = x;
+    m_y = y;
+    update();
+}
+
+QVariant PLESceneGrid::itemChange(GraphicsItemChange change, const QVariant& value)
+{
+    switch (change)
+    {
+        case QGraphicsItem::ItemParentChange:
+            return QVariant(0);
+
+        case QGraphicsItem::ItemSceneChange:
+            this->disconnect(scene(), nullptr, this, nullptr);
+            break;
+
+        case QGraphicsItem::ItemSceneHasChanged:
+            sceneChanged();
+            break;
+
+        default:
+            break;
+    }
+
+    return QGraphicsItem::itemChange(change, value);
+}
+
+void PLESceneGrid::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* /*widget*/)
+{
+    const QRectF area = option->exposedRect & m_rect;
+
+    if (area.isEmpty() || m_x <= 0 || m_y <= 0)
+        return;
+
+    // Lines closer than a few pixels on the screen are skipped, every n-th line is drawn instead
+
+    const QTransform& transform = painter->worldTransform();
+    const qreal xScale          = qSqrt(transform.m11() * transform.m11() + transform.m12() * transform.m12());
+    const qreal yScale          = qSqrt(transform.m21() * transform.m21() + transform.m22() * transform.m22());
+    qreal xStep                 = m_x;
+    qreal yStep                 = m_y;
+
+    while (xStep * xScale < MIN_LINE_DISTANCE)
+        xStep *= 2;
+
+    while (yStep * yScale < MIN_LINE_DISTANCE)
+        yStep *= 2;
+
+    // Only lines crossing exposed area are drawn, all of them with single call
+
+    QVector<QLineF> lines;
+    lines.reserve(qCeil(area.width() / xStep) + qCeil(area.height() / yStep) + 2);
+
+    const qreal xFirst = m_rect.left() + xStep * qMax(1, qCeil((area.left() - m_rect.left()) / xStep));
+    const qreal yFirst = m_rect.top()  + yStep * qMax(1, qCeil((area.top()  - m_rect.top())  / yStep));
+
+    for (qreal i = xFirst; i < m_rect.right() && i <= area.right(); i += xStep)
+        lines << QLineF(i, area.top(), i, area.bottom());
+
+    for (qreal i = yFirst; i < m_rect.bottom() && i <= area.bottom(); i += yStep)
+        lines << QLineF(area.left(), i, area.right(), i);
+
+    if (lines.isEmpty())
+        return;
+
+    QPen pen(QColor(0, 0, 0, 128));
+    pen.setCosmetic(true);
+
+    painter->save();
+    painter->setPen(pen);
+    painter->setRenderHint(QPainter::Antialiasing, false);
+    painter->drawLines(lines);
+    painter->restore();
+}
+
+void PLESceneGrid::sceneChanged()
+{
+    if (scene())
+    {
+        sceneRectChanged(scene()->sceneRect());
+        this->connect(scene(), SIGNAL(sceneRectChanged(QRectF)), this, SLOT(sceneRectChanged(QRectF)), Qt::UniqueConnection);
+    }
+    else
+    {
+        sceneRectChanged(QRectF());
+    }
+}
+
+void PLESceneGrid::sceneRectChanged(const QRectF& sceneRect)
+{
+    prepareGeometryChange();
+    m_rect = sceneRect.isValid() ? sceneRect : QRectF();
+}
+
+} // namespace PhotoLayoutsEditor
@@ -0,0 +1,71 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef SCENE_GRID_H
+#define SCENE_GRID_H
+
+// Qt includes
+
+#include <QGraphicsItem>
+
+namespace PhotoLayoutsEditor
+{
+
+/** Grid of the scene, painted just above the background and below all other items.
+ * It has no shape, so it's never found under the mouse.
+ */
+class PLESceneGrid : public QObject, public QGraphicsItem
+{
+    Q_OBJECT
+    Q_INTERFACES(QGraphicsItem)
+
+    QRectF m_rect;
+    qreal  m_x;
+    qreal  m_y;
+
+public:
+
+    explicit PLESceneGrid(QGraphicsScene* scene = nullptr);
+    QRectF boundingRect() const override;
+    QPainterPath shape() const override;
+
+    void setDistance(qreal x, qreal y);
+
+protected:
+
+    QVariant itemChange(GraphicsItemChange change, const QVariant& value) override;
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+
+private:
+
+    void sceneChanged();
+
+private Q_SLOTS:
+
+    void sceneRectChanged(const QRectF& sceneRect);
+};
+
+} // namespace PhotoLayoutsEditor
+
+#endif // SCENE_GRID_H
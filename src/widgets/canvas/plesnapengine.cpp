@@ -0,0 +1,348 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "plesnapengine.h"
+
+// C++ includes
+
+#include <algorithm>
+
+// Qt includes
+
+#include <QHash>
+#include <QSet>
+#include <QVector>
+
+// Local includes
+
+#include "abstractphoto.h"
+
+namespace PhotoLayoutsEditor
+{
+
+class PLESnapEngine::Private
+{
+public:
+
+    // Snap position on one axis, page positions have no item
+    struct Entry
+    {
+        qreal          value;
+        AbstractPhoto* item;
+    };
+
+    struct EntryLessThan
+    {
+        bool operator()(const Entry& entry, qreal value) const
+        {
+            return entry.value < value;
+        }
+
+        bool operator()(qreal value, const Entry& entry) const
+        {
+            return value < entry.value;
+        }
+    };
+
+public:
+
+    Private()
+        : targets(AllTargets)
+    {
+    }
+
+    QList<qreal> xValues(const QRectF& rect, bool page) const
+    {
+        QList<qreal> result;
+
+        if (targets & (page ? PageEdges : ItemEdges))
+            result << rect.left() << rect.right();
+
+        if (targets & (page ? PageCenter : ItemCenters))
+            result << rect.center().x();
+
+        return result;
+    }
+
+    QList<qreal> yValues(const QRectF& rect, bool page) const
+    {
+        QList<qreal> result;
+
+        if (targets & (page ? PageEdges : ItemEdges))
+            result << rect.top() << rect.bottom();
+
+        if (targets & (page ? PageCenter : ItemCenters))
+            result << rect.center().y();
+
+        return result;
+    }
+
+    static void insert(QVector<Entry>& entries, qreal value, AbstractPhoto* item)
+    {
+        Entry entry;
+        entry.value = value;
+        entry.item  = item;
+        entries.insert(std::upper_bound(entries.begin(), entries.end(), value, EntryLessThan()), entry);
+    }
+
+    static void remove(QVector<Entry>& entries, qreal value, AbstractPhoto* item)
+    {
+        QVector<Entry>::iterator it = std::lower_bound(entries.begin(), entries.end(), value, EntryLessThan());
+
+        for (; it != entries.end() && it->value == value; ++it)
+        {
+            if (it->item == item)
+            {
+                entries.erase(it);
+                return;
+            }
+        }
+    }
+
+    /// Finds the value closest to the position, returns false if there is none closer than tolerance
+    static bool nearest(const QVector<Entry>& entries, qreal position, qreal tolerance, qreal* result)
+    {
+        QVector<Entry>::const_iterator it = std::lower_bound(entries.constBegin(), entries.constEnd(), position, EntryLessThan());
+        qreal best                        = tolerance;
+        bool found                        = false;
+
+        if (it != entries.constEnd() && it->value - position <= best)
+        {
+            best    = it->value - position;
+            *result = it->value;
+            found   = true;
+        }
+
+        if (it != entries.constBegin())
+        {
+            const qreal distance = position - (it - 1)->value;
+
+            if (distance < best || (!found && distance <= best))
+            {
+                *result = (it - 1)->value;
+                found   = true;
+            }
+        }
+
+        return found;
+    }
+
+    void insertItem(AbstractPhoto* const item, const QRectF& rect)
+    {
+        foreach (qreal value, xValues(rect, false))
+            insert(x, value, item);
+
+        foreach (qreal value, yValues(rect, false))
+            insert(y, value, item);
+
+        rects.insert(item, rect);
+    }
+
+    void removeItem(AbstractPhoto* const item)
+    {
+        QHash<AbstractPhoto*, QRectF>::iterator it = rects.find(item);
+
+        if (it == rects.end())
+            return;
+
+        foreach (qreal value, xValues(it.value(), false))
+            remove(x, value, item);
+
+        foreach (qreal value, yValues(it.value(), false))
+            remove(y, value, item);
+
+        rects.erase(it);
+    }
+
+    void insertPage()
+    {
+        if (!pageRect.isValid())
+            return;
+
+        foreach (qreal value, xValues(pageRect, true))
+            insert(x, value, nullptr);
+
+        foreach (qreal value, yValues(pageRect, true))
+            insert(y, value, nullptr);
+    }
+
+    void removePage()
+    {
+        if (!pageRect.isValid())
+            return;
+
+        foreach (qreal value, xValues(pageRect, true))
+            remove(x, value, nullptr);
+
+        foreach (qreal value, yValues(pageRect, true))
+            remove(y, value, nullptr);
+    }
+
+    /// Re-reads geometry of changed items
+    void flush()
+    {
+        foreach (AbstractPhoto* const item, dirty)
+        {
+            if (excluded.contains(item))
+                continue;
+
+            removeItem(item);
+
+            if (item->scene())
+                insertItem(item, item->sceneBoundingRect());
+
+            dirty.remove(item);
+        }
+    }
+
+    int                           targets;
+    QRectF                        pageRect;
+    QVector<Entry>                x;
+    QVector<Entry>                y;
+    QHash<AbstractPhoto*, QRectF> rects;
+    QSet<AbstractPhoto*>          dirty;
+    QSet<AbstractPhoto*>          excluded;
+};
+
+PLESnapEngine::PLESnapEngine()
+    : d(new Private)
+{
+}
+
+PLESnapEngine::~PLESnapEngine()
+{
+    delete d;
+}
+
+void PLESnapEngine::setTargets(int targets)
+{
+    if (d->targets == targets)
+        return;
+
+    // Indexed positions depend on targets, everything is indexed again
+
+    foreach (AbstractPhoto* const item, d->rects.keys())
+        d->dirty.insert(item);
+
+    d->x.clear();
+    d->y.clear();
+    d->rects.clear();
+
+    d->targets = targets;
+    d->insertPage();
+}
+
+int PLESnapEngine::targets() const
+{
+    return d->targets;
+}
+
+void PLESnapEngine::setPageRect(const QRectF& rect)
+{
+    if (d->pageRect == rect)
+        return;
+
+    d->removePage();
+    d->pageRect = rect;
+    d->insertPage();
+}
+
+void PLESnapEngine::updateItem(AbstractPhoto* item)
+{
+    d->dirty.insert(item);
+}
+
+void PLESnapEngine::removeItem(AbstractPhoto* item)
+{
+    d->removeItem(item);
+    d->dirty.remove(item);
+    d->excluded.remove(item);
+}
+
+void PLESnapEngine::setExcluded(const QList<AbstractPhoto*>& items)
+{
+    // Previously excluded items are indexed again on the next query
+
+    foreach (AbstractPhoto* const item, d->excluded)
+        d->dirty.insert(item);
+
+    d->excluded.clear();
+
+    foreach (AbstractPhoto* const item, items)
+    {
+        d->removeItem(item);
+        d->dirty.insert(item);
+        d->excluded.insert(item);
+    }
+}
+
+void PLESnapEngine::clear()
+{
+    d->x.clear();
+    d->y.clear();
+    d->rects.clear();
+    d->dirty.clear();
+    d->excluded.clear();
+    d->insertPage();
+}
+
+PLESnapEngine::SnapResult PLESnapEngine::snap(const QRectF& rect, qreal tolerance)
+{
+    SnapResult result;
+
+    if (d->targets == NoTargets || tolerance <= 0)
+        return result;
+
+    d->flush();
+
+    qreal xDistance = tolerance;
+    qreal yDistance = tolerance;
+    qreal value     = 0;
+
+    const qreal xPositions[] = { rect.left(), rect.center().x(), rect.right() };
+    const qreal yPositions[] = { rect.top(),  rect.center().y(), rect.bottom() };
+
+    for (int i = 0; i < 3; ++i)
+    {
+        if (Private::nearest(d->x, xPositions[i], xDistance, &value))
+        {
+            xDistance       = qAbs(value - xPositions[i]);
+            result.snappedX = true;
+            result.x        = value;
+            result.offset.setX(value - xPositions[i]);
+        }
+
+        if (Private::nearest(d->y, yPositions[i], yDistance, &value))
+        {
+            yDistance       = qAbs(value - yPositions[i]);
+            result.snappedY = true;
+            result.y        = value;
+            result.offset.setY(value - yPositions[i]);
+        }
+    }
+
+    return result;
+}
+
+} // namespace PhotoLayoutsEditor
@@ -0,0 +1,111 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef PLE_SNAP_ENGINE_H
+#define PLE_SNAP_ENGINE_H
+
+// Qt includes
+
+#include <QList>
+#include <QRectF>
+#include <QPointF>
+
+namespace PhotoLayoutsEditor
+{
+
+class AbstractPhoto;
+
+/** Finds positions the moved rectangle should snap to.
+ * Edges and centres of the items and of the page are kept in two sorted arrays, one per axis,
+ * so every query is a binary search. Items are re-indexed lazily, changed items are only marked
+ * and they are updated before the next query. Items being moved are excluded from the index.
+ */
+class PLESnapEngine
+{
+public:
+
+    enum SnapTarget
+    {
+        NoTargets   = 0x0,
+        ItemEdges   = 0x1,
+        ItemCenters = 0x2,
+        PageEdges   = 0x4,
+        PageCenter  = 0x8,
+        AllTargets  = ItemEdges | ItemCenters | PageEdges | PageCenter
+    };
+
+    /// Result of the query, offset moves the rectangle onto the snapped positions
+    struct SnapResult
+    {
+        SnapResult()
+            : snappedX(false),
+              snappedY(false),
+              x(0),
+              y(0)
+        {
+        }
+
+        QPointF offset;
+        bool    snappedX;
+        bool    snappedY;
+        qreal   x;
+        qreal   y;
+    };
+
+public:
+
+    PLESnapEngine();
+    ~PLESnapEngine();
+
+    void setTargets(int targets);
+    int targets() const;
+
+    void setPageRect(const QRectF& rect);
+
+    /// Marks item's geometry as changed, it's read again before the next query
+    void updateItem(AbstractPhoto* item);
+    void removeItem(AbstractPhoto* item);
+
+    /// Items which are not snapped to, they are usually the moved ones
+    void setExcluded(const QList<AbstractPhoto*>& items);
+
+    void clear();
+
+    /// Snaps edges and centre of the rectangle to the nearest targets closer than tolerance
+    SnapResult snap(const QRectF& rect, qreal tolerance);
+
+private:
+
+    PLESnapEngine(const PLESnapEngine&);
+    PLESnapEngine& operator=(const PLESnapEngine&);
+
+private:
+
+    class Private;
+    Private* const d;
+};
+
+} // namespace PhotoLayoutsEditor
+
+#endif // PLE_SNAP_ENGINE_H
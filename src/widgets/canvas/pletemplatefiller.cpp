@@ -0,0 +1,319 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2020-06-12
+ * Description : automatic filling of photo items in layout templates.
+ *
+ * Copyright (C) 2020      by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+
+#include "pletemplatefiller.h"
+
+// C++ includes
+
+#include <limits>
+
+// Qt includes
+
+#include <QImageReader>
+#include <QUrl>
+#include <QtConcurrent>
+#include <QtMath>
+#include <QDebug>
+
+// Local includes
+
+#include "plescene.h"
+#include "photoitem.h"
+
+namespace PhotoLayoutsEditor
+{
+
+/// Photo file decoded for a slot of given size in pixels
+struct PLESlotPhoto
+{
+    QString fileName;
+    QSize   size;
+};
+
+static bool isTransposed(const QImageReader& reader)
+{
+    return reader.transformation().testFlag(QImageIOHandler::TransformationRotate90);
+}
+
+/// Size of the photo as it's displayed, read from the file header only
+static QSize readPhotoSize(const QString& fileName)
+{
+    QImageReader reader(fileName);
+    reader.setAutoTransform(true);
+    const QSize size = reader.size();
+
+    return (isTransposed(reader) ? size.transposed() : size);
+}
+
+static QImage readSlotPhoto(const PLESlotPhoto& photo)
+{
+    QImageReader reader(photo.fileName);
+    reader.setAutoTransform(true);
+    const QSize size = reader.size();
+
+    // Decoder scales the image before it's rotated, large photos are never decoded in full size
+    if (size.isValid() && photo.size.isValid())
+    {
+        const QSize target = (isTransposed(reader) ? photo.size.transposed() : photo.size);
+        const QSize scaled = size.scaled(target, Qt::KeepAspectRatioByExpanding);
+
+        if (scaled.width() < size.width())
+            reader.setScaledSize(scaled);
+    }
+
+    return reader.read();
+}
+
+/// Assignment of rows to columns with minimal cost (Hungarian method), cost matrix can't have more rows than columns
+static QVector<int> minimalAssignment(const QVector<QVector<qreal> >& cost)
+{
+    const int rows    = cost.count();
+    const int columns = (rows ? cost.first().count() : 0);
+    const qreal inf   = std::numeric_limits<qreal>::max();
+
+    // Potentials and matching are indexed from 1, column 0 is the row being assigned
+    QVector<qreal> u(rows + 1, 0);
+    QVector<qreal> v(columns + 1, 0);
+    QVector<qreal> minv(columns + 1);
+    QVector<int>   match(columns + 1, 0);
+    QVector<int>   way(columns + 1, 0);
+    QVector<bool>  used(columns + 1);
+
+    for (int i = 1 ; i <= rows ; ++i)
+    {
+        match[0] = i;
+        int j0   = 0;
+        minv.fill(inf);
+        used.fill(false);
+
+        do
+        {
+            used[j0]     = true;
+            const int i0 = match.at(j0);
+            qreal delta  = inf;
+            int j1       = 0;
+
+            for (int j = 1 ; j <= columns ; ++j)
+            {
+                if (used.at(j))
+                    continue;
+
+                const qreal current = cost.at(i0 - 1).at(j - 1) - u.at(i0) - v.at(j);
+
+                if (current < minv.at(j))
+                {
+                    minv[j] = current;
+                    way[j]  = j0;
+                }
+
+                if (minv.at(j) < delta)
+                {
+                    delta = minv.at(j);
+                    j1    = j;
+                }
+            }
+
+            for (int j = 0 ; j <= columns ; ++j)
+            {
+                if (used.at(j))
+                {
+                    u[match.at(j)] += delta;
+                    v[j]           -= delta;
+                }
+                else
+                {
+                    minv[j] -= delta;
+                }
+            }
+
+            j0 = j1;
+        }
+        while (match.at(j0) != 0);
+
+        // Augmenting path
+        do
+        {
+            const int j1 = way.at(j0);
+            match[j0]    = match.at(j1);
+            j0           = j1;
+        }
+        while (j0);
+    }
+
+    QVector<int> result(rows, -1);
+
+    for (int j = 1 ; j <= columns ; ++j)
+    {
+        if (match.at(j))
+            result[match.at(j) - 1] = j - 1;
+    }
+
+    return result;
+}
+
+PLETemplateFiller::PLETemplateFiller(PLEScene* scene)
+    : m_scene(scene)
+{
+}
+
+QList<PhotoItem*> PLETemplateFiller::emptyPhotos() const
+{
+    QList<PhotoItem*> result;
+
+    if (!m_scene)
+        return result;
+
+    foreach (QGraphicsItem* const item, m_scene->items(Qt::AscendingOrder))
+    {
+        PhotoItem* const photo = dynamic_cast<PhotoItem*>(item);
+
+        if (photo && photo->isEmpty() && !photo->itemDrawArea().boundingRect().isEmpty())
+            result << photo;
+    }
+
+    return result;
+}
+
+int PLETemplateFiller::fill(const QStringList& files, qreal resolution)
+{
+    m_errors.clear();
+
+    const QList<PhotoItem*> photos = emptyPhotos();
+
+    if (photos.isEmpty() || files.isEmpty())
+        return 0;
+
+    // Only headers are read to match photos, decoding waits for slot sizes
+    const QList<QSize> sizes = QtConcurrent::blockingMapped<QList<QSize> >(files, readPhotoSize);
+    QStringList  readable;
+    QList<QSize> readableSizes;
+
+    for (int i = 0 ; i < files.count() ; ++i)
+    {
+        if (sizes.at(i).isEmpty())
+        {
+            m_errors << QObject::tr("Can't read image: %1").arg(files.at(i));
+            continue;
+        }
+
+        readable      << files.at(i);
+        readableSizes << sizes.at(i);
+    }
+
+    QList<QSizeF> slotSizes;
+
+    foreach (PhotoItem* const photo, photos)
+        slotSizes << photo->itemDrawArea().boundingRect().size();
+
+    const QVector<int> assignment = assign(slotSizes, readableSizes);
+    QList<PLESlotPhoto> requests;
+    QList<PhotoItem*>   targets;
+
+    for (int i = 0 ; i < assignment.count() ; ++i)
+    {
+        if (assignment.at(i) < 0)
+            continue;
+
+        PLESlotPhoto request;
+        request.fileName = readable.at(assignment.at(i));
+
+        if (resolution > 0)
+        {
+            const qreal scale = resolution * qSqrt(qAbs(photos.at(i)->sceneTransform().determinant()));
+            request.size      = QSize(qCeil(slotSizes.at(i).width()  * scale),
+                                      qCeil(slotSizes.at(i).height() * scale));
+        }
+
+        requests << request;
+        targets  << photos.at(i);
+    }
+
+    const QList<QImage> images = QtConcurrent::blockingMapped<QList<QImage> >(requests, readSlotPhoto);
+    int filled                 = 0;
+
+    for (int i = 0 ; i < images.count() ; ++i)
+    {
+        if (images.at(i).isNull())
+        {
+            m_errors << QObject::tr("Can't read image: %1").arg(requests.at(i).fileName);
+            continue;
+        }
+
+        targets.at(i)->fillWithImage(images.at(i), QUrl::fromLocalFile(requests.at(i).fileName));
+        ++filled;
+    }
+
+    return filled;
+}
+
+QStringList PLETemplateFiller::errors() const
+{
+    return m_errors;
+}
+
+QVector<int> PLETemplateFiller::assign(const QList<QSizeF>& slotSizes, const QList<QSize>& photoSizes)
+{
+    QVector<int> result(slotSizes.count(), -1);
+
+    if (slotSizes.isEmpty() || photoSizes.isEmpty())
+        return result;
+
+    // Rows are the shorter side of the cost matrix
+    const bool slotRows = (slotSizes.count() <= photoSizes.count());
+    const int rows      = (slotRows ? slotSizes.count()  : photoSizes.count());
+    const int columns   = (slotRows ? photoSizes.count() : slotSizes.count());
+    QVector<QVector<qreal> > cost(rows, QVector<qreal>(columns));
+
+    for (int s = 0 ; s < slotSizes.count() ; ++s)
+    {
+        const qreal slotAspect = qLn(slotSizes.at(s).width() / slotSizes.at(s).height());
+
+        for (int p = 0 ; p < photoSizes.count() ; ++p)
+        {
+            const qreal photoAspect = qLn(qreal(photoSizes.at(p).width()) / photoSizes.at(p).height());
+
+            // Small penalty for the distance in the stacking order breaks ties in favour of the given order
+            const qreal value = qAbs(slotAspect - photoAspect) + 1e-6 * qAbs(s - p);
+
+            if (slotRows)
+                cost[s][p] = value;
+            else
+                cost[p][s] = value;
+        }
+    }
+
+    const QVector<int> match = minimalAssignment(cost);
+
+    for (int r = 0 ; r < match.count() ; ++r)
+    {
+        if (slotRows)
+            result[r] = match.at(r);
+        else if (match.at(r) >= 0)
+            result[match.at(r)] = r;
+    }
+
+    return result;
+}
+
+} // namespace PhotoLayoutsEditor
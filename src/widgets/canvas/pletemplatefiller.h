@@ -0,0 +1,77 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2020-06-12
+ * Description : automatic filling of photo items in layout templates.
+ *
+ * Copyright (C) 2020      by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef PLE_TEMPLATE_FILLER_H
+#define PLE_TEMPLATE_FILLER_H
+
+// Qt includes
+
+#include <QList>
+#include <QSize>
+#include <QStringList>
+#include <QVector>
+
+namespace PhotoLayoutsEditor
+{
+
+class PLEScene;
+class PhotoItem;
+
+/** Fills empty photo items (template slots) of the scene with photos from files.
+ * Photos are matched to slots by aspect ratio with an optimal assignment, decoded at the
+ * resolution of their slots and centered in slot shapes, which are kept unchanged.
+ * Works without the editor window, so it can be used by batch rendering.
+ */
+class PLETemplateFiller
+{
+public:
+
+    explicit PLETemplateFiller(PLEScene* scene);
+
+    /// Empty photo items of the scene in the stacking order
+    QList<PhotoItem*> emptyPhotos() const;
+
+    /** Fills empty photo items with given files and returns count of filled items.
+     * Resolution is given in pixels per scene unit, photos are decoded in full size if it's not positive.
+     * When there are more photos than empty items, photos matching the slots best are used.
+     */
+    int fill(const QStringList& files, qreal resolution = 0);
+
+    /// Errors of the last fill() call
+    QStringList errors() const;
+
+    /** Assigns photos to slots minimizing sum of differences of their aspect ratios (in log scale).
+     * Returns index of the photo for every slot, -1 for slots left empty.
+     * Among equally good assignments the one keeping the order of photos is preferred.
+     */
+    static QVector<int> assign(const QList<QSizeF>& slotSizes, const QList<QSize>& photoSizes);
+
+private:
+
+    PLEScene*   m_scene;
+    QStringList m_errors;
+};
+
+} // namespace PhotoLayoutsEditor
+
+#endif // PLE_TEMPLATE_FILLER_H
@@ -68,6 +68,7 @@ private Q_SLOTS:
     void updateShapes();
 
     friend class ScalingWidgetItemPrivate;
+    friend class PLEScene;
 
     friend class MoveItemCommand;
     friend class ScaleItemCommand;
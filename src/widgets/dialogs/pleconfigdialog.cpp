@@ -35,6 +35,14 @@
 #include <QCheckBox>
 #include <QDialogButtonBox>
 #include <QPushButton>
+#include <QHBoxLayout>
+#include <QLineEdit>
+#include <QComboBox>
+#include <QFileDialog>
+
+// Local includes
+
+#include "plecolortransform.h"
 
 namespace PhotoLayoutsEditor
 {
@@ -45,16 +53,29 @@ public:
 
     explicit Private()
         : antialiasing(nullptr),
+          staticLayerCache(nullptr),
           xGrid(nullptr),
           yGrid(nullptr),
-          showGrid(nullptr)
+          showGrid(nullptr),
+          colorProfile(nullptr),
+          renderingIntent(nullptr)
     {
+        // Suffixes of the formats which can be written next to the exported file
+        additionalSuffixes << QLatin1String("png")
+                           << QLatin1String("jpg")
+                           << QLatin1String("tif")
+                           << QLatin1String("pdf");
     }
 
-    QCheckBox*      antialiasing;
-    QDoubleSpinBox* xGrid;
-    QDoubleSpinBox* yGrid;
-    QCheckBox*      showGrid;
+    QCheckBox*        antialiasing;
+    QCheckBox*        staticLayerCache;
+    QDoubleSpinBox*   xGrid;
+    QDoubleSpinBox*   yGrid;
+    QCheckBox*        showGrid;
+    QStringList       additionalSuffixes;
+    QList<QCheckBox*> additionalFormats;
+    QLineEdit*        colorProfile;
+    QComboBox*        renderingIntent;
 };
 
 PLEConfigDialog::PLEConfigDialog(QWidget* const parent)
@@ -67,6 +88,9 @@ PLEConfigDialog::PLEConfigDialog(QWidget* const parent)
     d->antialiasing                  = new QCheckBox(QObject::tr("Antialiasing"), this);
     vlay->addWidget(d->antialiasing);
 
+    d->staticLayerCache              = new QCheckBox(QObject::tr("Cache not moved items while dragging"), this);
+    vlay->addWidget(d->staticLayerCache);
+
     QGroupBox* const gridBox         = new QGroupBox(QObject::tr("Grid"), this);
     QFormLayout* const gridLayout    = new QFormLayout();
     gridBox->setLayout(gridLayout);
@@ -93,6 +117,50 @@ PLEConfigDialog::PLEConfigDialog(QWidget* const parent)
 
     // ---
 
+    QGroupBox* const exportBox       = new QGroupBox(QObject::tr("Export"), this);
+    QFormLayout* const exportLayout  = new QFormLayout();
+    exportBox->setLayout(exportLayout);
+
+    QHBoxLayout* const formatsLayout = new QHBoxLayout();
+
+    foreach (const QString& suffix, d->additionalSuffixes)
+    {
+        QCheckBox* const format      = new QCheckBox(suffix.toUpper(), exportBox);
+        d->additionalFormats << format;
+        formatsLayout->addWidget(format);
+    }
+
+    formatsLayout->addStretch();
+
+    exportLayout->addRow(QObject::tr("Also write"), formatsLayout);
+
+    QHBoxLayout* const profileLayout = new QHBoxLayout();
+    d->colorProfile                  = new QLineEdit(exportBox);
+    d->colorProfile->setPlaceholderText(QObject::tr("sRGB"));
+    d->colorProfile->setClearButtonEnabled(true);
+    profileLayout->addWidget(d->colorProfile);
+
+    QPushButton* const profileButton = new QPushButton(QObject::tr("Browse..."), exportBox);
+    profileLayout->addWidget(profileButton);
+
+    connect(profileButton, SIGNAL(clicked()),
+            this, SLOT(selectColorProfile()));
+
+    exportLayout->addRow(QObject::tr("Color profile"), profileLayout);
+
+    // Items are in the order of PLEColorTransform::RenderingIntent values
+    d->renderingIntent               = new QComboBox(exportBox);
+    d->renderingIntent->addItem(QObject::tr("Perceptual"));
+    d->renderingIntent->addItem(QObject::tr("Relative colorimetric"));
+    d->renderingIntent->addItem(QObject::tr("Saturation"));
+    d->renderingIntent->addItem(QObject::tr("Absolute colorimetric"));
+
+    exportLayout->addRow(QObject::tr("Rendering intent"), d->renderingIntent);
+
+    vlay->addWidget(exportBox);
+
+    // ---
+
     QDialogButtonBox* const buttons  = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
     buttons->button(QDialogButtonBox::Ok)->setDefault(true);
     vlay->addWidget(buttons);
@@ -120,10 +188,27 @@ void PLEConfigDialog::saveSettings()
     config.beginGroup(QLatin1String("View"));
 
     config.setValue(QLatin1String("Antialiasing"), d->antialiasing->isChecked());
+    config.setValue(QLatin1String("StaticLayerCache"), d->staticLayerCache->isChecked());
     config.setValue(QLatin1String("ShowGrid"),     d->showGrid->isChecked());
     config.setValue(QLatin1String("XGrid"),        d->xGrid->value());
     config.setValue(QLatin1String("YGrid"),        d->yGrid->value());
 
+    config.endGroup();
+
+    QStringList formats;
+
+    for (int i = 0 ; i < d->additionalFormats.count() ; ++i)
+    {
+        if (d->additionalFormats.at(i)->isChecked())
+            formats << d->additionalSuffixes.at(i);
+    }
+
+    config.beginGroup(QLatin1String("Export"));
+
+    config.setValue(QLatin1String("AdditionalFormats"), formats);
+    config.setValue(QLatin1String("ColorProfile"),      d->colorProfile->text().trimmed());
+    config.setValue(QLatin1String("RenderingIntent"),   d->renderingIntent->currentIndex());
+
     config.endGroup();
     config.sync();
 }
@@ -134,11 +219,35 @@ void PLEConfigDialog::loadSettings()
     config.beginGroup(QLatin1String("View"));
 
     d->antialiasing->setChecked(config.value(QLatin1String("Antialiasing"), false).toBool());
+    d->staticLayerCache->setChecked(config.value(QLatin1String("StaticLayerCache"), true).toBool());
     d->showGrid->setChecked(config.value(QLatin1String("ShowGrid"), false).toBool());
     d->xGrid->setValue(config.value(QLatin1String("XGrid"), 25.0).toDouble());
     d->yGrid->setValue(config.value(QLatin1String("YGrid"), 25.0).toDouble());
 
     config.endGroup();
+
+    config.beginGroup(QLatin1String("Export"));
+
+    const QStringList formats = config.value(QLatin1String("AdditionalFormats"), QStringList()).toStringList();
+
+    for (int i = 0 ; i < d->additionalFormats.count() ; ++i)
+        d->additionalFormats.at(i)->setChecked(formats.contains(d->additionalSuffixes.at(i)));
+
+    d->colorProfile->setText(config.value(QLatin1String("ColorProfile"), QString()).toString());
+    d->renderingIntent->setCurrentIndex(qBound(0, config.value(QLatin1String("RenderingIntent"),
+                                                               int(PLEColorTransform::Perceptual)).toInt(), 3));
+
+    config.endGroup();
+}
+
+void PLEConfigDialog::selectColorProfile()
+{
+    const QString fileName = QFileDialog::getOpenFileName(this, QObject::tr("Select Color Profile"),
+                                                          d->colorProfile->text(),
+                                                          QObject::tr("ICC Profiles (*.icc *.icm)"));
+
+    if (!fileName.isEmpty())
+        d->colorProfile->setText(fileName);
 }
 
 } // namespace PhotoLayoutsEditor
@@ -36,12 +36,17 @@ namespace PhotoLayoutsEditor
 
 class PLEConfigDialog : public QDialog
 {
+    Q_OBJECT
 
 public:
 
     explicit PLEConfigDialog(QWidget* const parent = nullptr);
     ~PLEConfigDialog() override;
 
+private Q_SLOTS:
+
+    void selectColorProfile();
+
 private:
 
     void saveSettings();
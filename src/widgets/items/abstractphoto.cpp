@@ -133,6 +133,12 @@ AbstractPhoto::AbstractPhoto(const QString& name, PLEScene* scene)
 AbstractPhoto::~AbstractPhoto()
 {
     qDebug() << "Abstractphoto delete";
+
+    PLEScene* const scene = qobject_cast<PLEScene*>(this->scene());
+
+    if (scene)
+        scene->removeFromSnapIndex(this);
+
     d->m_effects_group->deleteLater();
     d->m_borders_group->deleteLater();
     delete d;
@@ -190,27 +196,86 @@ QString AbstractPhoto::uniqueName(const QString& name)
 
 QRectF AbstractPhoto::boundingRect() const
 {
-    return shape().boundingRect();
+    updateGeometryCache();
+
+    return d->m_bounding_rect;
 }
 
 QPainterPath AbstractPhoto::shape() const
 {
-    QPainterPath result = this->itemShape();
-
-    if (d->m_borders_group)
-        result = result.united(bordersGroup()->shape());
+    updateGeometryCache();
 
-    return result;
+    return d->m_shape;
 }
 
 QPainterPath AbstractPhoto::opaqueArea() const
 {
-    QPainterPath result = this->itemOpaqueArea();
+    updateGeometryCache();
+
+    return d->m_opaque_area;
+}
+
+void AbstractPhoto::updateGeometryCache() const
+{
+    if (d->m_geometry_valid)
+        return;
 
+    d->m_shape       = this->itemShape();
+    d->m_opaque_area = this->itemOpaqueArea();
+
+    // Scene index asks for bounding rect very often, paths are united only once per change
     if (d->m_borders_group)
-        result = result.united(bordersGroup()->shape());
+    {
+        const QPainterPath borders = bordersGroup()->shape();
 
-    return result;
+        if (!borders.isEmpty())
+        {
+            d->m_shape       = d->m_shape.united(borders);
+            d->m_opaque_area = d->m_opaque_area.united(borders);
+        }
+    }
+
+    d->m_bounding_rect  = d->m_shape.boundingRect();
+    d->m_geometry_valid = true;
+}
+
+void AbstractPhoto::invalidateGeometry()
+{
+    // Scene reads the old bounding rect, which is still cached
+    prepareGeometryChange();
+    d->m_geometry_valid = false;
+    ++d->m_geometry_revision;
+    updateSnapIndex();
+}
+
+void AbstractPhoto::updateSnapIndex()
+{
+    PLEScene* const scene = qobject_cast<PLEScene*>(this->scene());
+
+    if (scene)
+        scene->updateSnapIndex(this);
+}
+
+int AbstractPhoto::geometryRevision() const
+{
+    return d->m_geometry_revision;
+}
+
+void AbstractPhoto::beginMove()
+{
+    d->m_moving = true;
+    d->m_moved  = false;
+}
+
+void AbstractPhoto::endMove()
+{
+    if (!d->m_moving)
+        return;
+
+    d->m_moving = false;
+
+    if (d->m_moved)
+        Q_EMIT changed();
 }
 
 QDomDocument AbstractPhoto::toSvg() const
@@ -604,13 +669,34 @@ QVariant AbstractPhoto::itemChange(GraphicsItemChange change, const QVariant& va
         case ItemRotationHasChanged:
         case ItemTransformHasChanged:
             d->m_transform = this->transform();
+            updateSnapIndex();
             Q_EMIT changed();
             break;
 
+        case ItemSceneChange:
+        {
+            PLEScene* const scene = qobject_cast<PLEScene*>(this->scene());
+
+            if (scene)
+                scene->removeFromSnapIndex(this);
+
+            break;
+        }
+
+        case ItemSceneHasChanged:
+            updateSnapIndex();
+            break;
+
         case ItemPositionHasChanged:
         case ItemScenePositionHasChanged:
             d->m_pos = this->pos();
-            Q_EMIT changed();
+            updateSnapIndex();
+
+            if (d->m_moving)
+                d->m_moved = true;
+            else
+                Q_EMIT changed();
+
             break;
 
         default:
@@ -716,6 +802,8 @@ void AbstractPhoto::refresh()
     if (d->m_borders_group)
         d->m_borders_group->refresh();
 
+    invalidateGeometry();
+
     Q_EMIT changed();
 }
 
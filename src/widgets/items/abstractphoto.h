@@ -65,6 +65,7 @@ public:
     /** Returns item's bounding rectangle.
         * \note This methods shouldn't be reimplemented because it's taking into account borders shape.
         * Reimplement \fn itemShape() and \fn itemOpaqueArea() methods instead.
+        * \note Geometry is cached, see \fn invalidateGeometry().
         */
     QRectF boundingRect() const override;
 
@@ -148,6 +149,15 @@ public:
     Q_PROPERTY(QString m_id READ id)
     QString id() const;
 
+    /// Number incremented with every change of the item's shape, shapes derived from it may be cached until it changes
+    int geometryRevision() const;
+
+    /** Starts interactive move of the item, position changes don't emit \fn changed() until \fn endMove(),
+        * which emits it once if the item was moved.
+        */
+    void beginMove();
+    void endMove();
+
     /// Crops item to shape passed in method's argument
     Q_PROPERTY(QPainterPath m_crop_shape READ cropShape WRITE setCropShape)
     void setCropShape(const QPainterPath& cropShape);
@@ -214,6 +224,11 @@ protected:
     /// Creates unique name (on whole scene)
     QString uniqueName(const QString& name);
 
+    /** Drops cached shape, opaque area and bounding rect and notifies the scene about geometry change.
+        * Has to be called whenever result of \fn itemShape() or \fn itemOpaqueArea() changes.
+        */
+    void invalidateGeometry();
+
     /// Photo resizer class
     class AbstractPhotoResizer;
     friend class AbstractPhotoResizer;
@@ -225,6 +240,12 @@ private:
 
     void setupItem();
 
+    /// Computes shapes including borders if they aren't cached
+    void updateGeometryCache() const;
+
+    /// Lets the scene re-index item's edges for snapping
+    void updateSnapIndex();
+
     AbstractPhotoPrivate* d;
     friend class AbstractPhotoPrivate;
 
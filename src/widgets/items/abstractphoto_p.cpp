@@ -35,7 +35,11 @@ AbstractPhotoPrivate::AbstractPhotoPrivate(AbstractPhoto* item)
     : m_item(item),
       m_visible(true),
       m_effects_group(nullptr),
-      m_borders_group(nullptr)
+      m_borders_group(nullptr),
+      m_geometry_valid(false),
+      m_geometry_revision(0),
+      m_moving(false),
+      m_moved(false)
 {
 }
 
@@ -68,6 +68,17 @@ public:
     // Icon object
     QIcon              m_icon;
 
+    // Geometry cache, valid until AbstractPhoto::invalidateGeometry() is called
+    mutable bool         m_geometry_valid;
+    mutable QPainterPath m_shape;
+    mutable QPainterPath m_opaque_area;
+    mutable QRectF       m_bounding_rect;
+    int                  m_geometry_revision;
+
+    // Position changes of the dragged item are reported once the drag ends
+    bool                 m_moving;
+    bool                 m_moved;
+
     friend class AbstractPhoto;
     friend class AbstractPhotoItemLoader;
     friend class CropShapeChangeCommand;
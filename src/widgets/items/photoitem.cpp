@@ -29,12 +29,20 @@
 #include <QBuffer>
 #include <QStyleOptionGraphicsItem>
 #include <QFile>
+#include <QFileInfo>
 #include <QImageReader>
 #include <QGraphicsScene>
+#include <QGraphicsView>
+#include <QtMath>
 #include <QMimeData>
 #include <QApplication>
 #include <QMessageBox>
 #include <QDebug>
+#include <QtConcurrent>
+
+// digiKam includes
+
+#include "drawdecoder.h"
 
 // Local includes
 
@@ -42,20 +50,73 @@
 #include "imagedialog.h"
 #include "bordersgroup.h"
 #include "pleglobal.h"
+#include "plesvgimagestore.h"
 #include "plewindow.h"
 #include "imageloadingthread.h"
 #include "progressevent.h"
+#include "plecanvas.h"
 
 #define EMPTY_FILL_COLOR QColor(255, 0, 0, 120)
 
+// Coarsest level of the previews pyramid, 1/16 pixel per scene unit
+#define MIN_LEVEL (-4)
+
+// Width and height of the item icon in pixels
+#define ICON_SIZE 48
+
+// Images of photos farther from the visible area of views than this part of its size are released
+#define VIEW_MARGIN 0.5
+
 using namespace Digikam;
 
 namespace PhotoLayoutsEditor
 {
 
+/// Scales the image to cover the size, the image is halved first so the last smooth scaling doesn't skip pixels
+static QImage scaleLevel(const QImage& image, const QSize& size)
+{
+    QImage source = image;
+
+    while (source.width() / 2 >= size.width() && source.height() / 2 >= size.height())
+        source = source.scaled(source.size() / 2, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+
+    return source.scaled(size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+}
+
+/// Renders level of the previews pyramid in a worker thread, effects are applied with \a scale pixels per scene unit
+static PhotoItemLevel renderLevel(const QImage& source, const QSize& size, const PhotoEffectsChain& effects, qreal scale)
+{
+    PhotoItemLevel result;
+    result.raw   = scaleLevel(source, size);
+    result.image = effects.apply(result.raw, scale);
+
+    return result;
+}
+
+bool PhotoItemFill::isNull() const
+{
+    return source.isNull();
+}
+
+QSize PhotoItemFill::imageSize() const
+{
+    return source.size().scaled(size, Qt::KeepAspectRatioByExpanding);
+}
+
+QImage PhotoItemFill::render() const
+{
+    if (source.isNull())
+        return QImage();
+
+    // Same scaling as PhotoItem::effectiveImage() does
+    return effects.apply(source.scaled(size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation), scale);
+}
+
 class PhotoItemPixmapChangeCommand : public QUndoCommand
 {
     QImage     m_image;
+    QByteArray m_image_data;
+    bool       m_image_from_file;
     PhotoItem* m_item;
 
 public:
@@ -63,6 +124,7 @@ public:
     PhotoItemPixmapChangeCommand(const QImage& image, PhotoItem* item, QUndoCommand* parent = nullptr)
         : QUndoCommand(QObject::tr("Image Change"), parent),
           m_image(image),
+          m_image_from_file(false),
           m_item(item)
     {
     }
@@ -70,24 +132,41 @@ public:
     PhotoItemPixmapChangeCommand(const QPixmap& pixmap, PhotoItem* item, QUndoCommand* parent = nullptr)
         : QUndoCommand(QObject::tr("Image Change"), parent),
           m_image(pixmap.toImage()),
+          m_image_from_file(false),
           m_item(item)
     {
     }
 
+    /// Image is decoded from the file the item's url is changed to in the same group
+    void setImageFromFile(bool fromFile)
+    {
+        m_image_from_file = fromFile;
+    }
+
     void redo() override
     {
-        QImage temp = m_item->image();
-        m_item->d->setImage(m_image);
-        m_image = temp;
+        run();
     }
 
     void undo() override
     {
-        QImage temp = m_item->image();
-        m_item->d->setImage(m_image);
-        m_image = temp;
+        run();
         m_item->update();
     }
+
+    void run()
+    {
+        // Record of the image is swapped with it, so the image can be released again
+        QImage temp                  = m_item->image();
+        QByteArray data              = m_item->d->m_image_data;
+        bool fromFile                = m_item->d->m_image_from_file;
+        m_item->d->m_image_data      = m_image_data;
+        m_item->d->m_image_from_file = m_image_from_file;
+        m_item->d->setImage(m_image);
+        m_image                      = temp;
+        m_image_data                 = data;
+        m_image_from_file            = fromFile;
+    }
 };
 
 class PhotoItemUrlChangeCommand : public QUndoCommand
@@ -122,6 +201,35 @@ public:
     }
 };
 
+class PhotoItemImageCoverCommand : public QUndoCommand
+{
+    QTransform m_transform;
+    PhotoItem* m_item;
+
+public:
+
+    explicit PhotoItemImageCoverCommand(PhotoItem* item, QUndoCommand* parent = nullptr)
+        : QUndoCommand(QObject::tr("Image Change"), parent),
+          m_item(item)
+    {
+    }
+
+    void redo() override
+    {
+        m_transform                  = m_item->d->m_brush_transform;
+        m_item->d->m_brush_transform = m_item->coverTransform();
+        m_item->d->m_fill_revision   = -1;
+        m_item->update();
+    }
+
+    void undo() override
+    {
+        m_item->d->m_brush_transform = m_transform;
+        m_item->d->m_fill_revision   = -1;
+        m_item->update();
+    }
+};
+
 class PhotoItemImagePathChangeCommand : public QUndoCommand
 {
     PhotoItem*              m_item;
@@ -140,8 +248,11 @@ public:
 
     void redo() override
     {
+        // Image scaled to cover the shape, as the effective image is
+        const QSizeF size    = QSizeF(m_item->image().size()).scaled(m_item->m_image_path.boundingRect().size(),
+                                                                  Qt::KeepAspectRatioByExpanding);
         m_item->m_image_path = QPainterPath();
-        m_item->m_image_path.addRect(m_item->m_temp_image.rect());
+        m_item->m_image_path.addRect(QRectF(QPointF(0, 0), size));
         m_item->recalcShape();
         m_item->update();
     }
@@ -192,6 +303,7 @@ public:
         m_item->d->m_brush_transform.translate(m_translation.x(), m_translation.y());
         m_item->d->m_complete_path_transform.translate(m_translation.x(), m_translation.y());
         m_item->m_complete_path.translate(m_translation);
+        m_item->d->m_fill_revision = -1;
         m_item->update();
         done = !done;
     }
@@ -204,6 +316,7 @@ public:
         m_item->d->m_brush_transform.translate(-m_translation.x(), -m_translation.y());
         m_item->d->m_complete_path_transform.translate(-m_translation.x(), -m_translation.y());
         m_item->m_complete_path.translate(-m_translation);
+        m_item->d->m_fill_revision = -1;
         m_item->update();
         done = !done;
     }
@@ -266,12 +379,60 @@ void PhotoItem::PhotoItemPrivate::setImage(const QImage& image)
 
 QImage& PhotoItem::PhotoItemPrivate::image()
 {
+    // Released image is needed before it's decoded in background
+    if (m_image_released)
+        m_item->restoreImage();
+
+    if (m_image_restoring)
+    {
+        m_image_restoring->waitForFinished();
+        m_item->imageRestored();
+    }
+
     return m_image;
 }
 
+QImage PhotoItem::PhotoItemPrivate::decodeImage(const QByteArray& data)
+{
+    // Files are decoded the same way by ImageLoadingThread
+    return QImage::fromData(data);
+}
+
+bool PhotoItem::PhotoItemPrivate::hasImageRecord() const
+{
+    if (!m_image_data.isEmpty())
+        return true;
+
+    // Raw files aren't decoded by QImage and changed files don't contain the image anymore
+    return (m_image_from_file                                    &&
+            m_file_path.isLocalFile()                            &&
+            m_file_modified.isValid()                            &&
+            !DRawDecoder::isRawFile(m_file_path)                 &&
+            QFileInfo(m_file_path.toLocalFile()).lastModified() == m_file_modified);
+}
+
+QByteArray PhotoItem::PhotoItemPrivate::imageData() const
+{
+    if (!m_image_data.isEmpty() || !hasImageRecord())
+        return m_image_data;
+
+    QFile file(m_file_path.toLocalFile());
+
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+
+    return file.readAll();
+}
+
+QSize PhotoItem::PhotoItemPrivate::imageSize() const
+{
+    return (m_image_released ? m_released_size : m_image.size());
+}
+
 void PhotoItem::PhotoItemPrivate::setFileUrl(const QUrl& url)
 {
-    m_file_path = url;
+    m_file_path     = url;
+    m_file_modified = (url.isLocalFile() ? QFileInfo(url.toLocalFile()).lastModified() : QDateTime());
 }
 
 QUrl& PhotoItem::PhotoItemPrivate::fileUrl()
@@ -359,28 +520,34 @@ QDomDocument PhotoItem::toSvg() const
         QDomElement image = document1.createElementNS(PhotoLayoutsEditor::uri(), QLatin1String("image"));
         appNS.appendChild(image);
 
-        bool embed = false;
-        int result = QMessageBox::question(qApp->activeWindow(),
-                                           QObject::tr("Saving: %1").arg(name()),
-                                           QObject::tr("Do you want to embed images data?"
-                                                "\n"
-                                                "\nRemember that when you move or rename image files on your "
-                                                "\ndisk or the storage device become unavailable, those "
-                                                "\nimages become unavailable for %1 "
-                                                "\nand this layout might become broken.").arg(QApplication::applicationName()));
-        if (result != QMessageBox::Yes)
+        // Internal copies of the scene always embed images
+        bool embed = PLESvgImageStore::isInternalCopy();
+
+        if (!embed)
         {
-            embed = true;
+            int result = QMessageBox::question(qApp->activeWindow(),
+                                               QObject::tr("Saving: %1").arg(name()),
+                                               QObject::tr("Do you want to embed images data?"
+                                                    "\n"
+                                                    "\nRemember that when you move or rename image files on your "
+                                                    "\ndisk or the storage device become unavailable, those "
+                                                    "\nimages become unavailable for %1 "
+                                                    "\nand this layout might become broken.").arg(QApplication::applicationName()));
+            if (result != QMessageBox::Yes)
+            {
+                embed = true;
+            }
         }
 
-        if ( (embed && !d->image().isNull()) || !d->fileUrl().isValid())
+        // Data the image is decoded from is written as it is, released images aren't decoded for it
+        const QByteArray data = (embed || !d->fileUrl().isValid()) ? d->imageData() : QByteArray();
+
+        if ( (embed && (!data.isEmpty() || !d->image().isNull())) || !d->fileUrl().isValid())
         {
-            QByteArray byteArray;
-            QBuffer buffer(&byteArray);
-            d->image().save(&buffer, "PNG");
-            image.appendChild( document1.createTextNode( QString::fromUtf8(byteArray.toBase64()) ) );
-            image.setAttribute(QLatin1String("width"),QString::number(d->image().width()));
-            image.setAttribute(QLatin1String("height"),QString::number(d->image().height()));
+            image.appendChild( document1.createTextNode( data.isEmpty() ? PLESvgImageStore::svgImageData(d->image())
+                                                                        : QString::fromLatin1(data.toBase64()) ) );
+            image.setAttribute(QLatin1String("width"),QString::number(d->imageSize().width()));
+            image.setAttribute(QLatin1String("height"),QString::number(d->imageSize().height()));
         }
 
         // Saving image path
@@ -506,7 +673,7 @@ PhotoItem* PhotoItem::fromSvg(QDomElement& element)
         {
             // Fullsize image is embedded in SVG file!
 
-            img = QImage::fromData( QByteArray::fromBase64(imageAttribute.toLatin1()) );
+            img = PLESvgImageStore::svgImage(imageAttribute);
 
             if (img.isNull())
             {
@@ -554,7 +721,8 @@ QDomDocument PhotoItem::svgVisibleArea() const
 {
     QDomDocument document;
 
-    if (!isEmpty())
+    // Preview for other SVG viewers isn't needed to restore the item
+    if (!isEmpty() && !PLESvgImageStore::isInternalCopy())
     {
         // 'defs' -> 'g'
 
@@ -583,13 +751,11 @@ QDomDocument PhotoItem::svgVisibleArea() const
 
         // 'defs' -> 'g' -> 'image'
 
-        QByteArray byteArray;
-        QBuffer buffer(&byteArray);
-        m_temp_image.save(&buffer, "PNG");
+        QImage image = effectiveImage(1.0);
         QDomElement img = document.createElement(QLatin1String("image"));
-        img.setAttribute(QLatin1String("width"),m_temp_image.width());
-        img.setAttribute(QLatin1String("height"),m_temp_image.height());
-        img.setAttribute(QLatin1String("xlink:href"), QLatin1String("data:image/png;base64,") + QString::fromUtf8(byteArray.toBase64()));
+        img.setAttribute(QLatin1String("width"),image.width());
+        img.setAttribute(QLatin1String("height"),image.height());
+        img.setAttribute(QLatin1String("xlink:href"), QLatin1String("data:image/png;base64,") + PLESvgImageStore::svgImageData(image));
         g.appendChild(img);
     }
 
@@ -756,6 +922,7 @@ void PhotoItem::mouseMoveEvent(QGraphicsSceneMouseEvent* event)
             d->m_brush_transform.translate(p.x(), p.y());
             d->m_complete_path_transform.translate(p.x(), p.y());
             m_complete_path.translate(p);
+            d->m_fill_revision = -1;
             PhotoItemImageMovedCommand::instance(this)->translate(p);
             update();
         }
@@ -787,12 +954,12 @@ void PhotoItem::mouseReleaseEvent(QGraphicsSceneMouseEvent* event)
 
 QImage& PhotoItem::image()
 {
-    return d->m_image;
+    return d->image();
 }
 
 const QImage& PhotoItem::image() const
 {
-    return d->m_image;
+    return d->image();
 }
 
 void PhotoItem::setImage(const QImage& image)
@@ -802,30 +969,54 @@ void PhotoItem::setImage(const QImage& image)
     if (image.isNull())
         return;
 
-    PLEWindow::instance()->beginUndoCommandGroup(QObject::tr("Image Change"));
+    PLE_BeginUndoCommandGroup(QObject::tr("Image Change"));
     PLE_PostUndoCommand(new PhotoItemPixmapChangeCommand(image, this));
 
     if (cropShape().isEmpty())
         setCropShape( m_image_path );
 
     PLE_PostUndoCommand(new PhotoItemImagePathChangeCommand(this));
-    PLEWindow::instance()->endUndoCommandGroup();
+    PLE_EndUndoCommandGroup();
 }
 
-void PhotoItem::imageLoaded(const QUrl& url, const QImage& image)
+void PhotoItem::fillWithImage(const QImage& image, const QUrl& url)
 {
     if (image.isNull())
         return;
 
-    PLEWindow::instance()->beginUndoCommandGroup(QObject::tr("Image Change"));
+    PLE_BeginUndoCommandGroup(QObject::tr("Image Change"));
     PLE_PostUndoCommand(new PhotoItemPixmapChangeCommand(image, this));
 
+    if (cropShape().isEmpty())
+        setCropShape( m_image_path );
+
+    // Image is centered in the shape, other items keep their stored placement
+    PLE_PostUndoCommand(new PhotoItemImageCoverCommand(this));
+
+    if (url.isValid())
+        PLE_PostUndoCommand(new PhotoItemUrlChangeCommand(url, this));
+
+    PLE_EndUndoCommandGroup();
+}
+
+void PhotoItem::imageLoaded(const QUrl& url, const QImage& image)
+{
+    if (image.isNull())
+        return;
+
+    // Image is decoded from the whole file, so it can be released and decoded again
+    PhotoItemPixmapChangeCommand* const command = new PhotoItemPixmapChangeCommand(image, this);
+    command->setImageFromFile(true);
+
+    PLE_BeginUndoCommandGroup(QObject::tr("Image Change"));
+    PLE_PostUndoCommand(command);
+
     if (cropShape().isEmpty())
         setCropShape( m_image_path );
 
     PLE_PostUndoCommand(new PhotoItemImagePathChangeCommand(this));
     PLE_PostUndoCommand(new PhotoItemUrlChangeCommand(url, this));
-    PLEWindow::instance()->endUndoCommandGroup();
+    PLE_EndUndoCommandGroup();
 }
 
 void PhotoItem::setImageUrl(const QUrl& url)
@@ -836,22 +1027,34 @@ void PhotoItem::setImageUrl(const QUrl& url)
     ilt->start();
 }
 
+QUrl PhotoItem::imageUrl() const
+{
+    return d->m_file_path;
+}
+
 void PhotoItem::updateIcon()
 {
-    QPixmap temp(m_temp_image.size());
+    const int level   = availableLevel(d->m_icon_level);
+    const QImage icon = d->m_levels.value(level);
+    QPixmap temp(icon.size());
 
-    if (m_temp_image.isNull())
-        temp = QPixmap(48,48);
+    if (icon.isNull())
+        temp = QPixmap(ICON_SIZE, ICON_SIZE);
 
     temp.fill(Qt::transparent);
 
     QPainter p(&temp);
 
-    if (!m_temp_image.isNull())
+    if (!icon.isNull())
     {
-        p.fillPath(itemOpaqueArea(), QBrush(m_temp_image));
+        // Level is rendered with levelScale() pixels per item unit
+        const qreal scale = levelScale(level);
+        QBrush b(icon);
+        b.setTransform(QTransform::fromScale(1.0 / scale, 1.0 / scale));
+        p.scale(scale, scale);
+        p.fillPath(itemOpaqueArea(), b);
         p.end();
-        temp = temp.scaled(48,48,Qt::KeepAspectRatio);
+        temp = temp.scaled(ICON_SIZE, ICON_SIZE, Qt::KeepAspectRatio);
         p.begin(&temp);
     }
 
@@ -888,13 +1091,84 @@ void PhotoItem::fitToRect(const QRect& rect)
 
 void PhotoItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
 {
-    painter->fillPath(itemOpaqueArea(), EMPTY_FILL_COLOR);
+    updateFillPaths();
 
-    if (!m_temp_image.isNull())
+    if (d->m_image_fill_is_rect)
+        painter->fillRect(d->m_opaque_fill_rect, EMPTY_FILL_COLOR);
+    else
+        painter->fillPath(d->m_opaque_fill, EMPTY_FILL_COLOR);
+
+    if (!isEmpty())
     {
-        QBrush b(m_temp_image);
-        b.setTransform(d->m_brush_transform);
-        painter->fillPath(itemOpaqueArea() & m_complete_path, b);
+        if (widget)
+        {
+            // Views paint the level matching their zoom, the nearest rendered level is painted
+            // until the matching one is rendered in background
+            const qreal scale   = qSqrt(qAbs(painter->worldTransform().determinant())) * widget->devicePixelRatioF();
+            const int level     = levelFor(scale);
+            const int available = availableLevel(level);
+
+            // During zoom gesture rendered levels are painted as they are, the matching one is requested when it ends
+            const PLECanvas* const canvas = qobject_cast<PLECanvas*>(widget->parentWidget());
+            const bool zooming            = canvas && canvas->isZooming();
+
+            if (available != level && (!zooming || available < MIN_LEVEL))
+                requestLevel(level);
+
+            // Trilinear filtering blends the level with the coarser one by the distance of their resolutions
+            const int coarser = level - 1;
+
+            if (available < MIN_LEVEL)
+            {
+                // No level is rendered since the photo changed, the image from before the change is painted meanwhile
+                if (!d->m_stale_level.isNull())
+                {
+                    QBrush b(d->m_stale_level);
+                    b.setTransform(QTransform::fromScale(1.0 / d->m_stale_level_scale, 1.0 / d->m_stale_level_scale) *
+                                   d->m_brush_transform);
+                    fillImage(painter, b);
+                }
+            }
+            else if (available == level && level > MIN_LEVEL && levelScale(level) > scale && !zooming &&
+                     painter->testRenderHint(QPainter::SmoothPixmapTransform))
+            {
+                if (d->m_levels.contains(coarser))
+                {
+                    const qreal weight = qLn(scale / levelScale(coarser)) / qLn(levelScale(level) / levelScale(coarser));
+
+                    fillWithLevel(painter, coarser);
+                    painter->save();
+                    painter->setOpacity(painter->opacity() * qBound(0.0, weight, 1.0));
+                    fillWithLevel(painter, level);
+                    painter->restore();
+                }
+                else
+                {
+                    requestLevel(coarser);
+                    fillWithLevel(painter, level);
+                }
+            }
+            else
+            {
+                fillWithLevel(painter, available);
+            }
+        }
+        else
+        {
+            // Painting outside of views (e.g. by QGraphicsScene::render()) uses full resolution of the device,
+            // exporters render the photo in their threads from imageFill()
+            const PhotoItemFill fill = imageFill(qSqrt(qAbs(painter->worldTransform().determinant())));
+
+            if (d->m_device_image.isNull() || !qFuzzyCompare(fill.scale, d->m_device_image_scale))
+            {
+                d->m_device_image       = effectiveImage(fill.scale);
+                d->m_device_image_scale = fill.scale;
+            }
+
+            QBrush b(d->m_device_image);
+            b.setTransform(fill.brushTransform);
+            fillImage(painter, b);
+        }
     }
 
     AbstractPhoto::paint(painter, option, widget);
@@ -909,15 +1183,16 @@ void PhotoItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option,
 
 void PhotoItem::refreshItem()
 {
-    if (d->image().isNull())
+    if (isEmpty())
         return;
 
-    m_temp_image = effectsGroup()->apply( d->image().scaled(m_image_path.boundingRect().size().toSize(),
-                                                            Qt::KeepAspectRatioByExpanding,
-                                                            Qt::SmoothTransformation));
-
-    updateIcon();
     recalcShape();
+
+    // Icon is updated when its level is rendered
+    const QSizeF size = m_image_path.boundingRect().size();
+    d->m_icon_level   = levelFor(ICON_SIZE / qMax(1.0, qMax(size.width(), size.height())));
+    requestLevel(d->m_icon_level);
+
     update();
 }
 
@@ -928,7 +1203,7 @@ QtAbstractPropertyBrowser* PhotoItem::propertyBrowser()
 
 bool PhotoItem::isEmpty() const
 {
-    return d->m_image.isNull();
+    return (d->m_image.isNull() && !d->m_image_released);
 }
 
 void PhotoItem::setupItem(const QImage& image)
@@ -952,10 +1227,365 @@ void PhotoItem::setupItem(const QImage& image)
     setFlag(QGraphicsItem::ItemIsSelectable);
 }
 
+PhotoItemFill PhotoItem::imageFill(qreal scale) const
+{
+    PhotoItemFill result;
+
+    if (d->image().isNull())
+        return result;
+
+    result.scale          = qMin(scale, qMax(1.0, nativeScale()));
+    result.source         = d->image();
+    result.size           = (m_image_path.boundingRect().size() * result.scale).toSize().expandedTo(QSize(1, 1));
+    result.brushTransform = QTransform::fromScale(1.0 / result.scale, 1.0 / result.scale) * d->m_brush_transform;
+    result.area           = itemOpaqueArea() & m_complete_path;
+
+    if (effectsGroup())
+        result.effects = effectsGroup()->chain();
+
+    return result;
+}
+
+QImage PhotoItem::effectiveImage(qreal scale) const
+{
+    if (d->image().isNull())
+        return QImage();
+
+    QSize size = (m_image_path.boundingRect().size() * scale).toSize();
+
+    return effectsGroup()->apply( d->image().scaled(size,
+                                                    Qt::KeepAspectRatioByExpanding,
+                                                    Qt::SmoothTransformation),
+                                  scale );
+}
+
+qreal PhotoItem::viewScale() const
+{
+    qreal result = 0;
+
+    if (!scene())
+        return result;
+
+    foreach (QGraphicsView* const view, scene()->views())
+    {
+        QTransform transform = deviceTransform(view->viewportTransform());
+        result               = qMax(result, qSqrt(qAbs(transform.determinant())) * view->devicePixelRatioF());
+    }
+
+    return result;
+}
+
+qreal PhotoItem::nativeScale() const
+{
+    const QSizeF size = m_image_path.boundingRect().size();
+    const QSize source = d->imageSize();
+
+    if (source.isEmpty() || size.isEmpty())
+        return 1.0;
+
+    return qMin(source.width() / size.width(), source.height() / size.height());
+}
+
+bool PhotoItem::isNearViews() const
+{
+    if (!scene())
+        return false;
+
+    const QRectF bounds = sceneBoundingRect();
+
+    foreach (QGraphicsView* const view, scene()->views())
+    {
+        QRectF area = view->mapToScene(view->viewport()->rect()).boundingRect();
+        area.adjust(-area.width()  * VIEW_MARGIN, -area.height() * VIEW_MARGIN,
+                     area.width()  * VIEW_MARGIN,  area.height() * VIEW_MARGIN);
+
+        if (area.intersects(bounds))
+            return true;
+    }
+
+    return false;
+}
+
+bool PhotoItem::releaseImage()
+{
+    if (d->m_image_released || d->m_image.isNull() || !d->hasImageRecord())
+        return false;
+
+    // Encoded file is kept, so the image doesn't depend on the file anymore
+    const QByteArray data = d->imageData();
+
+    if (data.isEmpty())
+        return false;
+
+    d->m_image_data     = data;
+    d->m_released_size  = d->m_image.size();
+    d->m_image          = QImage();
+    d->m_image_released = true;
+    d->m_device_image   = QImage();
+
+    // Coarsest level is painted until the image is decoded again
+    const QImage coarsest = d->m_levels.isEmpty() ? QImage() : d->m_levels.first();
+    const qreal scale     = d->m_levels.isEmpty() ? 1.0 : levelScale(d->m_levels.firstKey());
+
+    clearLevels();
+    d->m_stale_level       = coarsest;
+    d->m_stale_level_scale = scale;
+
+    return true;
+}
+
+void PhotoItem::restoreImage()
+{
+    if (!d->m_image_released || d->m_image_restoring)
+        return;
+
+    QFutureWatcher<QImage>* const watcher = new QFutureWatcher<QImage>(this);
+    connect(watcher, SIGNAL(finished()), this, SLOT(imageRestored()));
+    d->m_image_restoring = watcher;
+    watcher->setFuture(QtConcurrent::run(PhotoItemPrivate::decodeImage, d->m_image_data));
+}
+
+void PhotoItem::imageRestored()
+{
+    // Image was released again or it was restored before the watcher notified it
+    QFutureWatcher<QImage>* const watcher = d->m_image_restoring;
+
+    if (!watcher || !watcher->isFinished() || !d->m_image_released)
+        return;
+
+    d->m_image_restoring = nullptr;
+    d->m_image           = watcher->result();
+    d->m_image_released  = false;
+    watcher->deleteLater();
+
+    if (d->m_image.isNull())
+        return;
+
+    // Shape and placement of the image are kept, only the previews are rendered again. Photos far
+    // from the views release the image when the icon is rendered.
+    requestLevel(d->m_icon_level);
+    updateLevelOfDetail();
+}
+
+void PhotoItem::updateLevelOfDetail()
+{
+    if (isEmpty() || !scene())
+        return;
+
+    // Photos far from the visible area keep only the record of their image, pending levels are rendered first
+    if (!isNearViews())
+    {
+        if (d->m_pending_levels.isEmpty() && releaseImage())
+            update();
+
+        return;
+    }
+
+    // Level matching the new zoom is rendered in background, views paint the nearest one meanwhile
+    requestLevel(levelFor(viewScale()));
+    update();
+}
+
+int PhotoItem::maxLevel() const
+{
+    const qreal native = nativeScale();
+    int level          = MIN_LEVEL;
+
+    while (qPow(2.0, level) < native)
+        ++level;
+
+    return level;
+}
+
+int PhotoItem::levelFor(qreal scale) const
+{
+    const int max = maxLevel();
+    int level     = MIN_LEVEL;
+
+    while (level < max && levelScale(level) < scale)
+        ++level;
+
+    return level;
+}
+
+qreal PhotoItem::levelScale(int level) const
+{
+    return qMin(qPow(2.0, level), nativeScale());
+}
+
+int PhotoItem::availableLevel(int level) const
+{
+    if (d->m_levels.contains(level))
+        return level;
+
+    // Finer level looks better than coarser one
+    QMap<int, QImage>::const_iterator it = d->m_levels.upperBound(level);
+
+    if (it != d->m_levels.constEnd())
+        return it.key();
+
+    it = d->m_levels.lowerBound(level);
+
+    if (it != d->m_levels.constBegin())
+        return (--it).key();
+
+    return MIN_LEVEL - 1;
+}
+
+void PhotoItem::requestLevel(int level)
+{
+    // Level is requested again when the released image is decoded
+    if (d->m_image_released)
+    {
+        restoreImage();
+        return;
+    }
+
+    if (d->m_image.isNull() || d->m_levels.contains(level) || d->m_pending_levels.values().contains(level))
+        return;
+
+    QMap<int, QImage>::const_iterator finer = d->m_raw_levels.upperBound(level);
+    const QImage source                     = (finer != d->m_raw_levels.constEnd()) ? finer.value() : d->image();
+    const QSize size                        = (m_image_path.boundingRect().size() * levelScale(level)).toSize().expandedTo(QSize(1, 1));
+    const PhotoEffectsChain effects         = effectsGroup() ? effectsGroup()->chain() : PhotoEffectsChain();
+
+    QFutureWatcher<PhotoItemLevel>* const watcher = new QFutureWatcher<PhotoItemLevel>(this);
+    connect(watcher, SIGNAL(finished()), this, SLOT(levelRendered()));
+    d->m_pending_levels.insert(watcher, level);
+    watcher->setFuture(QtConcurrent::run(renderLevel, source, size, effects, levelScale(level)));
+}
+
+void PhotoItem::levelRendered()
+{
+    QFutureWatcher<PhotoItemLevel>* const watcher = static_cast<QFutureWatcher<PhotoItemLevel>*>(sender());
+    watcher->deleteLater();
+
+    // Levels were dropped while it was rendered
+    if (!d->m_pending_levels.contains(watcher))
+        return;
+
+    const int level = d->m_pending_levels.take(watcher);
+
+    storeLevel(level, watcher->result());
+    update();
+
+    // Image was decoded for the icon or a render outside of the views
+    if (d->m_pending_levels.isEmpty() && !isNearViews())
+        releaseImage();
+}
+
+void PhotoItem::storeLevel(int level, const PhotoItemLevel& rendered)
+{
+    d->m_raw_levels.insert(level, rendered.raw);
+    d->m_levels.insert(level, rendered.image);
+    d->m_stale_level = QImage();
+
+    if (level == d->m_icon_level)
+        updateIcon();
+
+    // Coarser levels together take a third of the view level, the nearest finer one is kept only
+    // until the view level is rendered. Raw levels are only sources of the next renders, so just
+    // the ones around the view level are kept.
+    const int view                          = levelFor(viewScale());
+    QMap<int, QImage>::const_iterator finer = d->m_levels.lowerBound(view);
+    const int keep                          = (finer != d->m_levels.constEnd()) ? finer.key() : view;
+
+    foreach (int key, d->m_levels.keys())
+    {
+        if (key > keep)
+            d->m_levels.remove(key);
+    }
+
+    foreach (int key, d->m_raw_levels.keys())
+    {
+        if (key > keep || key < view - 1)
+            d->m_raw_levels.remove(key);
+    }
+}
+
+void PhotoItem::clearLevels()
+{
+    // Views paint the finest level until the first new one is rendered
+    if (!d->m_levels.isEmpty())
+    {
+        d->m_stale_level       = d->m_levels.last();
+        d->m_stale_level_scale = levelScale(d->m_levels.lastKey());
+    }
+
+    // Pending renders are discarded when they finish
+    d->m_raw_levels.clear();
+    d->m_levels.clear();
+    d->m_pending_levels.clear();
+}
+
+void PhotoItem::fillWithLevel(QPainter* painter, int level)
+{
+    const qreal scale = levelScale(level);
+
+    QBrush b(d->m_levels.value(level));
+    b.setTransform(QTransform::fromScale(1.0 / scale, 1.0 / scale) * d->m_brush_transform);
+    fillImage(painter, b);
+}
+
+void PhotoItem::updateFillPaths()
+{
+    if (d->m_fill_revision == geometryRevision())
+        return;
+
+    QRectF imageRect;
+    QRectF completeRect;
+    QRectF cropRect;
+    const QPainterPath crop = cropShape();
+
+    d->m_image_fill_is_rect = pathIsRect(m_image_path, &imageRect)       &&
+                              pathIsRect(m_complete_path, &completeRect) &&
+                              (crop.isEmpty() || pathIsRect(crop, &cropRect));
+
+    if (d->m_image_fill_is_rect)
+    {
+        d->m_opaque_fill_rect = crop.isEmpty() ? imageRect : (imageRect & cropRect);
+        d->m_image_fill_rect  = d->m_opaque_fill_rect & completeRect;
+        d->m_opaque_fill      = QPainterPath();
+        d->m_image_fill       = QPainterPath();
+    }
+    else
+    {
+        d->m_opaque_fill      = itemOpaqueArea();
+        d->m_image_fill       = d->m_opaque_fill & m_complete_path;
+    }
+
+    d->m_fill_revision = geometryRevision();
+}
+
+void PhotoItem::fillImage(QPainter* painter, const QBrush& brush)
+{
+    if (d->m_image_fill_is_rect)
+        painter->fillRect(d->m_image_fill_rect, brush);
+    else
+        painter->fillPath(d->m_image_fill, brush);
+}
+
 void PhotoItem::recalcShape()
 {
-    m_complete_path = m_image_path;
+    m_complete_path      = m_image_path;
     d->m_brush_transform = QTransform();
+    d->m_device_image    = QImage();
+    clearLevels();
+    invalidateGeometry();
+}
+
+QTransform PhotoItem::coverTransform() const
+{
+    const QRectF area = m_image_path.boundingRect();
+
+    if (d->imageSize().isEmpty() || area.isEmpty())
+        return QTransform();
+
+    // effectiveImage() scales the image to cover bounding rect of the shape
+    const QSizeF size = QSizeF(d->imageSize()).scaled(area.size(), Qt::KeepAspectRatioByExpanding);
+
+    return QTransform::fromTranslate(area.x() + (area.width()  - size.width())  / 2,
+                                     area.y() + (area.height() - size.height()) / 2);
 }
 
 bool PhotoItem::highlightItem()
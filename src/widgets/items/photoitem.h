@@ -28,10 +28,15 @@
 // Qt includes
 
 #include <QUrl>
+#include <QDateTime>
+#include <QMap>
+#include <QHash>
+#include <QFutureWatcher>
 
 // Local includes
 
 #include "abstractphoto.h"
+#include "photoeffectsgroup.h"
 
 namespace PhotoLayoutsEditor
 {
@@ -41,6 +46,41 @@ class PhotoItemUrlChangeCommand;
 class PhotoItemImagePathChangeCommand;
 class PhotoItemImageMovedCommand;
 class PhotoItemLoader;
+class PLEPdfExporter;
+
+/** Image fill of a photo item which can be rendered in any thread, see PhotoItem::imageFill().
+ * Source image is scaled to cover the size and effects are applied with scale pixels per item unit,
+ * the result is painted into the area with the brush transform.
+ */
+struct PhotoItemFill
+{
+    PhotoItemFill()
+        : scale(1.0)
+    {
+    }
+
+    bool isNull() const;
+
+    /// Size of the rendered image
+    QSize imageSize() const;
+
+    /// Scales the source and applies the effects
+    QImage render() const;
+
+    QImage              source;
+    QSize               size;
+    qreal               scale;
+    PhotoEffectsChain   effects;
+    QTransform          brushTransform;
+    QPainterPath        area;
+};
+
+/// Level of the previews pyramid rendered in a worker thread, image is the raw one with applied effects
+struct PhotoItemLevel
+{
+    QImage raw;
+    QImage image;
+};
 
 class PhotoItem : public AbstractPhoto
 {
@@ -67,8 +107,12 @@ public:
     const QImage& image() const;
     void setImage(const QImage& image);
 
+    /// Sets image keeping item's shape, image covers the shape and is centered in it
+    void fillWithImage(const QImage& image, const QUrl& url = QUrl());
+
     /// Pixmap and pixmap's url
     void setImageUrl(const QUrl& url);
+    QUrl imageUrl() const;
 
     /// Scales image to fit scenes rect
     void fitToRect(const QRect& rect);
@@ -109,6 +153,16 @@ public:
     /// Returns if item is empty (not contains image)
     bool isEmpty() const;
 
+    /** Re-renders item preview if the zoom of scenes views changed its level of detail. Image of the photo
+     * is released when the photo is far from the visible area of the views, see PhotoItemPrivate::m_image_data.
+     */
+    void updateLevelOfDetail();
+
+    /** Returns image fill for painting with \a scale device pixels per item unit, limited to the resolution
+     * of the photo. Exporters render it in their threads instead of painting the item on the GUI thread.
+     */
+    PhotoItemFill imageFill(qreal scale) const;
+
 protected:
 
     explicit PhotoItem(const QString& name = QString(), PLEScene* scene = nullptr);
@@ -136,6 +190,8 @@ protected:
 private Q_SLOTS:
 
     void imageLoaded(const QUrl& url, const QImage& image);
+    void levelRendered();
+    void imageRestored();
 
 private:
 
@@ -148,6 +204,40 @@ private:
     // Recalculates item shape
     void recalcShape();
 
+    // Returns brush transform centering the image scaled to cover item's shape
+    QTransform coverTransform() const;
+
+    // Returns the highest device pixels per scene unit of scene's views
+    qreal viewScale() const;
+
+    // Returns resolution (pixels per scene unit) of the photo in its full size
+    qreal nativeScale() const;
+
+    // Returns if the photo is in the visible area of any view or near it
+    bool isNearViews() const;
+
+    // Releases decoded image which can be decoded again from its record, the image is decoded in background
+    // when it's painted again or synchronously when it's needed before
+    bool releaseImage();
+    void restoreImage();
+
+    // Mip pyramid of previews, see PhotoItemPrivate::m_levels
+    int maxLevel() const;
+    int levelFor(qreal scale) const;
+    qreal levelScale(int level) const;
+    int availableLevel(int level) const;
+    void requestLevel(int level);
+    void storeLevel(int level, const PhotoItemLevel& rendered);
+    void clearLevels();
+    void fillWithLevel(QPainter* painter, int level);
+
+    // Fills clipped image area with the brush, see PhotoItemPrivate::m_image_fill
+    void updateFillPaths();
+    void fillImage(QPainter* painter, const QBrush& brush);
+
+    // Returns image with applied effects rendered with given pixels per scene unit
+    QImage effectiveImage(qreal scale) const;
+
     // Highlight item
     Q_PROPERTY(bool m_highlight READ highlightItem WRITE setHighlightItem)
     bool highlightItem();
@@ -158,7 +248,15 @@ private:
     {
         explicit PhotoItemPrivate(PhotoItem* item)
             : m_item(item),
-              m_image_moving(false)
+              m_image_from_file(false),
+              m_image_released(false),
+              m_image_restoring(nullptr),
+              m_image_moving(false),
+              m_device_image_scale(0),
+              m_stale_level_scale(1.0),
+              m_icon_level(0),
+              m_image_fill_is_rect(false),
+              m_fill_revision(-1)
         {
         }
 
@@ -171,27 +269,70 @@ private:
         inline QImage& image();
         QImage m_image;
 
-        // Pixmap's url
+        // Record the image is decoded from again after it was released, the encoded data it was loaded from
+        // or the data of the file of m_file_path, which is read when the image is released if the file is unchanged.
+        // Images of photos far from the views are released, so canvas memory depends on the visible photos only.
+        // Record is swapped with the image by undo commands.
+        static QImage decodeImage(const QByteArray& data);
+        bool hasImageRecord() const;
+        QByteArray imageData() const;
+        QSize imageSize() const;
+        QByteArray m_image_data;
+        bool m_image_from_file;
+        bool m_image_released;
+        QSize m_released_size;
+        QFutureWatcher<QImage>* m_image_restoring;
+
+        // Pixmap's url and modification time of the file when it was set
         void setFileUrl(const QUrl& url);
         inline QUrl& fileUrl();
         QUrl m_file_path;
+        QDateTime m_file_modified;
 
         QTransform m_brush_transform;
         QTransform m_complete_path_transform;
         bool m_image_moving;
 
+        // Image rendered for the last painting outside of views, kept until the photo changes
+        QImage m_device_image;
+        qreal m_device_image_scale;
+
+        // Mip pyramid painted in views, level n has 2^n pixels per scene unit up to the native resolution
+        // of the photo. Levels are rendered on demand in worker threads, scaled from the nearest finer raw
+        // level and with applied effects, and they are dropped when the photo, its effects or its shape change.
+        // Only levels near the zoom of the views are kept, see PhotoItem::storeLevel().
+        QMap<int, QImage> m_raw_levels;
+        QMap<int, QImage> m_levels;
+        QHash<QFutureWatcher<PhotoItemLevel>*, int> m_pending_levels;
+
+        // Finest level from before the levels were dropped, painted until a new level is rendered
+        QImage m_stale_level;
+        qreal m_stale_level_scale;
+
+        // Level the item icon is painted from, it's updated when the level is rendered
+        int m_icon_level;
+
+        // Areas filled by paint(), computed once per geometry revision and when the image is moved.
+        // Image of a photo which isn't cropped or is cropped to a rectangle is filled as a rectangle.
+        QPainterPath m_opaque_fill;
+        QPainterPath m_image_fill;
+        QRectF m_opaque_fill_rect;
+        QRectF m_image_fill_rect;
+        bool m_image_fill_is_rect;
+        int m_fill_revision;
+
         friend class PhotoItem;
         friend class PhotoItemLoader;
         friend class PhotoItemPixmapChangeCommand;
         friend class PhotoItemUrlChangeCommand;
         friend class PhotoItemImageMovedCommand;
+        friend class PhotoItemImageCoverCommand;
+        friend class PLEPdfExporter;
     };
 
     PhotoItemPrivate* d;
     friend class PhotoItemPrivate;
 
-    QImage m_temp_image;
-
     // Widget path
     QPainterPath m_complete_path;
     QPainterPath m_image_path;
@@ -201,7 +342,9 @@ private:
     friend class PhotoItemUrlChangeCommand;
     friend class PhotoItemImagePathChangeCommand;
     friend class PhotoItemImageMovedCommand;
+    friend class PhotoItemImageCoverCommand;
     friend class PhotoItemLoader;
+    friend class PLEPdfExporter;
 };
 
 } // namespace PhotoLayoutsEditor
@@ -695,13 +695,20 @@ void TextItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option,
 {
     if (!m_text_path.isEmpty())
     {
+        updateFillPath();
+
         painter->save();
         painter->setRenderHint(QPainter::Antialiasing);
 
-        if (this->cropShape().isEmpty())
+        if (d->m_fill_is_clipped)
+        {
+            painter->setClipRect(d->m_fill_clip, Qt::IntersectClip);
             painter->fillPath(m_text_path, m_color);
+        }
         else
-            painter->fillPath(m_text_path & this->cropShape(), m_color);
+        {
+            painter->fillPath(d->m_fill_path, m_color);
+        }
 
         painter->restore();
     }
@@ -728,6 +735,23 @@ void TextItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option,
     AbstractPhoto::paint(painter, option, widget);
 }
 
+void TextItem::updateFillPath()
+{
+    if (d->m_fill_revision == geometryRevision())
+        return;
+
+    const QPainterPath crop = this->cropShape();
+
+    d->m_fill_is_clipped = !crop.isEmpty() && pathIsRect(crop, &d->m_fill_clip);
+
+    if (crop.isEmpty() || d->m_fill_is_clipped)
+        d->m_fill_path = m_text_path;
+    else
+        d->m_fill_path = m_text_path & crop;
+
+    d->m_fill_revision = geometryRevision();
+}
+
 QDomDocument TextItem::toSvg() const
 {
     QDomDocument document = AbstractPhoto::toSvg();
@@ -918,7 +942,7 @@ void TextItem::refreshItem()
                             0,
                             maxWidth + maxBearing,
                             d->m_string_list.count() * m_metrics.lineSpacing());
-    this->prepareGeometryChange();
+    this->invalidateGeometry();
     this->updateIcon();
 }
 
@@ -95,6 +95,7 @@ private:
     QPainterPath getLinePath(const QString& string);
     void setCursorPositionVisible(bool isVisible);
     void updateIcon();
+    void updateFillPath();
 
     class TextItemPrivate
     {
@@ -103,7 +104,9 @@ private:
               m_cursorIsVisible(false),
               m_cursor_row(0),
               m_cursor_character(0),
-              m_command(nullptr)
+              m_command(nullptr),
+              m_fill_is_clipped(false),
+              m_fill_revision(-1)
         {
         }
 
@@ -132,6 +135,13 @@ private:
 
         QUndoCommand* m_command;
 
+        // Text path clipped by the crop shape, computed once per geometry revision.
+        // Text cropped to a rectangle is painted with a clip rect instead.
+        QPainterPath m_fill_path;
+        QRectF m_fill_clip;
+        bool m_fill_is_clipped;
+        int m_fill_revision;
+
         friend class TextItem;
         friend class TextItemLoader;
         friend class TextChangeUndoCommand;
@@ -0,0 +1,151 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "plepageslist.h"
+
+// Qt includes
+
+#include <QIcon>
+#include <QPixmap>
+
+// Local includes
+
+#include "plephotobook.h"
+
+#define THUMBNAIL_SIZE 96
+
+namespace PhotoLayoutsEditor
+{
+
+PLEPagesList::PLEPagesList(QWidget* const parent)
+    : QListWidget(parent)
+{
+    setViewMode(QListView::IconMode);
+    setFlow(QListView::TopToBottom);
+    setWrapping(false);
+    setMovement(QListView::Static);
+    setResizeMode(QListView::Adjust);
+    setIconSize(QSize(THUMBNAIL_SIZE, THUMBNAIL_SIZE));
+    setSelectionMode(QAbstractItemView::SingleSelection);
+
+    m_timer = new QTimer(this);
+    m_timer->setSingleShot(true);
+    m_timer->setInterval(500);
+
+    connect(m_timer, SIGNAL(timeout()),
+            this, SLOT(updateThumbnails()));
+
+    connect(this, SIGNAL(currentRowChanged(int)),
+            this, SLOT(selectPage(int)));
+}
+
+void PLEPagesList::setPhotobook(PLEPhotobook* const photobook)
+{
+    if (m_photobook)
+        m_photobook->disconnect(this);
+
+    m_photobook = photobook;
+    m_timer->stop();
+
+    blockSignals(true);
+    clear();
+    blockSignals(false);
+
+    if (!m_photobook)
+        return;
+
+    for (int i = 0 ; i < m_photobook->count() ; ++i)
+        pageInserted(i);
+
+    currentPageChanged(m_photobook->currentPage());
+
+    connect(m_photobook, SIGNAL(pageInserted(int)),
+            this, SLOT(pageInserted(int)));
+
+    connect(m_photobook, SIGNAL(pageRemoved(int)),
+            this, SLOT(pageRemoved(int)));
+
+    connect(m_photobook, SIGNAL(currentPageChanged(int)),
+            this, SLOT(currentPageChanged(int)));
+
+    connect(m_photobook, SIGNAL(thumbnailChanged(int)),
+            m_timer, SLOT(start()));
+}
+
+void PLEPagesList::pageInserted(int index)
+{
+    blockSignals(true);
+    insertItem(index, new QListWidgetItem());
+    blockSignals(false);
+
+    updateNames();
+    m_timer->start();
+}
+
+void PLEPagesList::pageRemoved(int index)
+{
+    blockSignals(true);
+    delete takeItem(index);
+    blockSignals(false);
+
+    updateNames();
+}
+
+void PLEPagesList::currentPageChanged(int index)
+{
+    blockSignals(true);
+    setCurrentRow(index);
+    blockSignals(false);
+}
+
+void PLEPagesList::selectPage(int row)
+{
+    if (m_photobook)
+        m_photobook->setCurrentPage(row);
+}
+
+void PLEPagesList::updateThumbnails()
+{
+    if (!m_photobook)
+        return;
+
+    // Thumbnails of unloaded pages and of unchanged ones are cached by the photobook
+    for (int i = 0 ; i < count() && i < m_photobook->count() ; ++i)
+    {
+        const QImage thumbnail = m_photobook->thumbnail(i);
+
+        if (!thumbnail.isNull())
+            item(i)->setIcon(QIcon(QPixmap::fromImage(thumbnail)));
+    }
+}
+
+void PLEPagesList::updateNames()
+{
+    for (int i = 0 ; i < count() ; ++i)
+        item(i)->setText(QObject::tr("Page %1").arg(i + 1));
+}
+
+} // namespace PhotoLayoutsEditor
+
+#undef THUMBNAIL_SIZE
@@ -0,0 +1,72 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2011-09-01
+ * Description : a plugin to create photo layouts by fusion of several images.
+ *
+ * Copyright (C) 2011      by Lukasz Spas <lukasz dot spas at gmail dot com>
+ * Copyright (C) 2011-2020 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef PLE_PAGES_LIST_H
+#define PLE_PAGES_LIST_H
+
+// Qt includes
+
+#include <QListWidget>
+#include <QPointer>
+#include <QTimer>
+
+namespace PhotoLayoutsEditor
+{
+
+class PLEPhotobook;
+
+/** List of the photobook pages with their thumbnails, selecting a page makes it current.
+ * Thumbnails are updated with a delay, so they aren't rendered while the page is being edited.
+ */
+class PLEPagesList : public QListWidget
+{
+    Q_OBJECT
+
+public:
+
+    explicit PLEPagesList(QWidget* const parent = nullptr);
+
+    void setPhotobook(PLEPhotobook* const photobook);
+
+private Q_SLOTS:
+
+    void pageInserted(int index);
+    void pageRemoved(int index);
+    void currentPageChanged(int index);
+    void selectPage(int row);
+    void updateThumbnails();
+
+private:
+
+    void updateNames();
+
+private:
+
+    QPointer<PLEPhotobook> m_photobook;
+    QTimer*                m_timer;
+};
+
+} // namespace PhotoLayoutsEditor
+
+#endif // PLE_PAGES_LIST_H
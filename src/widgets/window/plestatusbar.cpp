@@ -28,6 +28,13 @@
 
 #include <QDebug>
 #include <QLabel>
+#include <QHBoxLayout>
+#include <QToolButton>
+#include <QIcon>
+
+// Local includes
+
+#include "progressevent.h"
 
 namespace PhotoLayoutsEditor
 {
@@ -53,4 +60,79 @@ void PLEStatusBar::stopBusyIndicator()
     m_pb->hide();
 }
 
+void PLEStatusBar::progressEvent(ProgressEvent* event)
+{
+    QObject* const job      = event->sender();
+    QWidget* widget         = m_jobs.value(job);
+    QProgressBar* const bar = (widget ? widget->findChild<QProgressBar*>() : nullptr);
+
+    switch (event->type())
+    {
+        case ProgressEvent::Init:
+        {
+            if (widget)
+                break;
+
+            widget = new QWidget(this);
+            QHBoxLayout* const layout = new QHBoxLayout(widget);
+            layout->setContentsMargins(QMargins());
+            layout->setSpacing(2);
+
+            QProgressBar* const progress = new QProgressBar(widget);
+            progress->setMaximum(1000);
+            progress->setValue(0);
+            layout->addWidget(progress);
+
+            // Only jobs which can be stopped get the cancel button
+            if (job->metaObject()->indexOfSlot("cancel()") >= 0)
+            {
+                QToolButton* const cancel = new QToolButton(widget);
+                cancel->setIcon(QIcon::fromTheme(QLatin1String("dialog-cancel")));
+                cancel->setToolTip(QObject::tr("Cancel"));
+                cancel->setAutoRaise(true);
+                layout->addWidget(cancel);
+
+                connect(cancel, SIGNAL(clicked()), job, SLOT(cancel()));
+            }
+
+            addPermanentWidget(widget);
+            m_jobs.insert(job, widget);
+            break;
+        }
+
+        case ProgressEvent::ProgressUpdate:
+
+            if (bar)
+                bar->setValue((int)(event->data().toDouble() * 1000.));
+
+            break;
+
+        case ProgressEvent::ActionUpdate:
+
+            if (bar)
+                bar->setFormat(event->data().toString() + QLatin1String(" [%p%]"));
+
+            break;
+
+        case ProgressEvent::Finish:
+
+            if (widget)
+            {
+                removeWidget(widget);
+                m_jobs.take(job)->deleteLater();
+            }
+
+            break;
+
+        default:
+
+            break;
+    }
+}
+
+bool PLEStatusBar::hasJob(QObject* const job) const
+{
+    return m_jobs.contains(job);
+}
+
 } // namespace PhotoLayoutsEditor
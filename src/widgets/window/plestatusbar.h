@@ -27,12 +27,15 @@
 
 // Qt includes
 
+#include <QMap>
 #include <QProgressBar>
 #include <QStatusBar>
 
 namespace PhotoLayoutsEditor
 {
 
+class ProgressEvent;
+
 class PLEStatusBar : public QStatusBar
 {
     public:
@@ -41,9 +44,16 @@ class PLEStatusBar : public QStatusBar
         void runBusyIndicator();
         void stopBusyIndicator();
 
+        /// Shows progress of a background job, job is canceled with its cancel() slot
+        void progressEvent(ProgressEvent* event);
+
+        /// Returns true if progress of the job is shown
+        bool hasJob(QObject* const job) const;
+
     private:
 
-        QProgressBar* m_pb;
+        QProgressBar*            m_pb;
+        QMap<QObject*, QWidget*> m_jobs;
 };
 
 } // namespace PhotoLayoutsEditor
@@ -82,6 +82,9 @@ PLEWindow::~PLEWindow()
     config.setValue(QLatin1String("size"), size());
     config.endGroup();
 
+    // Waits for the running export, its progress events are posted to the window
+    delete d->exportQueue;
+
     if (d->canvas)
     {
         d->canvas->deleteLater();
@@ -109,6 +112,11 @@ PLEWindow* PLEWindow::instance(DPluginGeneric* const plugin)
     }
 }
 
+bool PLEWindow::hasInstance()
+{
+    return (m_instance != nullptr);
+}
+
 void PLEWindow::addUndoCommand(QUndoCommand* const command)
 {
     if (command)
@@ -117,7 +125,7 @@ void PLEWindow::addUndoCommand(QUndoCommand* const command)
 
         if (d->canvas)
         {
-            d->canvas->undoStack()->push(command);
+            d->canvas->photobook()->push(command);
         }
         else
         {
@@ -193,6 +201,11 @@ void PLEWindow::setupActions()
 
     //------------------------------------------------------------------------
 
+    connect(d->ui->exportPagesAction, SIGNAL(triggered()),
+            this, SLOT(exportPages()));
+
+    //------------------------------------------------------------------------
+
     connect(d->ui->printPreviewAction, SIGNAL(triggered()),
             this, SLOT(printPreview()));
 
@@ -243,6 +256,26 @@ void PLEWindow::setupActions()
 
     //------------------------------------------------------------------------
 
+    connect(d->ui->addPageAction, SIGNAL(triggered()),
+            this, SLOT(addPage()));
+
+    //------------------------------------------------------------------------
+
+    connect(d->ui->removePageAction, SIGNAL(triggered()),
+            this, SLOT(removePage()));
+
+    //------------------------------------------------------------------------
+
+    connect(d->ui->previousPageAction, SIGNAL(triggered()),
+            this, SLOT(previousPage()));
+
+    //------------------------------------------------------------------------
+
+    connect(d->ui->nextPageAction, SIGNAL(triggered()),
+            this, SLOT(nextPage()));
+
+    //------------------------------------------------------------------------
+
     connect(d->ui->aboutAction, SIGNAL(triggered()),
             this, SLOT(slotAbout()));
 }
@@ -250,10 +283,14 @@ void PLEWindow::setupActions()
 void PLEWindow::refreshActions()
 {
     bool isEnabledForPLECanvas = false;
+    int pagesCount             = 0;
+    int currentPage            = -1;
 
     if (d->canvas)
     {
         isEnabledForPLECanvas = true;
+        pagesCount            = d->canvas->photobook()->count();
+        currentPage           = d->canvas->photobook()->currentPage();
         d->ui->undoAction->setEnabled(d->canvas->undoStack()->canUndo());
         d->ui->redoAction->setEnabled(d->canvas->undoStack()->canRedo());
         d->ui->saveAction->setEnabled(isEnabledForPLECanvas && !d->canvas->isSaved());
@@ -262,6 +299,7 @@ void PLEWindow::refreshActions()
     d->ui->saveAsAction->setEnabled(isEnabledForPLECanvas);
     d->ui->saveAsTemplateAction->setEnabled(isEnabledForPLECanvas);
     d->ui->exportFileAction->setEnabled(isEnabledForPLECanvas);
+    d->ui->exportPagesAction->setEnabled(isEnabledForPLECanvas);
     d->ui->printPreviewAction->setEnabled(isEnabledForPLECanvas);
     d->ui->printAction->setEnabled(isEnabledForPLECanvas);
     d->ui->closeAction->setEnabled(isEnabledForPLECanvas);
@@ -269,7 +307,12 @@ void PLEWindow::refreshActions()
     d->ui->showGridToggleAction->setEnabled(isEnabledForPLECanvas);
     d->ui->gridConfigAction->setEnabled(isEnabledForPLECanvas);
     d->ui->changeCanvasSizeAction->setEnabled(isEnabledForPLECanvas);
+    d->ui->addPageAction->setEnabled(isEnabledForPLECanvas);
+    d->ui->removePageAction->setEnabled(pagesCount > 1);
+    d->ui->previousPageAction->setEnabled(currentPage > 0);
+    d->ui->nextPageAction->setEnabled(currentPage >= 0 && currentPage < pagesCount - 1);
     d->treeWidget->setEnabled(isEnabledForPLECanvas);
+    d->pagesWidget->setEnabled(isEnabledForPLECanvas);
     d->toolsWidget->setEnabled(isEnabledForPLECanvas);
 }
 
@@ -294,6 +337,15 @@ void PLEWindow::createWidgets()
     connect(d->toolsWidget, SIGNAL(requireMultiSelection()),d->tree, SLOT(setMultiSelection()));
     connect(d->toolsWidget, SIGNAL(requireSingleSelection()),d->tree, SLOT(setSingleSelection()));
 
+    // Pages dockwidget
+    d->pagesWidget = new QDockWidget(QObject::tr("Pages"), this);
+    d->pagesWidget->setFeatures(QDockWidget::DockWidgetMovable);
+    d->pagesWidget->setFloating(false);
+    d->pagesWidget->setAllowedAreas(Qt::RightDockWidgetArea | Qt::LeftDockWidgetArea);
+    d->pages = new PLEPagesList(d->pagesWidget);
+    d->pagesWidget->setWidget(d->pages);
+    this->addDockWidget(Qt::LeftDockWidgetArea, d->pagesWidget);
+
     // Central widget (widget with canvas)
     d->centralWidget = new QWidget(this);
     d->centralWidget->setLayout(new QHBoxLayout(d->centralWidget));
@@ -303,6 +355,11 @@ void PLEWindow::createWidgets()
 
     d->statusBar = new PLEStatusBar(this);
     setStatusBar(d->statusBar);
+
+    d->exportQueue = new PLEExportQueue(this);
+
+    connect(d->exportQueue, SIGNAL(jobFinished(PLEExportJob*)),
+            this, SLOT(exportFinished(PLEExportJob*)));
 }
 
 void PLEWindow::createPLECanvas(const PLECanvasSize& size)
@@ -352,9 +409,12 @@ void PLEWindow::createPLECanvas(const QUrl& fileUrl)
 void PLEWindow::prepareSignalsConnections()
 {
     d->centralWidget->layout()->addWidget(d->canvas);
-    d->tree->setModel(d->canvas->model());
-    d->tree->setSelectionModel(d->canvas->selectionModel());
-    d->toolsWidget->setScene(d->canvas->scene());
+    d->pages->setPhotobook(d->canvas->photobook());
+
+    // page signals
+    connect(d->canvas,                                 SIGNAL(pageChanged(int)),                   this,                   SLOT(pageChanged()));
+    connect(d->canvas->photobook(),                    SIGNAL(pageInserted(int)),                  this,                   SLOT(refreshActions()));
+    connect(d->canvas->photobook(),                    SIGNAL(pageRemoved(int)),                   this,                   SLOT(refreshActions()));
 
     // undo stack signals
     connect(d->canvas,                                 SIGNAL(savedStateChanged()),                this,                   SLOT(refreshActions()));
@@ -383,9 +443,21 @@ void PLEWindow::prepareSignalsConnections()
     connect(d->toolsWidget,                            SIGNAL(cropToolSelected()),                 d->canvas,              SLOT(enableCropEditingMode()));
     connect(d->toolsWidget,                            SIGNAL(borderToolSelected()),               d->canvas,              SLOT(enableBordersEditingMode()));
     connect(d->toolsWidget,                            SIGNAL(newItemCreated(AbstractPhoto*)),     d->canvas,              SLOT(addNewItem(AbstractPhoto*)));
-    connect(d->canvas->scene()->toGraphicsPLEScene(),  SIGNAL(mousePressedPoint(QPointF)),         d->toolsWidget,         SLOT(mousePositionChoosen(QPointF)));
+
+    this->pageChanged();
+}
+
+void PLEWindow::pageChanged()
+{
+    // Layers and tools follow the scene of the current page
+    d->tree->setModel(d->canvas->model());
+    d->tree->setSelectionModel(d->canvas->selectionModel());
+    d->toolsWidget->setScene(d->canvas->scene());
+
+    connect(d->canvas->scene()->toGraphicsPLEScene(),  SIGNAL(mousePressedPoint(QPointF)),         d->toolsWidget,         SLOT(mousePositionChoosen(QPointF)), Qt::UniqueConnection);
 
     d->toolsWidget->setDefaultTool();
+    refreshActions();
 }
 
 void PLEWindow::openFile()
@@ -557,6 +629,7 @@ void PLEWindow::exportFile()
 
     QString all;
     QStringList list                       = supportedImageMimeTypes(QIODevice::WriteOnly, all);
+    list << QObject::tr("PDF Document (*.pdf)");
     QFileDialog* const imageFileSaveDialog = new QFileDialog(this);
     imageFileSaveDialog->setWindowTitle(QObject::tr("New Image File Name"));
     imageFileSaveDialog->setAcceptMode(QFileDialog::AcceptSave);
@@ -584,32 +657,131 @@ void PLEWindow::exportFile()
 
     if ((result == QFileDialog::Accepted) && !urls.isEmpty() && !ext.isEmpty())
     {
-        QUrl url = urls.first();
+        QUrl url       = urls.first();
+        QFileInfo info(url.toLocalFile());
+        QString suffix = info.suffix().toLower();
+
+        if (!suffix.isEmpty())
+            ext = suffix;
+
+        // Scene is captured now and written in background, so it can be edited during the export
+        PLEExportJob* const job = new PLEExportJob(PLESceneSnapshot::capture(d->canvas->scene()));
+        job->setResolution(d->canvas->canvasSize().resolution(PLECanvasSize::PixelsPerInch));
+        job->addOutput(info.absoluteFilePath(), ext.toLatin1());
 
-        QPixmap image(d->canvas->sceneRect().size().toSize());
-        image.fill(Qt::transparent);
-        d->canvas->renderPLECanvas(&image);
-        QImageWriter writer(url.toLocalFile());
-        writer.setFormat(ext.toLatin1());
+        // Other formats written next to the selected file and the output color profile are set up in PLEConfigDialog
+        QSettings config(QLatin1String("PhotoLayoutEditor"));
+        config.beginGroup(QLatin1String("Export"));
+        const QStringList formats = config.value(QLatin1String("AdditionalFormats"), QStringList()).toStringList();
 
-        if (!writer.canWrite())
+        // Output ICC profile, images are written in sRGB without it
+        const QString profilePath = config.value(QLatin1String("ColorProfile"), QString()).toString();
+        const int intent          = config.value(QLatin1String("RenderingIntent"), int(PLEColorTransform::Perceptual)).toInt();
+        config.endGroup();
+
+        if (!profilePath.isEmpty())
         {
-            QMessageBox::critical(this, QObject::tr("Error"),
-                                  QObject::tr("Image can't be saved in selected file."));
+            const PLEIccProfile profile = PLEIccProfile::fromFile(profilePath);
+
+            if (profile.isNull())
+                qDebug() << "Can't use color profile" << profilePath << ":" << profile.errorString();
+            else
+                job->setColorProfile(profile, PLEColorTransform::RenderingIntent(qBound(0, intent, 3)));
         }
 
-        if (!writer.write(image.toImage()))
+        foreach (const QString& format, formats)
         {
-            DMessageBox::showInformationList(
-                QMessageBox::Critical,
-                qApp->activeWindow(),
-                qApp->applicationName(),
-                QObject::tr("Unexpected error while saving an image."),
-                QStringList() << writer.errorString());
+            const QString otherExt = format.trimmed().toLower();
+
+            if (!otherExt.isEmpty() && otherExt != ext)
+            {
+                job->addOutput(info.absolutePath() + QLatin1Char('/') + info.completeBaseName() + QLatin1Char('.') + otherExt,
+                               otherExt.toLatin1());
+            }
         }
+
+        // PDF is written directly from the items, photos are embedded without rasterizing the page
+        foreach (const QString& output, job->outputs())
+        {
+            if (QFileInfo(output).suffix().toLower() == QLatin1String("pdf"))
+            {
+                job->setPdfExporter(QSharedPointer<PLEPdfExporter>(new PLEPdfExporter(d->canvas->scene(),
+                                                                                      d->canvas->canvasSize().size(PLECanvasSize::Points))));
+                break;
+            }
+        }
+
+        d->exportQueue->enqueue(job, this);
+    }
+
+    delete imageFileSaveDialog;
+}
+
+void PLEWindow::exportPages()
+{
+    if (!d->canvas)
+    {
+        return;
     }
 
+    QString all;
+    QStringList list                       = supportedImageMimeTypes(QIODevice::WriteOnly, all);
+    list << QObject::tr("PDF Document (*.pdf)");
+    QFileDialog* const imageFileSaveDialog = new QFileDialog(this);
+    imageFileSaveDialog->setWindowTitle(QObject::tr("Pages File Name"));
+    imageFileSaveDialog->setAcceptMode(QFileDialog::AcceptSave);
+    imageFileSaveDialog->setFileMode(QFileDialog::AnyFile);
+    imageFileSaveDialog->setNameFilters(list);
+#ifndef Q_OS_MACOS
+    imageFileSaveDialog->setOptions(QFileDialog::DontUseNativeDialog);
+#endif
+
+    int result       = imageFileSaveDialog->exec();
+    QList<QUrl> urls = imageFileSaveDialog->selectedUrls();
     delete imageFileSaveDialog;
+
+    if ((result != QFileDialog::Accepted) || urls.isEmpty())
+    {
+        return;
+    }
+
+    // Each page is written to its own file, page number is appended to the selected name
+    QFileInfo info(urls.first().toLocalFile());
+    QString ext = info.suffix().toLower();
+
+    if (ext.isEmpty())
+    {
+        ext  = QLatin1String("png");
+        info = QFileInfo(info.absoluteFilePath() + QLatin1Char('.') + ext);
+    }
+
+    // Pages are loaded one by one during the export, so the document can't be changed meanwhile
+    this->setEnabled(false);
+    bool exported = d->canvas->photobook()->exportPages(info.absoluteFilePath(), ext.toLatin1());
+    this->setEnabled(true);
+
+    if (!exported)
+    {
+        DMessageBox::showInformationList(
+            QMessageBox::Critical,
+            qApp->activeWindow(),
+            qApp->applicationName(),
+            QObject::tr("Unexpected error while saving an image."),
+            d->canvas->photobook()->errors());
+    }
+}
+
+void PLEWindow::exportFinished(PLEExportJob* job)
+{
+    if (job->errors().isEmpty())
+        return;
+
+    DMessageBox::showInformationList(
+        QMessageBox::Critical,
+        qApp->activeWindow(),
+        qApp->applicationName(),
+        QObject::tr("Unexpected error while saving an image."),
+        job->errors());
 }
 
 void PLEWindow::printPreview()
@@ -669,6 +841,7 @@ bool PLEWindow::closeDocument()
             case QMessageBox::No:
             {
                 d->tree->setModel(nullptr);
+                d->pages->setPhotobook(nullptr);
                 d->canvas->deleteLater();
                 d->canvas = nullptr;
                 refreshActions();
@@ -690,6 +863,18 @@ bool PLEWindow::closeDocument()
 
 void PLEWindow::progressEvent(ProgressEvent* event)
 {
+    // Pages loaded in advance are shown as background jobs since their start
+    const bool otherPage = (qobject_cast<PLECanvasLoadingThread*>(event->sender()) && d->canvas &&
+                            (d->statusBar->hasJob(event->sender()) ||
+                             (event->type() == ProgressEvent::Init && event->sender()->parent() != d->canvas->scene())));
+
+    // Background jobs don't block the canvas
+    if (qobject_cast<PLEExportJob*>(event->sender()) || qobject_cast<PLECanvasSavingThread*>(event->sender()) || otherPage)
+    {
+        d->statusBar->progressEvent(event);
+        return;
+    }
+
     if (d->canvas)
     {
         d->canvas->progressEvent(event);
@@ -716,6 +901,7 @@ void PLEWindow::settings()
     QSettings config(QLatin1String("PhotoLayoutEditor"));
     config.beginGroup(QLatin1String("View"));
     d->canvas->setAntialiasing(config.value(QLatin1String("Antialiasing"), false).toBool());
+    d->canvas->setStaticLayerCaching(config.value(QLatin1String("StaticLayerCache"), true).toBool());
     d->canvas->scene()->setGridVisible(config.value(QLatin1String("ShowGrid"), false).toBool());
     d->canvas->scene()->setHorizontalGrid(config.value(QLatin1String("XGrid"), 25.0).toDouble());
     d->canvas->scene()->setVerticalGrid(config.value(QLatin1String("YGrid"), 25.0).toDouble());
@@ -802,6 +988,38 @@ void PLEWindow::changePLECanvasSize()
     delete ccd;
 }
 
+void PLEWindow::addPage()
+{
+    if (d->canvas)
+    {
+        d->canvas->photobook()->insertPage(d->canvas->photobook()->currentPage() + 1);
+    }
+}
+
+void PLEWindow::removePage()
+{
+    if (d->canvas)
+    {
+        d->canvas->photobook()->removePage(d->canvas->photobook()->currentPage());
+    }
+}
+
+void PLEWindow::previousPage()
+{
+    if (d->canvas)
+    {
+        d->canvas->photobook()->setCurrentPage(d->canvas->photobook()->currentPage() - 1);
+    }
+}
+
+void PLEWindow::nextPage()
+{
+    if (d->canvas)
+    {
+        d->canvas->photobook()->setCurrentPage(d->canvas->photobook()->currentPage() + 1);
+    }
+}
+
 void PLEWindow::setTemplateEditMode(bool isEnabled)
 {
     Q_UNUSED(isEnabled);
@@ -815,6 +1033,7 @@ void PLEWindow::loadEffects()
 {
     StandardEffectsFactory* const stdEffects = new StandardEffectsFactory(PhotoEffectsLoader::instance());
     PhotoEffectsLoader::registerEffect(stdEffects);
+    PhotoEffectsLoader::loadPlugins();
 }
 
 void PLEWindow::loadBorders()
@@ -45,6 +45,7 @@ namespace PhotoLayoutsEditor
 class PLECanvas;
 class PLECanvasSize;
 class PLECanvasSizeChangeCommand;
+class PLEExportJob;
 class ProgressEvent;
 class UndoCommandEventFilter;
 
@@ -57,6 +58,9 @@ public:
     ~PLEWindow() override;
     static PLEWindow* instance(DPluginGeneric* const plugin = nullptr);
 
+    /// Returns true if the window was created, instance() would create it otherwise
+    static bool hasInstance();
+
     void addUndoCommand(QUndoCommand* const command);
     void beginUndoCommandGroup(const QString& name);
     void endUndoCommandGroup();
@@ -77,6 +81,7 @@ public Q_SLOTS:
     void saveAsFile();
     void saveAsTemplate();
     void exportFile();
+    void exportPages();
     void printPreview();
     void print();
     bool closeDocument();
@@ -87,6 +92,10 @@ public Q_SLOTS:
     void settings();
     void setupGrid();
     void changePLECanvasSize();
+    void addPage();
+    void removePage();
+    void previousPage();
+    void nextPage();
     void setTemplateEditMode(bool isEnabled);
 
 protected:
@@ -97,7 +106,9 @@ protected:
 private Q_SLOTS:
 
     void refreshActions();
+    void pageChanged();
     void slotAbout();
+    void exportFinished(PLEExportJob* job);
 
 private:
 
@@ -44,6 +44,7 @@
 #include <QPushButton>
 #include <QPluginLoader>
 #include <QFile>
+#include <QFileInfo>
 #include <QPrintPreviewDialog>
 #include <QImageWriter>
 #include <QPrintDialog>
@@ -54,6 +55,7 @@
 #include <QPrinter>
 #include <QDebug>
 #include <QPointer>
+#include <QSharedPointer>
 #include <QSettings>
 #include <QTranslator>
 #include <QLocale>
@@ -75,9 +77,17 @@
 #include "borderedittool.h"
 #include "abstractphotoeffectfactory.h"
 #include "plestatusbar.h"
+#include "plepageslist.h"
 #include "plecanvassizedialog.h"
 #include "plecanvas.h"
 #include "plescene.h"
+#include "plephotobook.h"
+#include "plescenesnapshot.h"
+#include "pleexportjob.h"
+#include "pleexportqueue.h"
+#include "plepdfexporter.h"
+#include "plecanvassavingthread.h"
+#include "plecanvasloadingthread.h"
 #include "layersselectionmodel.h"
 #include "undocommandeventfilter.h"
 #include "photoeffectsloader.h"
@@ -107,12 +117,15 @@ class PLEWindow::Private
             tree(nullptr),
             treeWidget(nullptr),
             treeTitle(nullptr),
+            pagesWidget(nullptr),
+            pages(nullptr),
             toolsWidget(nullptr),
             toolEffects(nullptr),
             toolBorders(nullptr),
             statusBar(nullptr),
             fileDialog(nullptr),
             canvas(nullptr),
+            exportQueue(nullptr),
             interface(nullptr),
             ui(nullptr),
             plugin(nullptr)
@@ -133,6 +146,10 @@ class PLEWindow::Private
         QDockWidget*                                    treeWidget;
         LayersTreeTitleWidget*                          treeTitle;
 
+        // Pages of the photobook
+        QDockWidget*                                    pagesWidget;
+        PLEPagesList*                                   pages;
+
         // Tools
         ToolsDockWidget*                                toolsWidget;
         EffectsEditorTool*                              toolEffects;
@@ -147,6 +164,7 @@ class PLEWindow::Private
         QFileDialog*                                    fileDialog;
 
         PLECanvas*                                         canvas;
+        PLEExportQueue*                                 exportQueue;
         DInfoInterface*                                 interface;
         Ui::PLEWindow*                                  ui;
         DPluginGeneric*                                 plugin;